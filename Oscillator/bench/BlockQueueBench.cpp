@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BlockQueue.h"
+
+namespace
+{
+
+/**
+ * @brief BM_BlockQueue_transfer
+ * @note intervals handed from producer thread to consumer draining whole queue, range(0) = capacity
+ */
+void BM_BlockQueue_transfer(benchmark::State & state)
+{
+    constexpr int blocks_per_iteration = 10000;
+    RecordingVector interval;
+    interval.Get_container().emplace_back(0.0, 1.0);
+    //queue shares block, like reader does
+    const BlockHandle block = std::make_shared<const RecordingVector>(std::move(interval));
+    for (auto _ : state)
+    {
+        BlockQueue queue(state.range(0));
+        std::thread producer([&] {
+            for (int i = 0; i < blocks_per_iteration; i++)
+            {
+                while (queue.Get_size() == queue.Get_capacity())
+                {
+                    std::this_thread::yield();
+                }
+                queue.Push(block);
+            }
+        });
+        std::vector<BlockHandle> drained;
+        std::size_t received = 0;
+        while (received < blocks_per_iteration)
+        {
+            drained.clear();
+            const std::size_t count = queue.Drain(drained);
+            if (count == 0)
+            {
+                std::this_thread::yield();
+            }
+            received += count;
+        }
+        producer.join();
+        benchmark::DoNotOptimize(received);
+    }
+    state.SetItemsProcessed(state.iterations() * blocks_per_iteration);
+}
+BENCHMARK(BM_BlockQueue_transfer)->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "CaptureIndex.h"
+#include "TextCodec.h"
+
+namespace
+{
+
+constexpr int capture_seconds = 100;
+constexpr int capture_rate = 10000;
+
+/**
+ * @brief capture_file
+ * @param with_footer if true, index is appended to capture
+ * @return path of capture of capture_seconds, written on first call
+ */
+std::filesystem::path capture_file(bool with_footer)
+{
+    const std::filesystem::path fname = std::filesystem::temp_directory_path()
+        / (with_footer ? "oscillator_bench_indexed.txt" : "oscillator_bench_capture.txt");
+    if (std::filesystem::exists(fname))
+    {
+        return fname;
+    }
+    std::vector<double> values(capture_rate);
+    std::string text;
+    for (int s = 0; s < capture_seconds; s++)
+    {
+        for (int i = 0; i < capture_rate; i++)
+        {
+            values[i] = std::sin(2.0 * 3.14159265358979 * 5.0 * i / capture_rate);
+        }
+        TextCodec::Encode_interval(values, 1.0 / capture_rate, (capture_rate - 1.0) / capture_rate, text);
+        text += '\n';
+    }
+    std::ofstream(fname, std::ios::binary) << text;
+    if (with_footer)
+    {
+        CaptureIndex index(fname);
+        index.Index_more(capture_seconds);
+        index.Write_footer();
+    }
+    return fname;
+}
+
+/**
+ * @brief BM_CaptureIndex_first_interval
+ * @note time until first interval of capture is found, range(0) = 1 if capture has footer
+ */
+void BM_CaptureIndex_first_interval(benchmark::State & state)
+{
+    const std::filesystem::path fname = capture_file(state.range(0) == 1);
+    for (auto _ : state)
+    {
+        CaptureIndex index(fname);
+        CaptureEntry entry {};
+        index.Get_entry(0, entry);
+        benchmark::DoNotOptimize(entry);
+    }
+}
+BENCHMARK(BM_CaptureIndex_first_interval)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief BM_CaptureIndex_full_scan
+ * @note whole capture without footer indexed
+ */
+void BM_CaptureIndex_full_scan(benchmark::State & state)
+{
+    const std::filesystem::path fname = capture_file(false);
+    for (auto _ : state)
+    {
+        CaptureIndex index(fname);
+        index.Index_more(capture_seconds);
+        benchmark::DoNotOptimize(index.Get_entry_count());
+    }
+    state.SetItemsProcessed(state.iterations() * capture_seconds * capture_rate);
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(fname));
+}
+BENCHMARK(BM_CaptureIndex_full_scan)->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,30 @@
+#include <benchmark/benchmark.h>
+#include <sstream>
+
+#include "BlockPool.h"
+#include "DummyGenerator.h"
+#include "FileReader.h"
+
+/**
+ * One interval in Generator format parsed by FileReader, argument is sample rate.
+ */
+static void BM_FileReader_parse_interval(benchmark::State & state)
+{
+    const int sample_rate = state.range(0);
+    Dummy::FuncIterator func = Dummy::Create_Func(Dummy::FuncType::SIN, sample_rate, 5, 2);
+    Dummy::Generator gen(func, sample_rate);
+    std::ostringstream out;
+    gen.Write_interval(out);
+    const std::string text = out.str();
+
+    BlockPool pool;
+    for (auto _ : state)
+    {
+        std::istringstream in(text);
+        RecordingVector vec = FileReader::Parse_interval(in, 0.0, &pool, sample_rate);
+        benchmark::DoNotOptimize(vec.Get_container().data());
+    }
+    state.SetItemsProcessed(state.iterations() * sample_rate);
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_FileReader_parse_interval)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <string>
+
+#include "FilterChain.h"
+
+namespace
+{
+
+constexpr double sample_rate = 1e6;
+
+const char * const specs[] = {"lowpass:1000", "average:64", "fir:1000:63", "decimate:8", "cic:8"};
+
+/**
+ * @brief BM_FilterChain
+ * @note measures filtered points per second of single stage chains,
+ * range(0) = index of spec, range(1) = points of one interval
+ */
+void BM_FilterChain(benchmark::State & state)
+{
+    const char * spec = specs[state.range(0)];
+    const int points = static_cast<int>(state.range(1));
+    std::unique_ptr<FilterChain> chain = FilterChain::Parse(spec, sample_rate);
+    RecordingVector vec;
+    RecordingVector::type & data = vec.Get_container();
+    for (int i = 0; i < points; i++)
+    {
+        const double time = i / sample_rate;
+        data.emplace_back(time, std::sin(2.0 * 3.14159265358979 * 5000.0 * time));
+    }
+    for (auto _ : state)
+    {
+        RecordingVector filtered = chain->Process(vec);
+        benchmark::DoNotOptimize(filtered.Get_container().data());
+    }
+    state.SetLabel(spec);
+    state.SetItemsProcessed(state.iterations() * points);
+}
+BENCHMARK(BM_FilterChain)->ArgsProduct({{0, 1, 2, 3, 4}, {10000, 1000000}})->Unit(benchmark::kMicrosecond);
+
+}
@@ -0,0 +1,22 @@
+#include <benchmark/benchmark.h>
+
+#include "FuncIterator.h"
+
+/**
+ * Values generated by FuncIterator, argument is function type.
+ */
+static void BM_FuncIterator_next(benchmark::State & state)
+{
+    const auto type = static_cast<Dummy::FuncType>(state.range(0));
+    constexpr int points_per_sec = 100000;
+    Dummy::FuncIterator func = Dummy::Create_Func(type, points_per_sec, 5, 2);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(++func);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FuncIterator_next)
+    ->Arg(static_cast<int>(Dummy::FuncType::SIN))
+    ->Arg(static_cast<int>(Dummy::FuncType::SQUARE))
+    ->Arg(static_cast<int>(Dummy::FuncType::RANDOM));
@@ -0,0 +1,27 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+
+#include "DummyGenerator.h"
+
+/**
+ * One interval written by Generator to file, argument is sample rate.
+ */
+static void BM_Generator_write_interval(benchmark::State & state)
+{
+    const int sample_rate = state.range(0);
+    Dummy::FuncIterator func = Dummy::Create_Func(Dummy::FuncType::SIN, sample_rate, 5, 2);
+    const std::string fname = (std::filesystem::temp_directory_path() / "oscillator_bench_gen").string();
+    Dummy::Generator gen(func, sample_rate, fname);
+    std::size_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::ofstream file(fname, std::ios::trunc);
+        gen.Write_interval(file);
+        bytes += file.tellp();
+    }
+    std::filesystem::remove(fname);
+    state.SetItemsProcessed(state.iterations() * sample_rate);
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_Generator_write_interval)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+
+#include "ImPlotChart.h"
+#include "imgui.h"
+#include "implot.h"
+
+namespace
+{
+
+constexpr float chart_width = 600.f;
+constexpr float chart_height = 400.f;
+
+/**
+ * @brief make_interval
+ * @param points number of timestamps
+ * @param start_time time of first timestamp
+ * @return one interval (1 second) of sine
+ */
+std::vector<Timestamp> make_interval(int points, double start_time)
+{
+    std::vector<Timestamp> data;
+    data.reserve(points);
+    const double step = 1.0 / points;
+    for (int i = 0; i < points; i++)
+    {
+        const double time = start_time + i * step;
+        data.emplace_back(time, 2.0 * std::sin(10.0 * time));
+    }
+    return data;
+}
+
+/**
+ * @class ImGuiContextGuard
+ * Headless ImGui & ImPlot context, frames are built but never rasterized.
+ */
+class ImGuiContextGuard
+{
+public:
+    ImGuiContextGuard()
+    {
+        ImGui::CreateContext();
+        ImPlot::CreateContext();
+        ImGuiIO & io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(800.f, 600.f);
+        io.DeltaTime = 1.f / 60.f;
+        unsigned char * pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+
+    ~ImGuiContextGuard()
+    {
+        ImPlot::DestroyContext();
+        ImGui::DestroyContext();
+    }
+};
+
+/**
+ * @brief visible_rate_and_history
+ * @note one interval is visible, so rate is number of visible points
+ */
+void visible_rate_and_history(benchmark::internal::Benchmark * bench)
+{
+    bench->ArgNames({"rate", "history"});
+    bench->ArgsProduct({{10000, 100000, 1000000}, {1, 10}});
+}
+
+} //namespace
+
+/**
+ * Whole frame of ImPlot chart: visible range lookup, decimation and ImGui draw lists.
+ * Compare with BM_LineChart_Draw.
+ */
+static void BM_ImPlotChart_Draw(benchmark::State & state)
+{
+    sf::RenderTexture texture;
+    if (!texture.resize({800u, 600u}))
+    {
+        state.SkipWithError("Can't create render texture");
+        return;
+    }
+    ImGuiContextGuard context;
+    const int points = state.range(0);
+    const int intervals = state.range(1);
+    ImPlotChart chart(make_interval(points, 0), chart_width, chart_height, sf::Vector2f(100.f, 100.f));
+    for (int i = 1; i < intervals; i++)
+    {
+        chart.Add_data(make_interval(points, i));
+    }
+    for (auto _ : state)
+    {
+        ImGui::NewFrame();
+        chart.Draw(texture);
+        ImGui::Render();
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+}
+BENCHMARK(BM_ImPlotChart_Draw)->Apply(visible_rate_and_history)->Unit(benchmark::kMicrosecond);
+
+/**
+ * New interval added to chart, like main loop does when reader loads data.
+ */
+static void BM_ImPlotChart_Add_data(benchmark::State & state)
+{
+    const int points = state.range(0);
+    const int intervals = state.range(1);
+    ImPlotChart chart(make_interval(points, 0), chart_width, chart_height, sf::Vector2f(100.f, 100.f), -2.5f, 2.5f, intervals);
+    std::vector<Timestamp> interval = make_interval(points, 1);
+    for (auto _ : state)
+    {
+        chart.Add_data(interval);
+        state.PauseTiming();
+        for (Timestamp & point : interval)
+        {
+            point._data.first += 1.0;
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+}
+BENCHMARK(BM_ImPlotChart_Add_data)->Apply(visible_rate_and_history)->Unit(benchmark::kMicrosecond);
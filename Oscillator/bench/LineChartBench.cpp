@@ -0,0 +1,117 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+
+#include "LineChart.h"
+
+namespace
+{
+
+constexpr float chart_width = 600.f;
+constexpr float chart_height = 400.f;
+
+/**
+ * @brief make_interval
+ * @param points number of timestamps
+ * @param start_time time of first timestamp
+ * @return one interval (1 second) of sine
+ */
+std::vector<Timestamp> make_interval(int points, double start_time)
+{
+    std::vector<Timestamp> data;
+    data.reserve(points);
+    const double step = 1.0 / points;
+    for (int i = 0; i < points; i++)
+    {
+        const double time = start_time + i * step;
+        data.emplace_back(time, 2.0 * std::sin(10.0 * time));
+    }
+    return data;
+}
+
+/**
+ * @brief make_chart
+ * @param points number of timestamps per interval
+ * @param intervals number of intervals loaded to chart
+ * @return chart with data loaded
+ */
+LineChart make_chart(int points, int intervals)
+{
+    std::vector<Timestamp> data;
+    for (int i = 0; i < intervals; i++)
+    {
+        std::vector<Timestamp> interval = make_interval(points, i);
+        data.insert(data.end(), interval.begin(), interval.end());
+    }
+    return LineChart(data, chart_width, chart_height, sf::Vector2f(100.f, 100.f));
+}
+
+/**
+ * @brief sample_rate_and_history
+ * @note sweeps sample rate (points per interval) and history length (intervals)
+ */
+void sample_rate_and_history(benchmark::internal::Benchmark * bench)
+{
+    bench->ArgNames({"rate", "history"});
+    bench->ArgsProduct({{1000, 10000, 100000}, {1, 10, 30}});
+}
+
+} //namespace
+
+/**
+ * New interval added to chart, like main loop does when reader loads data.
+ */
+static void BM_LineChart_Add_data(benchmark::State & state)
+{
+    const int points = state.range(0);
+    const int intervals = state.range(1);
+    LineChart chart = make_chart(points, intervals);
+    std::vector<Timestamp> interval = make_interval(points, intervals);
+    for (auto _ : state)
+    {
+        chart.Add_data(interval);
+        state.PauseTiming();
+        for (Timestamp & point : interval)
+        {
+            point._data.first += 1.0;
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+}
+BENCHMARK(BM_LineChart_Add_data)->Apply(sample_rate_and_history)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Visible range lookup and scaling done before each frame.
+ */
+static void BM_LineChart_Update_geometry(benchmark::State & state)
+{
+    LineChart chart = make_chart(state.range(0), state.range(1));
+    for (auto _ : state)
+    {
+        chart.Update_geometry();
+    }
+}
+BENCHMARK(BM_LineChart_Update_geometry)->Apply(sample_rate_and_history);
+
+/**
+ * Whole frame of chart drawn to offscreen texture.
+ */
+static void BM_LineChart_Draw(benchmark::State & state)
+{
+    sf::RenderTexture texture;
+    if (!texture.resize({800u, 600u}))
+    {
+        state.SkipWithError("Can't create render texture");
+        return;
+    }
+    LineChart chart = make_chart(state.range(0), state.range(1));
+    chart.Set_scrolling(false);
+    for (auto _ : state)
+    {
+        texture.clear();
+        chart.Draw(texture);
+        texture.display();
+    }
+}
+BENCHMARK(BM_LineChart_Draw)->Apply(sample_rate_and_history)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+#include "MathChannel.h"
+
+namespace
+{
+
+constexpr int intervals = 60;
+constexpr int points_per_interval = 10000;
+
+/**
+ * @brief fill
+ * @param history history filled with one minute of sine with given frequency
+ */
+void fill(RecordingHistory & history, double frequency)
+{
+    history.Set_history_time_limit(intervals);
+    for (int k = 0; k < intervals; k++)
+    {
+        RecordingVector vec;
+        RecordingVector::type & data = vec.Get_container();
+        for (int i = 0; i < points_per_interval; i++)
+        {
+            const double time = k + static_cast<double>(i) / points_per_interval;
+            data.emplace_back(time, std::sin(2.0 * 3.14159265358979 * frequency * time));
+        }
+        vec.Set_recording_params(RangeParams({-1.0, 1.0}, {data.front().Get_time(), data.back().Get_time()}, points_per_interval));
+        history.Push_recordingVector(std::move(vec));
+    }
+}
+
+/**
+ * @brief BM_MathChannel
+ * @note measures evaluation of one second visible at end of history,
+ * range(0) = operation, range(1) = 1 if cache is kept between frames
+ */
+void BM_MathChannel(benchmark::State & state)
+{
+    const MathOperation operation = static_cast<MathOperation>(state.range(0));
+    const bool is_cached = state.range(1) != 0;
+    RecordingHistory a;
+    RecordingHistory b;
+    fill(a, 50.0);
+    fill(b, 7.0);
+    MathChannel channel(operation, a, &b);
+    std::vector<Timestamp> out;
+    for (auto _ : state)
+    {
+        if (!is_cached)
+        {
+            channel.Invalidate();
+        }
+        channel.Evaluate(intervals - 1.0, intervals, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetLabel(MathChannel::Get_name(operation));
+    state.SetItemsProcessed(state.iterations() * out.size());
+}
+BENCHMARK(BM_MathChannel)->ArgsProduct({{0, 1, 2, 3, 4}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+}
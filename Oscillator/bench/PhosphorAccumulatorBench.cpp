@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <numbers>
+#include <thread>
+#include <vector>
+
+#include "PhosphorAccumulator.h"
+
+namespace
+{
+
+/**
+ * @brief fill_periods
+ * @param data buffer to fill
+ * @param periods number of sine periods, every period is one sweep
+ * @param points_per_period number of timestamps of each period
+ * @param time time of first timestamp, moved after last timestamp
+ */
+void fill_periods(std::vector<Timestamp> & data, int periods, int points_per_period, double & time)
+{
+    constexpr double period = 1e-3;
+    const double step = period / points_per_period;
+    data.clear();
+    for (int i = 0; i < periods * points_per_period; i++)
+    {
+        data.emplace_back(time, 2.0 * std::sin(2.0 * std::numbers::pi * time / period));
+        time += step;
+    }
+}
+
+/**
+ * @brief BM_PhosphorSweeps
+ * @note measures how many sweeps per second accumulator thread bins,
+ * range(0) = points of one sweep
+ */
+void BM_PhosphorSweeps(benchmark::State & state)
+{
+    constexpr int sweeps_per_block = 100;
+    const int points = static_cast<int>(state.range(0));
+    PhosphorSettings settings;
+    settings._sweep_time = 1e-3;
+    PhosphorAccumulator accumulator(settings);
+    accumulator.Start();
+    std::vector<Timestamp> block;
+    double time = 0.0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        fill_periods(block, sweeps_per_block, points, time);
+        const std::uint64_t expected = accumulator.Get_sweep_count() + sweeps_per_block - 1;
+        state.ResumeTiming();
+        accumulator.Push(block);
+        while (accumulator.Get_sweep_count() < expected)
+        {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sweeps_per_block);
+    state.counters["points/s"] = benchmark::Counter(static_cast<double>(state.iterations()) * sweeps_per_block * points, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_PhosphorSweeps)->RangeMultiplier(10)->Range(100, 100000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief BM_PhosphorCopyIntensity
+ * @note cost of reading histogram each frame, independent of accumulated sweeps
+ */
+void BM_PhosphorCopyIntensity(benchmark::State & state)
+{
+    PhosphorSettings settings;
+    settings._columns = static_cast<int>(state.range(0));
+    settings._rows = static_cast<int>(state.range(0)) / 2;
+    PhosphorAccumulator accumulator(settings);
+    std::vector<float> intensity;
+    for (auto _ : state)
+    {
+        accumulator.Copy_intensity(intensity);
+        benchmark::DoNotOptimize(intensity.data());
+    }
+}
+BENCHMARK(BM_PhosphorCopyIntensity)->Arg(256)->Arg(512)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+}
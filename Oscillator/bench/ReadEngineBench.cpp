@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <string>
+
+#include "ReadEngine.h"
+
+namespace
+{
+constexpr std::size_t file_bytes = 64 << 20;
+constexpr const char * file_name = "read_engine_bench.txt";
+
+/**
+ * @brief prepare_file
+ * @note writes file read by benchmarks, it stays in page cache, so engine overhead is measured
+ */
+void prepare_file()
+{
+    static const bool prepared = [] {
+        std::ofstream file(file_name, std::ios::binary);
+        const std::string line = "0.000123,1.2345678\n";
+        for (std::size_t written = 0; written < file_bytes; written += line.size())
+        {
+            file << line;
+        }
+        return true;
+    }();
+    benchmark::DoNotOptimize(prepared);
+}
+
+/**
+ * @brief BM_ReadEngine_read_file
+ * @note whole file read, range(0) = 1 for io_uring, range(1) = reads in flight
+ */
+void BM_ReadEngine_read_file(benchmark::State & state)
+{
+    prepare_file();
+    std::unique_ptr<ReadEngine> engine = Create_read_engine(state.range(1), 1 << 18, state.range(0) == 1);
+    state.SetLabel(engine->Get_name());
+    std::string text;
+    for (auto _ : state)
+    {
+        if (!engine->Read_file(file_name, text))
+        {
+            state.SkipWithError("File can't be read");
+            break;
+        }
+        benchmark::DoNotOptimize(text.data());
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ReadEngine_read_file)->ArgsProduct({{0, 1}, {1, 8}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
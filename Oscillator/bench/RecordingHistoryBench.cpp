@@ -0,0 +1,212 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+
+#include "BlockPool.h"
+#include "RecordingContainers.h"
+
+namespace
+{
+
+constexpr int history_limit = 30;
+
+/**
+ * @brief fill_interval
+ * @param vec interval to fill
+ * @param points number of timestamps
+ * @param start_time time of first timestamp
+ */
+void fill_interval(RecordingVector & vec, int points, double start_time)
+{
+    RecordingVector::type & data = vec.Get_container();
+    data.reserve(points);
+    const double step = 1.0 / points;
+    for (int i = 0; i < points; i++)
+    {
+        const double time = start_time + i * step;
+        data.emplace_back(time, std::sin(time));
+    }
+    vec.Set_recording_params(RangeParams({-1.0, 1.0}, {start_time, start_time + 1.0 - step}, points));
+}
+
+/**
+ * @brief full_history
+ * @param history history to fill up to its limit
+ * @param points number of timestamps of each interval
+ * @param intervals history limit
+ */
+void full_history(RecordingHistory & history, int points, int intervals = history_limit)
+{
+    history.Set_history_time_limit(intervals);
+    for (int i = 0; i < intervals; i++)
+    {
+        RecordingVector vec;
+        fill_interval(vec, points, i);
+        history.Push_recordingVector(std::move(vec));
+    }
+}
+
+/**
+ * @brief sample_rate_and_history
+ * @note sweeps sample rate (points per interval) and history length (intervals)
+ */
+void sample_rate_and_history(benchmark::internal::Benchmark * bench)
+{
+    bench->ArgNames({"rate", "history"});
+    bench->ArgsProduct({{1000, 10000, 100000}, {1, 10, 30}});
+}
+
+} //namespace
+
+/**
+ * Interval travels from reader to history by move, buffers come back through pool.
+ */
+static void BM_Push_recordingVector_move(benchmark::State & state)
+{
+    const int points = state.range(0);
+    BlockPool pool;
+    RecordingHistory history;
+    history.Set_history_time_limit(history_limit);
+    double start_time = 0.0;
+    for (auto _ : state)
+    {
+        RecordingVector vec(&pool);
+        fill_interval(vec, points, start_time);
+        history.Push_recordingVector(std::move(vec));
+        start_time += 1.0;
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+    state.counters["upstream_allocs"] = pool.Get_upstream_allocations();
+}
+BENCHMARK(BM_Push_recordingVector_move)->RangeMultiplier(10)->Range(1000, 100000);
+
+/**
+ * Previous behaviour: history stored a copy of pushed interval.
+ */
+static void BM_Push_recordingVector_copy(benchmark::State & state)
+{
+    const int points = state.range(0);
+    BlockPool pool;
+    RecordingHistory history;
+    history.Set_history_time_limit(history_limit);
+    double start_time = 0.0;
+    for (auto _ : state)
+    {
+        RecordingVector vec(&pool);
+        fill_interval(vec, points, start_time);
+        RecordingVector copy(vec);
+        history.Push_recordingVector(std::move(copy));
+        start_time += 1.0;
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+}
+BENCHMARK(BM_Push_recordingVector_copy)->RangeMultiplier(10)->Range(1000, 100000);
+
+/**
+ * Newest interval handed to chart as a view.
+ */
+static void BM_Get_newest_view(benchmark::State & state)
+{
+    RecordingHistory history;
+    full_history(history, state.range(0));
+    for (auto _ : state)
+    {
+        std::span<const Timestamp> view = history.Get_newest_view();
+        benchmark::DoNotOptimize(view.data());
+        benchmark::DoNotOptimize(view.back());
+    }
+}
+BENCHMARK(BM_Get_newest_view)->RangeMultiplier(10)->Range(1000, 100000);
+
+/**
+ * Previous behaviour: newest interval was returned by value.
+ */
+static void BM_Get_newest_copy(benchmark::State & state)
+{
+    RecordingHistory history;
+    full_history(history, state.range(0));
+    for (auto _ : state)
+    {
+        RecordingVector copy = history.Get_newest_recordingVector();
+        benchmark::DoNotOptimize(copy.Get_container().data());
+        benchmark::DoNotOptimize(copy.Get_container().back());
+    }
+}
+BENCHMARK(BM_Get_newest_copy)->RangeMultiplier(10)->Range(1000, 100000);
+
+/**
+ * Previous main.cpp: whole history was copied to iterate it.
+ */
+static void BM_Get_data_copy(benchmark::State & state)
+{
+    RecordingHistory history;
+    full_history(history, state.range(0));
+    for (auto _ : state)
+    {
+        RecordingHistory copy = history;
+        benchmark::DoNotOptimize(copy.Get_newest_view().data());
+    }
+}
+BENCHMARK(BM_Get_data_copy)->RangeMultiplier(10)->Range(1000, 100000);
+
+/**
+ * Oldest interval removed from history, history is refilled outside of timing.
+ */
+static void BM_Pop_recordingVector(benchmark::State & state)
+{
+    const int points = state.range(0);
+    const int intervals = state.range(1);
+    RecordingHistory history;
+    for (auto _ : state)
+    {
+        if (history.Empty())
+        {
+            state.PauseTiming();
+            full_history(history, points, intervals);
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(history.Pop_recordingVector());
+    }
+}
+BENCHMARK(BM_Pop_recordingVector)->Apply(sample_rate_and_history);
+
+/**
+ * Flat random access through RecordingHistory::operator[].
+ */
+static void BM_History_operator_index(benchmark::State & state)
+{
+    const int points = state.range(0);
+    const int intervals = state.range(1);
+    RecordingHistory history;
+    full_history(history, points, intervals);
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<unsigned> dist(0, points * intervals - 1);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(history[dist(gen)]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_History_operator_index)->Apply(sample_rate_and_history);
+
+/**
+ * Whole history traversed with RecordingHistory::iterator.
+ */
+static void BM_History_iterate(benchmark::State & state)
+{
+    const int points = state.range(0);
+    const int intervals = state.range(1);
+    RecordingHistory history;
+    full_history(history, points, intervals);
+    for (auto _ : state)
+    {
+        double sum = 0.0;
+        for (RecordingHistory::iterator iter = history.Begin(); iter != history.End(); ++iter)
+        {
+            sum += (*iter).Get_voltage();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * points * intervals);
+}
+BENCHMARK(BM_History_iterate)->Apply(sample_rate_and_history)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "SocketReader.h"
+
+/**
+ * Intervals streamed by SocketSink to SocketReader in the same process, argument is points of interval.
+ */
+static void BM_SocketReader_stream(benchmark::State & state)
+{
+    const int points = static_cast<int>(state.range(0));
+    std::vector<double> values(points);
+    for (int i = 0; i < points; i++)
+    {
+        values[i] = std::sin(i * 0.001);
+    }
+    const std::string path = (std::filesystem::temp_directory_path() / "oscillator_bench.sock").string();
+    SocketReader reader(path);
+    reader.Set_history_time_limit(4);
+    reader.Start();
+    SocketSink sink(path);
+    while (!sink.Is_ready())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (auto _ : state)
+    {
+        sink.Write_block(values, 1.0 / points, (points - 1.0) / points);
+        while (!reader.Check_if_new_data_loaded())
+        {
+            std::this_thread::yield();
+        }
+    }
+    reader.Destroy();
+    state.SetItemsProcessed(state.iterations() * points);
+    state.SetBytesProcessed(state.iterations() * (sizeof(SampleFrameHeader) + points * sample_frame_point_size));
+}
+BENCHMARK(BM_SocketReader_stream)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMicrosecond)->UseRealTime();
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "SummaryPyramid.h"
+
+namespace
+{
+
+constexpr int capture_blocks = 256;
+
+/**
+ * @brief capture
+ * @param points number of timestamps of each block
+ * @return blocks of long capture, one second each
+ */
+std::vector<BlockHandle> capture(int points)
+{
+    std::vector<BlockHandle> blocks;
+    blocks.reserve(capture_blocks);
+    const double step = 1.0 / points;
+    for (int b = 0; b < capture_blocks; b++)
+    {
+        RecordingVector vec;
+        RecordingVector::type & data = vec.Get_container();
+        data.reserve(points);
+        for (int i = 0; i < points; i++)
+        {
+            const double time = b + i * step;
+            data.emplace_back(time, std::sin(2.0 * 3.14159265358979 * 5.0 * time));
+        }
+        vec.Set_recording_params(RangeParams({-1.0, 1.0}, {static_cast<double>(b), b + 1.0 - step}, points));
+        blocks.push_back(std::make_shared<const RecordingVector>(std::move(vec)));
+    }
+    return blocks;
+}
+
+/**
+ * @brief BM_SummaryPyramid_build
+ * @note summaries of whole capture, range(0) = points of block, range(1) = 1 if TaskPool builds them
+ */
+void BM_SummaryPyramid_build(benchmark::State & state)
+{
+    const std::vector<BlockHandle> blocks = capture(static_cast<int>(state.range(0)));
+    static const std::shared_ptr<TaskPool> pool = std::make_shared<TaskPool>();
+    for (auto _ : state)
+    {
+        SummaryPyramid summary((state.range(1) == 1) ? pool : nullptr);
+        summary.Set_history_time_limit(capture_blocks);
+        for (const BlockHandle & block : blocks)
+        {
+            summary.Add_block(block);
+        }
+        while (summary.Get_progress().Get_fraction() < 1.0)
+        {
+            pool->Run_pending_task();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * capture_blocks * state.range(0));
+}
+BENCHMARK(BM_SummaryPyramid_build)->ArgsProduct({{1000, 100000}, {0, 1}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ * @brief BM_SummaryPyramid_query
+ * @note whole capture drawn to 200 columns, range(0) = points of block
+ */
+void BM_SummaryPyramid_query(benchmark::State & state)
+{
+    const std::vector<BlockHandle> blocks = capture(static_cast<int>(state.range(0)));
+    SummaryPyramid summary;
+    summary.Set_history_time_limit(capture_blocks);
+    for (const BlockHandle & block : blocks)
+    {
+        summary.Add_block(block);
+    }
+    std::vector<Timestamp> out;
+    for (auto _ : state)
+    {
+        summary.Query(0.0, capture_blocks, 200, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * capture_blocks * state.range(0));
+}
+BENCHMARK(BM_SummaryPyramid_query)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+}
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "TaskPool.h"
+#include "TextCodec.h"
+
+namespace
+{
+
+/**
+ * @brief sine_values
+ * @param count number of voltages
+ * @return voltages of sine, as Generator writes them
+ */
+std::vector<double> sine_values(std::size_t count)
+{
+    std::vector<double> values(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        values[i] = 2.0 * std::sin(2.0 * 3.14159265358979 * 5.0 * i / count);
+    }
+    return values;
+}
+
+/**
+ * @brief BM_TextCodec_encode
+ * @note one interval encoded to text, range(0) = sample rate
+ */
+void BM_TextCodec_encode(benchmark::State & state)
+{
+    const std::vector<double> values = sine_values(state.range(0));
+    std::string text;
+    for (auto _ : state)
+    {
+        text.clear();
+        TextCodec::Encode_interval(values, 1.0 / values.size(), (values.size() - 1.0) / values.size(), text);
+        benchmark::DoNotOptimize(text.data());
+    }
+    state.SetItemsProcessed(state.iterations() * values.size());
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_TextCodec_encode)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief BM_TextCodec_decode
+ * @note one interval decoded from text, range(0) = sample rate, range(1) = 1 if chunks are parsed by TaskPool
+ */
+void BM_TextCodec_decode(benchmark::State & state)
+{
+    const std::vector<double> values = sine_values(state.range(0));
+    std::string text;
+    TextCodec::Encode_interval(values, 1.0 / values.size(), (values.size() - 1.0) / values.size(), text);
+    static TaskPool pool;
+    TaskPool * const used_pool = (state.range(1) == 1) ? &pool : nullptr;
+    for (auto _ : state)
+    {
+        RecordingVector vec = TextCodec::Decode_interval(text, 0.0, std::pmr::get_default_resource(),
+                                                         static_cast<int>(values.size()), used_pool);
+        benchmark::DoNotOptimize(vec.Get_container().data());
+    }
+    state.SetItemsProcessed(state.iterations() * values.size());
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_TextCodec_decode)->ArgsProduct({{1000, 100000, 10000000}, {0, 1}})->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+}
@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <numbers>
+#include <thread>
+#include <vector>
+
+#include "XYAccumulator.h"
+
+namespace
+{
+
+/**
+ * @brief fill_channel
+ * @param data buffer to fill
+ * @param points number of timestamps
+ * @param sample_rate samples per second
+ * @param frequency frequency of sine
+ * @param time time of first timestamp, moved after last timestamp
+ */
+void fill_channel(std::vector<Timestamp> & data, int points, double sample_rate, double frequency, double & time)
+{
+    data.clear();
+    for (int i = 0; i < points; i++)
+    {
+        data.emplace_back(time, 2.0 * std::sin(2.0 * std::numbers::pi * frequency * time));
+        time += 1.0 / sample_rate;
+    }
+}
+
+/**
+ * @brief BM_XYPairs
+ * @note measures how many X/Y pairs per second accumulator thread aligns and bins,
+ * range(0) = points of one block of each channel
+ */
+void BM_XYPairs(benchmark::State & state)
+{
+    constexpr double sample_rate = 1e6;
+    const int points = static_cast<int>(state.range(0));
+    XYAccumulator accumulator;
+    accumulator.Start();
+    std::vector<Timestamp> x_block;
+    std::vector<Timestamp> y_block;
+    double x_time = 0.0;
+    double y_time = 0.0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        fill_channel(x_block, points, sample_rate, 3000.0, x_time);
+        fill_channel(y_block, points, sample_rate, 2000.0, y_time);
+        //last sample of X waits for next block of Y
+        const std::uint64_t expected = accumulator.Get_paired_points() + points - 1;
+        state.ResumeTiming();
+        accumulator.Push_x(x_block);
+        accumulator.Push_y(y_block);
+        while (accumulator.Get_paired_points() < expected)
+        {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+}
+BENCHMARK(BM_XYPairs)->RangeMultiplier(10)->Range(1000, 1000000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,369 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+//Projects includes
+#include "IReader.h"
+#include "FileReader.h"
+#include "FilterChain.h"
+#include "ReplayReader.h"
+#include "SocketReader.h"
+#include "DummyGenerator.h"
+#include "OverrunPolicy.h"
+#include "PipelineMetrics.h"
+#include "SummaryPyramid.h"
+#include "TaskPool.h"
+#include "Tracer.h"
+
+namespace
+{
+
+/**
+ * @struct CliOptions
+ * This struct stores options of headless run
+ */
+struct CliOptions
+{
+    int _seconds = 10;
+    int _rate = 1000;
+    int _history = 30;
+    bool _compress = false;
+    bool _metrics = false;
+    std::string _trace_fname;
+    std::string _filter_spec;
+    Dummy::FuncType _func = Dummy::FuncType::SIN;
+    std::string _replay_fname;
+    ReplayMode _replay_mode = ReplayMode::REAL_TIME;
+    double _replay_speed = 1.0;
+    bool _write_index = false;      //index is appended to replayed capture
+    std::string _socket_path;
+    bool _is_source = false;        //only generator runs, it streams to socket
+    bool _is_listener = false;      //only reader runs, source is other process
+    std::optional<OverrunPolicy> _overrun;  //generator and queue of reader, default as before
+    std::size_t _workers = 0;               //threads of task pool, 0 means by hardware
+};
+
+void print_usage(const char * name)
+{
+    std::cout << "Usage: " << name << " [options]\n"
+        << "  --seconds N     how long pipeline runs (default 10)\n"
+        << "  --rate N        generator points per second (default 1000)\n"
+        << "  --func NAME     generator function: sin, square, random (default sin)\n"
+        << "  --history N     seconds of history stored (default 30)\n"
+        << "  --compress      compress older history intervals\n"
+        << "  --filter SPEC   filter intervals read from generator, e.g. lowpass:50,cic:4\n"
+        << "                  (lowpass/highpass:HZ bandpass:LOW:HIGH fir:HZ:TAPS\n"
+        << "                  firband:LOW:HIGH:TAPS average:N decimate:N cic:N)\n"
+        << "  --replay FILE   replay capture file instead of running generator\n"
+        << "  --speed X       replay X times faster than real time\n"
+        << "  --fast          replay as fast as possible, stops at end of capture\n"
+        << "  --write-index   append index to replayed capture, so next replay doesn't scan it\n"
+        << "  --socket PATH   generator streams to reader over Unix domain socket PATH\n"
+        << "  --listen PATH   only reader runs, it receives from source process on PATH\n"
+        << "  --source PATH   only generator runs, it streams to reader process on PATH\n"
+        << "  --overrun NAME  what generator and reader do when consumer falls behind: block,\n"
+        << "                  drop-oldest, drop-newest or decimate (default generator blocks,\n"
+        << "                  reader drops newest)\n"
+        << "  --workers N     threads of task pool which parses and summarizes intervals\n"
+        << "                  (default cores - 1)\n"
+        << "  --metrics       print latency of pipeline stages at exit\n"
+        << "  --trace FILE    write Chrome trace JSON of pipeline at exit\n";
+}
+
+/**
+ * @brief print_metrics
+ * @param snapshot statistics of pipeline
+ */
+void print_metrics(const MetricsSnapshot & snapshot)
+{
+    std::cout << "stage      count    mean[us]  p50[us]  p99[us]  max[us]\n";
+    for (std::size_t s = 0; s < pipeline_stages; s++)
+    {
+        const StageSnapshot & stage = snapshot._stages[s];
+        if (stage._count == 0)
+            continue;
+        std::printf("%-9s %6llu %10.1f %8.1f %8.1f %8.1f\n", Get_stage_name(static_cast<PipelineStage>(s)),
+            static_cast<unsigned long long>(stage._count), stage.Get_mean_ns() / 1000.0,
+            stage.Get_percentile_ns(0.5) / 1000.0, stage.Get_percentile_ns(0.99) / 1000.0, stage._max_ns / 1000.0);
+    }
+    for (std::size_t c = 0; c < pipeline_counters; c++)
+    {
+        if (snapshot._counters[c] > 0)
+            std::cout << Get_counter_name(static_cast<PipelineCounter>(c)) << ": " << snapshot._counters[c] << '\n';
+    }
+    for (const ThreadSnapshot & thread : snapshot._threads)
+        std::cout << "thread: " << thread._name << '\n';
+}
+
+/**
+ * @brief parse_options
+ * @return true if options are valid and pipeline should run
+ */
+bool parse_options(int argc, char ** argv, CliOptions & options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--seconds" && has_value)
+            options._seconds = std::stoi(argv[++i]);
+        else if (arg == "--rate" && has_value)
+            options._rate = std::stoi(argv[++i]);
+        else if (arg == "--history" && has_value)
+            options._history = std::stoi(argv[++i]);
+        else if (arg == "--compress")
+            options._compress = true;
+        else if (arg == "--metrics")
+            options._metrics = true;
+        else if (arg == "--trace" && has_value)
+            options._trace_fname = argv[++i];
+        else if (arg == "--filter" && has_value)
+            options._filter_spec = argv[++i];
+        else if (arg == "--func" && has_value)
+        {
+            const std::string func = argv[++i];
+            if (func == "sin")
+                options._func = Dummy::FuncType::SIN;
+            else if (func == "square")
+                options._func = Dummy::FuncType::SQUARE;
+            else if (func == "random")
+                options._func = Dummy::FuncType::RANDOM;
+            else
+                return false;
+        }
+        else if (arg == "--replay" && has_value)
+            options._replay_fname = argv[++i];
+        else if (arg == "--speed" && has_value)
+        {
+            options._replay_mode = ReplayMode::ACCELERATED;
+            options._replay_speed = std::stod(argv[++i]);
+        }
+        else if (arg == "--fast")
+            options._replay_mode = ReplayMode::AS_FAST_AS_POSSIBLE;
+        else if (arg == "--write-index")
+            options._write_index = true;
+        else if (arg == "--socket" && has_value)
+            options._socket_path = argv[++i];
+        else if (arg == "--listen" && has_value)
+        {
+            options._socket_path = argv[++i];
+            options._is_listener = true;
+        }
+        else if (arg == "--overrun" && has_value)
+        {
+            const std::optional<OverrunPolicy> policy = Parse_overrun_policy(argv[++i]);
+            if (!policy)
+                return false;
+            options._overrun = policy;
+        }
+        else if (arg == "--workers" && has_value)
+            options._workers = std::stoul(argv[++i]);
+        else if (arg == "--source" && has_value)
+        {
+            options._socket_path = argv[++i];
+            options._is_source = true;
+        }
+        else
+            return false;
+    }
+    return options._seconds > 0 && options._rate > 0 && options._history > 0;
+}
+
+} //namespace
+
+int main(int argc, char ** argv)
+{
+    CliOptions options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<Dummy::Generator> gen;
+    std::unique_ptr<IReader> reader;
+    ReplayReader * replay = nullptr;
+    FileReader * file_reader = nullptr;
+    if (options._replay_fname.empty() && !options._socket_path.empty())
+    {
+        if (!options._is_listener)
+        {
+            Dummy::FuncIterator func = Dummy::Create_Func(options._func, options._rate, 5, 2);
+            gen = std::make_unique<Dummy::Generator>(func, options._rate, std::make_unique<SocketSink>(options._socket_path));
+        }
+        if (!options._is_source)
+        {
+            reader = std::make_unique<SocketReader>(options._socket_path);
+        }
+    }
+    else if (options._replay_fname.empty())
+    {
+        Dummy::FuncIterator func = Dummy::Create_Func(options._func, options._rate, 5, 2);
+        gen = std::make_unique<Dummy::Generator>(func, options._rate);
+        auto new_file_reader = std::make_unique<FileReader>();
+        file_reader = new_file_reader.get();
+        reader = std::move(new_file_reader);
+    }
+    else
+    {
+        auto replay_reader = std::make_unique<ReplayReader>(options._replay_fname,
+            options._replay_mode, options._replay_speed);
+        replay = replay_reader.get();
+        reader = std::move(replay_reader);
+    }
+    if (gen && options._overrun)
+        gen->Set_overrun_policy(*options._overrun);
+    if (!reader)
+    {
+        //source process only streams to reader of other process
+        Tracer::Instance().Set_enabled(!options._trace_fname.empty());
+        gen->Start();
+        std::this_thread::sleep_for(std::chrono::seconds(options._seconds));
+        gen->Destroy();
+        const MetricsSnapshot snapshot = PipelineMetrics::Instance().Get_snapshot();
+        std::cout << "points generated: " << snapshot._counters[static_cast<std::size_t>(PipelineCounter::POINTS_GENERATED)] << '\n';
+        if (options._metrics)
+            print_metrics(snapshot);
+        return 0;
+    }
+    //one pool for CPU heavy work of whole pipeline
+    const auto task_pool = std::make_shared<TaskPool>(options._workers);
+    if (file_reader)
+        file_reader->Set_task_pool(task_pool);
+    if (replay)
+        replay->Set_task_pool(task_pool);
+    reader->Set_history_time_limit(options._history);
+    reader->Set_history_compression(options._compress);
+    //every interval pushed by reader is taken from queue, even several between two polls
+    auto block_queue = std::make_shared<BlockQueue>(64, options._overrun.value_or(OverrunPolicy::DROP_NEWEST));
+    reader->Set_block_queue(block_queue);
+    //render summaries, as UI builds them for zoomed out view
+    SummaryPyramid summary(task_pool);
+    summary.Set_history_time_limit(options._history);
+    if (!options._filter_spec.empty())
+    {
+        if (!file_reader)
+        {
+            std::cerr << "--filter works only with generator\n";
+            return 1;
+        }
+        try
+        {
+            file_reader->Set_filter(FilterChain::Parse(options._filter_spec, options._rate));
+        }
+        catch (const std::runtime_error & error)
+        {
+            std::cerr << error.what() << '\n';
+            return 1;
+        }
+    }
+    Tracer::Instance().Set_enabled(!options._trace_fname.empty());
+
+    const auto start = std::chrono::steady_clock::now();
+    try
+    {
+        reader->Start();
+    }
+    catch (const std::runtime_error & error)
+    {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+    bool first_interval = true;
+    if (gen)
+        gen->Start();
+
+    long long total_points = 0;
+    int intervals = 0;
+    std::vector<BlockHandle> blocks;
+    const auto deadline = start + std::chrono::seconds(options._seconds);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        blocks.clear();
+        if (block_queue->Drain(blocks) > 0)
+        {
+            //history is changed by reader thread meanwhile, so it is read under its lock
+            const HistorySnapshot history = reader->Get_history_snapshot();
+            for (const BlockHandle & block : blocks)
+            {
+                const RangeParams newest = block->Get_recording_params();
+                total_points += newest.Get_max_index();
+                intervals++;
+                summary.Add_block(block);
+                if (first_interval)
+                {
+                    const std::chrono::duration<double, std::milli> first = std::chrono::steady_clock::now() - start;
+                    std::cout << "first interval after " << first.count() << " ms\n";
+                    first_interval = false;
+                }
+                if (!replay || options._replay_mode != ReplayMode::AS_FAST_AS_POSSIBLE)
+                {
+                    std::cout << "interval " << intervals << ": " << newest.Get_max_index() << " points, time "
+                        << newest.Get_min_time() << " - " << newest.Get_max_time()
+                        << ", history " << history._params.Get_max_index() << " points\n";
+                }
+            }
+        }
+        if (replay && replay->Is_finished())
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    reader->Destroy();
+    if (gen)
+        gen->Destroy();
+    const auto summary_start = std::chrono::steady_clock::now();
+    while (summary.Get_progress().Get_fraction() < 1.0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const std::chrono::duration<double, std::milli> summary_wait = std::chrono::steady_clock::now() - summary_start;
+    if (replay)
+    {
+        total_points = replay->Get_replayed_points();
+        const std::shared_ptr<CaptureIndex> index = replay->Get_capture_index();
+        std::cout << "capture index: " << index->Get_entry_count() << " intervals, "
+            << (index->Has_footer() ? "read from footer" : "built by scanning") << '\n';
+        if (options._write_index)
+        {
+            //intervals not replayed before deadline are indexed now
+            index->Index_more(std::numeric_limits<std::size_t>::max());
+            if (index->Has_footer())
+                std::cout << "capture already has index\n";
+            else if (!index->Write_footer())
+                std::cerr << "can't append index to " << options._replay_fname << '\n';
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "points: " << total_points << ", elapsed: " << elapsed.count() << " s, "
+        << total_points / elapsed.count() << " points/s\n";
+    if (!options._filter_spec.empty())
+        std::cout << "filtered points: " << file_reader->Get_filtered_points() << '\n';
+    std::cout << "summary: " << summary.Get_progress()._blocks << " blocks, finished " << summary_wait.count()
+        << " ms after reader on " << task_pool->Get_worker_count() << " workers\n";
+    std::cout << "queue: " << block_queue->Get_pushed() << " blocks, " << block_queue->Get_dropped()
+        << " dropped, " << block_queue->Get_decimated() << " decimated, high water " << block_queue->Get_high_water()
+        << " of " << block_queue->Get_capacity() << '\n';
+    try
+    {
+        const RecordingHistory & history = reader->Get_data();
+        std::cout << "lost intervals: " << history.Get_lost_intervals() << ", gaps in history: " << history.Get_gaps().size() << '\n';
+    }
+    catch (const std::runtime_error &)
+    {
+        //nothing was received
+    }
+    if (options._metrics)
+        print_metrics(PipelineMetrics::Instance().Get_snapshot());
+    if (!options._trace_fname.empty() && !Tracer::Instance().Dump(options._trace_fname))
+    {
+        std::cerr << "can't write trace to " << options._trace_fname << '\n';
+        return 1;
+    }
+    return 0;
+}
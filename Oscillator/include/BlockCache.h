@@ -0,0 +1,122 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+
+/**
+ * @class BlockCache
+ * This class implements least recently used cache. When capacity is reached
+ * entry that was not accessed for the longest time is removed.
+ * @tparam Key key of cached entry, must be hashable
+ * @tparam Value cached entry, should be cheap to copy (e.g. shared_ptr)
+ */
+template <class Key, class Value>
+class BlockCache
+{
+public:
+    explicit BlockCache(std::size_t capacity)
+        : _capacity(capacity == 0 ? 1 : capacity)
+    {
+        //Empty
+    }
+
+    /**
+     * @brief Get
+     * @param key key of entry
+     * @return pointer to cached value or nullptr if entry is not cached
+     * @note marks entry as most recently used
+     */
+    [[nodiscard]] Value* Get(const Key & key)
+    {
+        auto found = _map.find(key);
+        if (found == _map.end())
+        {
+            return nullptr;
+        }
+        _entries.splice(_entries.begin(), _entries, found->second);
+        return &found->second->second;
+    }
+
+    /**
+     * @brief Put
+     * @param key key of entry
+     * @param value value to cache
+     * @note if key is already cached its value is replaced
+     */
+    void Put(const Key & key, Value value)
+    {
+        auto found = _map.find(key);
+        if (found != _map.end())
+        {
+            found->second->second = std::move(value);
+            _entries.splice(_entries.begin(), _entries, found->second);
+            return;
+        }
+        _entries.emplace_front(key, std::move(value));
+        _map[key] = _entries.begin();
+        evict();
+    }
+
+    /**
+     * @brief Erase
+     * @param key key of entry to remove
+     */
+    void Erase(const Key & key)
+    {
+        auto found = _map.find(key);
+        if (found != _map.end())
+        {
+            _entries.erase(found->second);
+            _map.erase(found);
+        }
+    }
+
+    /**
+     * @brief Set_capacity
+     * @param capacity max number of cached entries
+     */
+    void Set_capacity(std::size_t capacity)
+    {
+        _capacity = (capacity == 0) ? 1 : capacity;
+        evict();
+    }
+
+    /**
+     * @brief Size
+     * @return number of cached entries
+     */
+    [[nodiscard]] std::size_t Size() const
+    {
+        return _entries.size();
+    }
+
+    /**
+     * @brief Clear
+     * @note removes all entries
+     */
+    void Clear()
+    {
+        _entries.clear();
+        _map.clear();
+    }
+private:
+    using entry_list = std::list<std::pair<Key, Value>>;
+
+    std::size_t _capacity;
+    entry_list _entries;    //front is most recently used
+    std::unordered_map<Key, typename entry_list::iterator> _map;
+
+    /**
+     * @brief evict
+     * @note removes least recently used entries above capacity
+     */
+    void evict()
+    {
+        while (_entries.size() > _capacity)
+        {
+            _map.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+    }
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "RecordingContainers.h"
+
+/**
+ * @class CompressedBlock
+ * This class implements lossless compressed storage of one interval of Timestamps.
+ * Time is stored as delta of delta of its bit pattern (constant sampling costs 1 bit),
+ * voltage is stored as XOR with previous value (Gorilla style), so only bits that
+ * changed are saved.
+ */
+class CompressedBlock
+{
+public:
+    CompressedBlock() = default;
+
+    /**
+     * @brief CompressedBlock constructor
+     * @param data timestamps to compress
+     */
+    explicit CompressedBlock(std::span<const Timestamp> data);
+
+    /**
+     * @brief Decompress
+     * @param out container to which decompressed timestamps are appended
+     */
+    void Decompress(RecordingVector::type & out) const;
+
+    /**
+     * @brief Size
+     * @return number of compressed timestamps
+     */
+    [[nodiscard]] std::size_t Size() const;
+
+    /**
+     * @brief Get_bytes
+     * @return number of bytes used by compressed data
+     */
+    [[nodiscard]] std::size_t Get_bytes() const;
+private:
+    std::vector<std::uint64_t> _bits;
+    std::size_t _count {0};
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+
+/**
+ * @class BlockPool
+ * This class implements memory resource that recycles buffers of RecordingVectors.
+ * Requested sizes are rounded up to power of two (size class), released buffers are kept
+ * on free list of their size class and given back on next allocation of the same class.
+ * Because intervals have constant length, after first few intervals every allocation is
+ * served from free lists and upstream resource (malloc) is not used anymore.
+ */
+class BlockPool final : public std::pmr::memory_resource
+{
+public:
+    /**
+     * @brief BlockPool constructor
+     * @param upstream resource used when free list of size class is empty
+     */
+    explicit BlockPool(std::pmr::memory_resource * upstream = std::pmr::new_delete_resource());
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    /**
+     * @brief Get_upstream_allocations
+     * @return how many times buffer was allocated from upstream resource
+     */
+    [[nodiscard]] std::size_t Get_upstream_allocations() const;
+
+    /**
+     * @brief Get_cached_bytes
+     * @return bytes held on free lists
+     */
+    [[nodiscard]] std::size_t Get_cached_bytes() const;
+
+    /**
+     * @brief Release
+     * @note gives all buffers from free lists back to upstream resource
+     */
+    void Release();
+
+    ~BlockPool();
+private:
+    /**
+     * @struct free_node
+     * Free list is stored inside released buffers, so it never allocates.
+     */
+    struct free_node
+    {
+        free_node * _next;
+    };
+
+    static constexpr std::size_t min_class_bytes = 64;
+    static constexpr int size_classes = 48;
+
+    std::pmr::memory_resource * _upstream;
+    std::array<free_node*, size_classes> _free_lists {};
+    mutable std::mutex _mutex;
+    std::atomic_size_t _upstream_allocations {0};
+    std::size_t _cached_bytes {0};
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void * ptr, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override;
+
+    /**
+     * @brief size_class
+     * @param bytes requested size
+     * @return index of size class, buffer of this class has min_class_bytes << index bytes
+     */
+    static int size_class(std::size_t bytes);
+};
+
+/**
+ * @class PoolAllocator
+ * This class implements allocator from shared BlockPool which keeps pool alive, so objects
+ * allocated by it (e.g. by std::allocate_shared) may outlive owner of pool.
+ */
+template <class T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    /**
+     * @brief PoolAllocator constructor
+     * @param pool pool from which objects are allocated
+     */
+    explicit PoolAllocator(std::shared_ptr<BlockPool> pool) : _pool(std::move(pool)) {}
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U> & other) : _pool(other.Get_pool()) {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(_pool->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T * ptr, std::size_t n)
+    {
+        _pool->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    /**
+     * @brief Get_pool
+     * @return pool from which objects are allocated
+     */
+    [[nodiscard]] const std::shared_ptr<BlockPool>& Get_pool() const
+    {
+        return _pool;
+    }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U> & other) const
+    {
+        return _pool == other.Get_pool();
+    }
+private:
+    std::shared_ptr<BlockPool> _pool;
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "BlockPool.h"
+#include "RecordingContainers.h"
+#include "OverrunPolicy.h"
+
+//interval shared by reader with consumer, it is not changed after it was queued
+using BlockHandle = std::shared_ptr<const RecordingVector>;
+
+/**
+ * @brief Make_block
+ * @param interval interval moved into block, its timestamps are not copied
+ * @param pool pool from which timestamps were allocated, block is allocated from it too and keeps it alive
+ * @return immutable block, reader pushes view of it (RecordingVector(block)) to history
+ */
+BlockHandle Make_block(RecordingVector && interval, const std::shared_ptr<BlockPool> & pool);
+
+/**
+ * @class BlockQueue
+ * This class implements bounded lock-free queue of intervals from one producer (Reader thread)
+ * to one consumer (UI thread). Reader queues every interval it pushes to history, UI drains
+ * all queued intervals once per frame, so no interval is missed between two frames. What
+ * happens when UI falls behind is chosen by OverrunPolicy: Reader waits at most
+ * block_timeout (BLOCK), oldest queued interval is dropped (DROP_OLDEST), new interval is
+ * dropped (DROP_NEWEST), or intervals are queued decimated while queue is half full and
+ * dropped when it is full (DECIMATE). Every dropped interval is counted.
+ * Queue shares blocks it is given, only decimated intervals are copies.
+ */
+class BlockQueue final
+{
+public:
+    //longest wait of producer with OverrunPolicy::BLOCK, then interval is dropped
+    static constexpr std::chrono::milliseconds block_timeout {1000};
+
+    /**
+     * @brief BlockQueue constructor
+     * @param capacity maximal number of queued intervals, rounded up to power of two
+     * @param policy what producer does when queue is full
+     */
+    explicit BlockQueue(std::size_t capacity = 64, OverrunPolicy policy = OverrunPolicy::DROP_NEWEST);
+
+    BlockQueue(const BlockQueue&) = delete;
+    BlockQueue& operator=(const BlockQueue&) = delete;
+
+    /**
+     * @brief Push
+     * @param block interval to queue, it is shared (copied decimated with OverrunPolicy::DECIMATE)
+     * @return false if interval was dropped
+     * @note called only by producer
+     */
+    bool Push(BlockHandle block);
+
+    /**
+     * @brief Try_pop
+     * @param out oldest queued interval
+     * @return false if queue is empty
+     * @note called only by consumer
+     */
+    bool Try_pop(BlockHandle & out);
+
+    /**
+     * @brief Drain
+     * @param out all queued intervals are appended to it in order
+     * @return number of appended intervals
+     * @note called only by consumer
+     */
+    std::size_t Drain(std::vector<BlockHandle> & out);
+
+    /**
+     * @brief Get_policy
+     * @return what producer does when queue is full
+     */
+    [[nodiscard]] OverrunPolicy Get_policy() const;
+
+    /**
+     * @brief Get_size
+     * @return number of queued intervals
+     */
+    [[nodiscard]] std::size_t Get_size() const;
+
+    /**
+     * @brief Get_capacity
+     * @return maximal number of queued intervals
+     */
+    [[nodiscard]] std::size_t Get_capacity() const;
+
+    /**
+     * @brief Get_pushed
+     * @return number of intervals queued since construction
+     */
+    [[nodiscard]] std::uint64_t Get_pushed() const;
+
+    /**
+     * @brief Get_dropped
+     * @return number of intervals dropped because queue was full
+     */
+    [[nodiscard]] std::uint64_t Get_dropped() const;
+
+    /**
+     * @brief Get_decimated
+     * @return number of intervals queued decimated
+     */
+    [[nodiscard]] std::uint64_t Get_decimated() const;
+
+    /**
+     * @brief Get_high_water
+     * @return largest number of queued intervals seen by producer
+     */
+    [[nodiscard]] std::size_t Get_high_water() const;
+private:
+    /**
+     * @struct Slot
+     * Queued interval, it belongs to whoever advanced head over the slot. New owner empties
+     * the slot, producer reuses it only after that, so block is never read and written at once.
+     */
+    struct Slot
+    {
+        BlockHandle _block;
+        std::atomic_bool _occupied {false};
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    std::size_t _capacity;
+    std::size_t _mask;
+    OverrunPolicy _policy;
+    //positions only grow, slot is position & _mask, producer and consumer use separate cache lines
+    alignas(64) std::atomic<std::size_t> _tail {0};
+    std::atomic_uint64_t _dropped {0};
+    std::atomic_uint64_t _decimated {0};
+    std::atomic<std::size_t> _high_water {0};
+    //advanced by consumer, and by producer which drops oldest interval
+    alignas(64) std::atomic<std::size_t> _head {0};
+
+    /**
+     * @brief make_room
+     * @return true if queue is not full anymore, otherwise new interval has to be dropped
+     * @note waits or drops oldest interval according to policy
+     */
+    bool make_room();
+
+    /**
+     * @brief drop
+     * @note counts dropped interval
+     */
+    void drop();
+};
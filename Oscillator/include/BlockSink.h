@@ -0,0 +1,143 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SpoolQueue.h"
+
+/**
+ * @struct SampleFrameHeader
+ * This struct starts every frame of samples sent over socket. It is followed by _count
+ * pairs of doubles (time relative to start of interval, voltage) in byte order of the host,
+ * socket connects processes of the same host. Sequence number grows by one with every
+ * interval, also with the one which was dropped, so reader can detect gaps.
+ */
+struct SampleFrameHeader
+{
+    std::uint32_t _magic;
+    std::uint32_t _count;
+    std::uint64_t _sequence;
+};
+
+//"OSCF" read as little endian number
+constexpr std::uint32_t sample_frame_magic = 0x4643534f;
+//bytes of one sample in frame, time and voltage
+constexpr std::size_t sample_frame_point_size = 2 * sizeof(double);
+
+/**
+ * @class IBlockSink
+ * This class provides interface for transports to which Generator writes intervals.
+ */
+class IBlockSink
+{
+public:
+    /**
+     * @brief Reset
+     * @note called when Generator starts, discards what was left by previous run
+     */
+    virtual void Reset() = 0;
+
+    /**
+     * @brief Is_ready
+     * @return true if next interval can be written without waiting
+     */
+    [[nodiscard]] virtual bool Is_ready() = 0;
+
+    /**
+     * @brief Get_load
+     * @return how much consumer is behind, 0.0 nothing waits for it, 1.0 transport is full
+     */
+    [[nodiscard]] virtual double Get_load() = 0;
+
+    /**
+     * @brief Skip_block
+     * @note interval dropped by producer, consumer sees gap instead of it
+     */
+    virtual void Skip_block() = 0;
+
+    /**
+     * @brief Drop_oldest
+     * @return true if oldest interval not taken by consumer was dropped
+     */
+    virtual bool Drop_oldest() = 0;
+
+    /**
+     * @brief Write_block
+     * @param values voltages of one interval
+     * @param step time between two samples, time of first sample is 0
+     * @param last_time time of last sample, decimated interval keeps its last sample off step
+     * @return true if interval was written
+     */
+    virtual bool Write_block(std::span<const double> values, double step, double last_time) = 0;
+
+    virtual ~IBlockSink() = default;
+};
+
+/**
+ * @class FileSink
+ * This class writes every interval as text file to spool directory (see SpoolQueue), from
+ * which FileReader reads and removes them in order. Sink runs at most max_ahead intervals
+ * ahead of reader, load is number of intervals waiting divided by max_ahead.
+ */
+class FileSink final : public IBlockSink
+{
+public:
+    /**
+     * @brief FileSink constructor
+     * @param fname name of spool directory
+     * @param max_ahead maximal number of intervals not read by reader yet
+     */
+    explicit FileSink(std::string_view fname = "tmp", std::size_t max_ahead = 8);
+
+    void Reset() override;
+    [[nodiscard]] bool Is_ready() override;
+    [[nodiscard]] double Get_load() override;
+    void Skip_block() override;
+    bool Drop_oldest() override;
+    bool Write_block(std::span<const double> values, double step, double last_time) override;
+private:
+    SpoolQueue _spool;
+    std::size_t _max_ahead;
+    std::string _text;
+};
+
+/**
+ * @class SocketSink
+ * This class streams intervals as frames over Unix domain socket to SocketReader,
+ * connection is opened when it is needed and reopened after it was lost. Load is part
+ * of send buffer of socket not taken by reader yet, frames already sent can't be dropped.
+ */
+class SocketSink final : public IBlockSink
+{
+public:
+    /**
+     * @brief SocketSink constructor
+     * @param path path of socket on which SocketReader listens
+     */
+    explicit SocketSink(std::string_view path);
+
+    SocketSink(const SocketSink&) = delete;
+    SocketSink& operator=(const SocketSink&) = delete;
+
+    void Reset() override;
+    [[nodiscard]] bool Is_ready() override;
+    [[nodiscard]] double Get_load() override;
+    void Skip_block() override;
+    bool Drop_oldest() override;
+    bool Write_block(std::span<const double> values, double step, double last_time) override;
+
+    ~SocketSink();
+private:
+    std::string _path;
+    int _socket {-1};
+    std::uint64_t _sequence {0};
+    std::vector<char> _frame;
+
+    /**
+     * @brief close_socket
+     * @note closes connection, next Is_ready() connects again
+     */
+    void close_socket();
+};
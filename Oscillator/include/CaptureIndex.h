@@ -0,0 +1,170 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "TaskPool.h"
+
+/**
+ * @struct CaptureEntry
+ * This struct stores where one interval of capture is and which time it covers.
+ * It is also layout of entry in footer of capture file.
+ */
+struct CaptureEntry
+{
+    std::uint64_t _offset;      //first byte of interval in capture
+    std::uint64_t _length;      //bytes of complete lines of interval
+    double _time_offset;        //added to times of interval, capture may be concatenation of files
+    double _min_time;           //time of first point, with offset
+    double _max_time;           //time of last point, with offset
+    std::uint64_t _points;      //number of lines with time and voltage
+};
+
+/**
+ * @struct CaptureFooter
+ * This struct ends capture file which has index: entries are stored right before it,
+ * text of capture ends at _data_size.
+ */
+struct CaptureFooter
+{
+    char _magic[8];
+    std::uint64_t _entries;
+    std::uint64_t _data_size;
+    std::uint64_t _entry_size;
+};
+
+/**
+ * @class CaptureIndex
+ * This class gives random access to intervals of capture file (lines of "time voltage").
+ * File is mapped to memory, so opening takes the same time for any size. If file ends with
+ * footer written by Write_footer(), index is read from it and nothing else is touched.
+ * Otherwise index is built lazily: Get_entry() scans only as far as requested interval, and
+ * Index_in_background() scans rest of file by low priority tasks of TaskPool meanwhile.
+ * Scanning only validates lines and reads their times, timestamps are decoded later by reader of interval.
+ */
+class CaptureIndex final
+{
+public:
+    //time span of one interval
+    static constexpr double interval_time = 1.0;
+    //intervals scanned by one background task, pool can run other tasks between them
+    static constexpr std::size_t background_entries = 64;
+
+    /**
+     * @brief CaptureIndex constructor
+     * @param fname path to capture file
+     * @throws runtime_error if file can't be opened or mapped
+     */
+    explicit CaptureIndex(const std::filesystem::path & fname);
+
+    CaptureIndex(const CaptureIndex&) = delete;
+    CaptureIndex& operator=(const CaptureIndex&) = delete;
+
+    /**
+     * @brief Get_entry
+     * @param i index of interval
+     * @param out found interval
+     * @return false if capture has less intervals
+     * @note scans capture up to interval if it was not indexed yet
+     */
+    bool Get_entry(std::size_t i, CaptureEntry & out);
+
+    /**
+     * @brief Get_text
+     * @param entry interval of this capture
+     * @return lines of interval, they stay valid while index exists
+     */
+    [[nodiscard]] std::string_view Get_text(const CaptureEntry & entry) const;
+
+    /**
+     * @brief Index_more
+     * @param entries max number of intervals to scan
+     * @return number of intervals indexed by this call
+     */
+    std::size_t Index_more(std::size_t entries);
+
+    /**
+     * @brief Index_in_background
+     * @param index index to complete
+     * @param pool pool which runs scanning tasks with priority of PipelineStage::INDEX
+     * @note scanning stops when index is complete, cancelled or destroyed
+     */
+    static void Index_in_background(const std::shared_ptr<CaptureIndex> & index, TaskPool & pool);
+
+    /**
+     * @brief Cancel
+     * @note background scanning stops after its current task, Get_entry() still works
+     */
+    void Cancel();
+
+    /**
+     * @brief Is_complete
+     * @return true if whole capture is indexed
+     */
+    [[nodiscard]] bool Is_complete() const;
+
+    /**
+     * @brief Has_footer
+     * @return true if index was read from footer of capture
+     */
+    [[nodiscard]] bool Has_footer() const;
+
+    /**
+     * @brief Get_entry_count
+     * @return number of intervals indexed so far
+     */
+    [[nodiscard]] std::size_t Get_entry_count() const;
+
+    /**
+     * @brief Get_progress
+     * @return indexed part of capture text, from 0.0 to 1.0
+     */
+    [[nodiscard]] double Get_progress() const;
+
+    /**
+     * @brief Write_footer
+     * @return true if index was appended to capture file
+     * @note whole capture has to be indexed, capture with footer is not changed
+     */
+    bool Write_footer();
+
+    ~CaptureIndex();
+private:
+    std::filesystem::path _fname;
+    const char * _text {nullptr};
+    std::size_t _map_size {0};
+    //size of capture text, footer and its entries follow it
+    std::size_t _data_size {0};
+    bool _has_footer {false};
+
+    //guards _entries
+    mutable std::mutex _mutex;
+    std::vector<CaptureEntry> _entries;
+    std::atomic_bool _complete {false};
+    std::atomic_bool _cancelled {false};
+    std::atomic<std::size_t> _scanned {0};
+
+    //only one thread scans, state of scan is guarded by it
+    std::mutex _scan_mutex;
+    std::size_t _position {0};
+    double _offset {0.0};
+    double _last_raw_time {0.0};
+    double _last_time {0.0};
+
+    /**
+     * @brief read_footer
+     * @return true if capture ends with valid footer, its entries are loaded then
+     */
+    bool read_footer();
+
+    /**
+     * @brief scan_next
+     * @return false if whole capture is indexed and there is no next interval
+     * @note _scan_mutex has to be locked
+     */
+    bool scan_next();
+};
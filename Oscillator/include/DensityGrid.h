@@ -0,0 +1,84 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @class DensityGrid
+ * This class stores 2D hit-count histogram which decays with time. It is used by
+ * accumulators of phosphor and XY views, it is not thread safe, owner guards it.
+ */
+class DensityGrid final
+{
+public:
+    /**
+     * @brief DensityGrid constructor
+     * @param columns number of horizontal bins
+     * @param rows number of vertical bins
+     */
+    explicit DensityGrid(int columns = 0, int rows = 0);
+
+    /**
+     * @brief Bin_of
+     * @param column horizontal position in bins
+     * @param row vertical position in bins, row 0 is top
+     * @param columns number of horizontal bins
+     * @param rows number of vertical bins
+     * @return index of bin, -1 if position is outside of grid
+     * @note branch free, so loops calling it are vectorised by compiler
+     */
+    [[nodiscard]] static std::int32_t Bin_of(double column, double row, std::int32_t columns, std::int32_t rows)
+    {
+        //positions are shifted by one bin, so truncation works as floor for clamped values
+        const double shifted_column = std::clamp(column + 1.0, 0.0, columns + 1.0);
+        const double shifted_row = std::clamp(row + 1.0, 0.0, rows + 1.0);
+        const std::int32_t c = static_cast<std::int32_t>(shifted_column) - 1;
+        const std::int32_t r = static_cast<std::int32_t>(shifted_row) - 1;
+        const bool inside = c >= 0 && c < columns && r >= 0 && r < rows;
+        return inside ? r * columns + c : -1;
+    }
+
+    /**
+     * @brief Resize
+     * @param columns number of horizontal bins
+     * @param rows number of vertical bins
+     * @note histogram is cleared
+     */
+    void Resize(int columns, int rows);
+
+    /**
+     * @brief Clear
+     * @note sets all bins to zero
+     */
+    void Clear();
+
+    /**
+     * @brief Add_hits
+     * @param bins indexes of hit bins, negative indexes are skipped
+     */
+    void Add_hits(std::span<const std::int32_t> bins);
+
+    /**
+     * @brief Decay
+     * @param elapsed seconds since last decay
+     * @param half_life seconds after which hits lose half of intensity, 0 means no decay
+     */
+    void Decay(double elapsed, double half_life);
+
+    /**
+     * @brief Copy_intensity
+     * @param out row-major intensities from 0.0 to 1.0 (log scaled hits)
+     * @return true if histogram changed since last copy
+     */
+    bool Copy_intensity(std::vector<float> & out);
+
+    [[nodiscard]] int Get_columns() const;
+    [[nodiscard]] int Get_rows() const;
+private:
+    std::vector<float> _hits;
+    int _columns;
+    int _rows;
+    bool _changed {false};
+};
@@ -3,7 +3,11 @@
 #include <thread>
 #include <fstream>
 #include <atomic>
+#include <memory>
+#include <vector>
+#include "BlockSink.h"
 #include "FuncIterator.h"
+#include "OverrunPolicy.h"
 
 namespace Dummy
 {
@@ -13,13 +17,34 @@ namespace Dummy
  * @note This class is imitates oscilloscope output, by generating signal provided
  * by FuncIterator, with resolution (how many time points per second). Generator creates
  * temporary file with data and waits until craeted file is removed. When file is removed
- * generator creates new file with data.
+ * generator creates new file with data. With SocketSink intervals are streamed over socket.
+ * When reader falls behind, overrun policy decides if generator waits, drops or decimates.
  */
 class Generator final
 {
 public:
     Generator(Dummy::FuncIterator & func, int resolution, const std::string_view & tmp_fname = std::string("tmp"));
 
+    /**
+     * @brief Generator constructor
+     * @param func generated signal
+     * @param resolution time points per second
+     * @param sink transport to which intervals are written
+     */
+    Generator(Dummy::FuncIterator & func, int resolution, std::unique_ptr<IBlockSink> sink);
+
+    /**
+     * @brief Set_overrun_policy
+     * @param policy what Generator does when sink is full, OverrunPolicy::BLOCK by default
+     */
+    void Set_overrun_policy(OverrunPolicy policy);
+
+    /**
+     * @brief Get_overrun_policy
+     * @return what Generator does when sink is full
+     */
+    [[nodiscard]] OverrunPolicy Get_overrun_policy() const;
+
     /**
      * @brief Start
      * @note starts execution of Generator thread
@@ -44,13 +69,22 @@ public:
      */
     void Destroy();
 
+    /**
+     * @brief Write_interval
+     * @param out stream to which one interval (1 second) of "time voltage" lines is written
+     */
+    void Write_interval(std::ostream & out);
+
     ~Generator();
 private:
-    std::ofstream _ofile;
     std::thread _thread;
     Dummy::FuncIterator _func_iter;
     int _resolution;
-    std::string _fname;
+    std::unique_ptr<IBlockSink> _sink;
+    std::vector<double> _values;
+    std::vector<double> _decimated;
+    std::atomic<OverrunPolicy> _policy {OverrunPolicy::BLOCK};
+    std::string _text;
 
     //states
     std::atomic_bool _destroyed;
@@ -58,6 +92,19 @@ private:
     std::atomic_bool _stop_flag;
     std::atomic_bool _running;
 
+    /**
+     * @brief generate
+     * @note fills _values with next interval of signal
+     */
+    void generate();
+
+    /**
+     * @brief write_block
+     * @param load load of sink before interval was generated
+     * @note writes _values to sink, dropped or decimated according to overrun policy
+     */
+    void write_block(double load);
+
     /**
      * @brief running_loop
      * @note loop in which Generator creates data
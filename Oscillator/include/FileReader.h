@@ -1,14 +1,28 @@
 #pragma once
 #include <atomic>
+#include <filesystem>
 #include <thread>
+#include <memory>
+#include <mutex>
+#include <optional>
 
 #include "IReader.h"
+#include "HistoryArchive.h"
+#include "BlockPool.h"
+#include "FilterChain.h"
+#include "ReadEngine.h"
+#include "SpoolQueue.h"
+#include "OverrunPolicy.h"
+#include "TaskPool.h"
 
 /**
  * @class Reader
  * This class implements IReader interface that reads from files in it's own thread.
- * If file with data exists Reader read data and removes file. Then waits unit new file
- * with data is created and repeats process.
+ * Intervals are published by FileSink to spool directory (see SpoolQueue), Reader reads
+ * all published intervals in order as one batch, removes their files and waits until new
+ * ones are published. Sequence numbers which are missing (intervals dropped by FileSink on
+ * overrun) are recorded as gaps of history. Intervals of batch are parsed in parallel by
+ * TaskPool given to Set_task_pool().
  */
 class FileReader final : public IReader
 {
@@ -21,6 +35,12 @@ public:
      */
     [[nodiscard]] const RecordingHistory& Get_data() const override;
 
+    /**
+     * @brief Get_history_snapshot
+     * @return parameters and size of history, safe to call while Reader thread pushes
+     */
+    [[nodiscard]] HistorySnapshot Get_history_snapshot() const override;
+
     /**
      * @brief Get_state
      * @return state of the reader
@@ -35,7 +55,7 @@ public:
 
     /**
      * @brief Set_file
-     * @param fname name of file to open
+     * @param fname name of spool directory
      * @return true if file successfully open
      */
     [[nodiscard]] bool Set_file(const std::string_view & fname) override;
@@ -46,6 +66,82 @@ public:
      */
     void Set_history_time_limit(int limit_in_sec) override;
 
+    /**
+     * @brief Set_history_compression
+     * @param enabled if true, older intervals of history are stored compressed
+     */
+    void Set_history_compression(bool enabled) override;
+
+    /**
+     * @brief Freeze
+     * @note history returned by Get_data() stops changing, acquisition continues
+     * in background buffer
+     */
+    void Freeze() override;
+
+    /**
+     * @brief Unfreeze
+     * @note intervals acquired while frozen are spliced into history
+     */
+    void Unfreeze() override;
+
+    /**
+     * @brief Is_frozen
+     * @return true if history is frozen
+     */
+    [[nodiscard]] bool Is_frozen() const override;
+
+    /**
+     * @brief Set_block_queue
+     * @param queue queue to which every interval is added after it is pushed to history, can be nullptr
+     * @note has to be called before Start(), queue is filled also while history is frozen
+     */
+    void Set_block_queue(std::shared_ptr<BlockQueue> queue) override;
+
+    /**
+     * @brief Set_archive
+     * @param archive archive to which every read interval is appended, can be nullptr
+     * @note archive is cleared on Resume(), because time starts again from 0
+     */
+    void Set_archive(std::shared_ptr<HistoryArchive> archive);
+
+    /**
+     * @brief Set_filter
+     * @param filter chain run on every read interval before it is pushed, can be nullptr
+     * @note has to be called before Start(), raw intervals are still stored in Get_data()
+     */
+    void Set_filter(std::unique_ptr<FilterChain> filter);
+
+    /**
+     * @brief Set_task_pool
+     * @param pool pool which parses intervals of batch in parallel, can be nullptr
+     * @note has to be called before Start(), without pool Reader thread parses all intervals
+     */
+    void Set_task_pool(std::shared_ptr<TaskPool> pool);
+
+    /**
+     * @brief Get_filtered_data
+     * @return RecordingHistory with intervals filtered by chain given to Set_filter()
+     */
+    [[nodiscard]] const RecordingHistory& Get_filtered_data() const;
+
+    /**
+     * @brief Get_filtered_points
+     * @return number of points output by filter chain since start, safe to call while Reader thread pushes
+     */
+    [[nodiscard]] std::uint64_t Get_filtered_points() const;
+
+    /**
+     * @brief Parse_interval
+     * @param in stream with lines of "time voltage", it is read to its end and decoded by TextCodec
+     * @param start_time time added to every timestamp read
+     * @param resource memory resource from which timestamps are allocated
+     * @param expected_points number of timestamps reserved before reading
+     * @return interval with read timestamps and its parameters
+     */
+    [[nodiscard]] static RecordingVector Parse_interval(std::istream & in, double start_time,
+        std::pmr::memory_resource * resource = std::pmr::get_default_resource(), int expected_points = 0);
+
     /**
      * @brief Start
      * @note starts execution of Reader thread
@@ -73,12 +169,41 @@ public:
     ~FileReader();
 private:
     double _start_time;
-    std::ifstream _file;
     std::string _fname;
+    //content of files of current batch, buffers are reused between batches
+    std::vector<std::string> _texts;
+    //sequence numbers of files of current batch, empty if name has none
+    std::vector<std::optional<std::uint64_t>> _sequences;
+    //published intervals of current batch
+    std::vector<std::filesystem::path> _pending;
+    //intervals of current batch read but not pushed yet
+    std::vector<RecordingVector> _batch;
+    std::vector<RecordingVector> _filtered_batch;
+    //blocks of current batch, given to archive and queue after they are pushed to history
+    std::vector<BlockHandle> _blocks;
+    //created by Reader thread, io_uring when kernel supports it
+    std::unique_ptr<ReadEngine> _engine;
+    //declared before _data, so it outlives intervals allocated from it, shared with blocks given to queue
+    std::shared_ptr<BlockPool> _pool {std::make_shared<BlockPool>()};
     RecordingHistory _data;
+    RecordingHistory _filtered_data;
+    std::unique_ptr<FilterChain> _filter;
+    std::atomic<std::uint64_t> _filtered_points {0};
+    //guards histories, time base, gap detector and filter against Stop(), Freeze(), Unfreeze()
+    //and snapshots taken by other thread
+    mutable std::mutex _data_mutex;
+    int _expected_points {0};
+    //time span of last interval, lost intervals are assumed to be as long
+    double _interval_span {0.0};
+    GapDetector _gap_detector;
+    std::shared_ptr<HistoryArchive> _archive;
+    std::shared_ptr<BlockQueue> _block_queue;
+    std::shared_ptr<TaskPool> _task_pool;
     std::thread _thread;
-    ReaderState _state;
-    bool _new_data_loaded;
+    //written by Reader thread and by Stop(), Resume() from other thread
+    std::atomic<ReaderState> _state;
+    //set by Reader thread and Unfreeze(), cleared by consumer
+    std::atomic_bool _new_data_loaded;
 
     //states
     std::atomic_bool _destroyed;
@@ -86,6 +211,22 @@ private:
     std::atomic_bool _stop_flag;
     std::atomic_bool _running;
 
+    /**
+     * @brief record_gap
+     * @param sequence sequence number of read interval
+     * @note if intervals before it were lost, their time is recorded as gap and skipped,
+     * _data_mutex has to be locked
+     */
+    void record_gap(std::uint64_t sequence);
+
+    /**
+     * @brief read_batch
+     * @return number of intervals pushed, intervals of _pending are read in order
+     * @note all intervals of batch are pushed under one lock of histories, batch read while
+     * Stop() was called is dropped
+     */
+    std::size_t read_batch();
+
     /**
      * @brief running_loop
      * @note loop in which Reader reads data
@@ -0,0 +1,232 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "RecordingContainers.h"
+
+/**
+ * @class IFilterStage
+ * This class provides interface for stages of FilterChain. Stage keeps its state between
+ * calls of Process(), so block boundaries do not change the result.
+ */
+class IFilterStage
+{
+public:
+    /**
+     * @brief Process
+     * @param in input timestamps in time order
+     * @param out output timestamps are appended to it, decimating stage outputs fewer points
+     */
+    virtual void Process(std::span<const Timestamp> in, std::vector<Timestamp> & out) = 0;
+
+    /**
+     * @brief Reset
+     * @note clears state, next block is processed as start of new signal
+     */
+    virtual void Reset() = 0;
+
+    virtual ~IFilterStage() = default;
+};
+
+/**
+ * @class FirFilter
+ * This class implements FIR filter with optional decimation. Output has time of the newest
+ * input sample used for it, so it is delayed by (taps - 1) / 2 samples of group delay.
+ * Kernel loops over taps in outer loop and over outputs in inner loop, so iterations of inner
+ * loop are independent and optimised builds can vectorise it without reordering of additions.
+ */
+class FirFilter final : public IFilterStage
+{
+public:
+    /**
+     * @brief FirFilter constructor
+     * @param taps coefficients of filter, at least one
+     * @param decimation every n-th output is kept
+     */
+    explicit FirFilter(std::vector<double> taps, int decimation = 1);
+
+    /**
+     * @brief Low_pass
+     * @param cutoff cutoff frequency in Hz
+     * @param sample_rate sample rate of input in Hz
+     * @param taps number of taps, odd number gives symmetric filter
+     * @return Hamming windowed sinc coefficients with unity gain at DC
+     */
+    [[nodiscard]] static std::vector<double> Low_pass(double cutoff, double sample_rate, int taps);
+
+    /**
+     * @brief Band_pass
+     * @param low lower cutoff frequency in Hz
+     * @param high upper cutoff frequency in Hz
+     * @param sample_rate sample rate of input in Hz
+     * @param taps number of taps, odd number gives symmetric filter
+     * @return difference of two low pass filters
+     */
+    [[nodiscard]] static std::vector<double> Band_pass(double low, double high, double sample_rate, int taps);
+
+    void Process(std::span<const Timestamp> in, std::vector<Timestamp> & out) override;
+    void Reset() override;
+private:
+    //reversed taps, so output is dot product with window in memory order
+    std::vector<double> _reversed_taps;
+    int _decimation;
+    //index of first input of next block which produces output
+    std::size_t _phase {0};
+    //last (taps - 1) voltages of previous block followed by voltages of current block
+    std::vector<double> _window;
+    std::vector<double> _sums;
+};
+
+/**
+ * @enum BiquadType
+ * @note defines response of BiquadFilter
+ */
+enum class BiquadType
+{
+    LOW_PASS,
+    HIGH_PASS,
+    BAND_PASS
+};
+
+/**
+ * @class BiquadFilter
+ * This class implements second order IIR filter (RBJ cookbook coefficients) in transposed
+ * direct form II. It is recursive, so it is cheap but can't be vectorised over samples.
+ */
+class BiquadFilter final : public IFilterStage
+{
+public:
+    /**
+     * @brief BiquadFilter constructor
+     * @param type response of filter
+     * @param frequency cutoff (or center for band pass) frequency in Hz
+     * @param sample_rate sample rate of input in Hz
+     * @param q quality factor, 0.707 gives flat low pass
+     */
+    BiquadFilter(BiquadType type, double frequency, double sample_rate, double q = 0.7071067811865476);
+
+    void Process(std::span<const Timestamp> in, std::vector<Timestamp> & out) override;
+    void Reset() override;
+private:
+    double _b0, _b1, _b2, _a1, _a2;
+    double _z1 {0.0};
+    double _z2 {0.0};
+};
+
+/**
+ * @class MovingAverage
+ * This class averages last n samples with running sum, cost does not depend on n.
+ */
+class MovingAverage final : public IFilterStage
+{
+public:
+    /**
+     * @brief MovingAverage constructor
+     * @param length number of averaged samples, at least one
+     */
+    explicit MovingAverage(int length);
+
+    void Process(std::span<const Timestamp> in, std::vector<Timestamp> & out) override;
+    void Reset() override;
+private:
+    std::vector<double> _ring;
+    std::size_t _next {0};
+    std::size_t _filled {0};
+    double _sum {0.0};
+};
+
+/**
+ * @class CicDecimator
+ * This class implements CIC decimator (cascaded integrators and combs, differential delay 1).
+ * Voltages are converted to fixed point, so integrators wrap around without loss of precision.
+ * Output is exact while its signal, fraction and gain bits fit below sign bit, so decimation
+ * is limited by Max_decimation() and voltages are saturated to +-Max_voltage.
+ */
+class CicDecimator final : public IFilterStage
+{
+public:
+    /**
+     * @brief CicDecimator constructor
+     * @param decimation every n-th sample is output, 1 - Max_decimation(stages)
+     * @param stages number of integrator and comb stages, 1 - 6
+     */
+    explicit CicDecimator(int decimation, int stages = 3);
+
+    /**
+     * @brief Max_decimation
+     * @param stages number of integrator and comb stages
+     * @return largest decimation for which integrators do not overflow
+     */
+    [[nodiscard]] static int Max_decimation(int stages = 3);
+
+    //largest magnitude of voltage, larger voltages are saturated
+    static constexpr double Max_voltage = 256.0;
+
+    void Process(std::span<const Timestamp> in, std::vector<Timestamp> & out) override;
+    void Reset() override;
+private:
+    int _decimation;
+    int _stages;
+    //inverse of gain (decimation ^ stages) and of fixed point scale
+    double _output_scale;
+    int _phase {0};
+    //unsigned, so wrap around of integrators is defined
+    std::vector<std::uint64_t> _integrators;
+    std::vector<std::uint64_t> _combs;
+};
+
+/**
+ * @class FilterChain
+ * This class runs stages one after another on intervals read by Reader. Stages keep state
+ * between intervals, so chain behaves as one filter applied to whole stream.
+ */
+class FilterChain final
+{
+public:
+    /**
+     * @brief Add_stage
+     * @param stage stage appended to end of chain
+     */
+    void Add_stage(std::unique_ptr<IFilterStage> stage);
+
+    /**
+     * @brief Process
+     * @param in interval to filter
+     * @param resource memory resource from which filtered timestamps are allocated
+     * @return filtered interval with its parameters
+     */
+    [[nodiscard]] RecordingVector Process(const RecordingVector & in,
+        std::pmr::memory_resource * resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Reset
+     * @note clears state of all stages
+     */
+    void Reset();
+
+    /**
+     * @brief Empty
+     * @return true if chain has no stages
+     */
+    [[nodiscard]] bool Empty() const;
+
+    /**
+     * @brief Parse
+     * @param spec comma separated stages, e.g. "lowpass:50,cic:4" for given sample rate:
+     * lowpass:HZ, highpass:HZ, bandpass:LOW:HIGH (biquad), fir:HZ:TAPS, firband:LOW:HIGH:TAPS,
+     * average:N, decimate:N (FIR low pass + decimation), cic:N
+     * @param sample_rate sample rate of input in Hz
+     * @return chain with parsed stages
+     * @throw std::runtime_error if spec is not valid
+     */
+    [[nodiscard]] static std::unique_ptr<FilterChain> Parse(std::string_view spec, double sample_rate);
+private:
+    std::vector<std::unique_ptr<IFilterStage>> _stages;
+    //outputs of stages, reused between intervals
+    std::vector<Timestamp> _front;
+    std::vector<Timestamp> _back;
+};
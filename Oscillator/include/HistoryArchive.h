@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "BlockCache.h"
+#include "RecordingContainers.h"
+
+/**
+ * @struct ArchiveInterval
+ * This struct stores info about one interval saved in archive file: where it starts
+ * in file, its parameters and decimation summary (min & max voltage of equal time buckets).
+ */
+struct ArchiveInterval
+{
+    std::uint64_t _offset;
+    RangeParams _params;
+    //min & max voltage of each bucket
+    std::vector<std::pair<double, double>> _summary;
+};
+
+/**
+ * @class HistoryArchive
+ * This class implements disk backed storage of intervals pushed since last Clear().
+ * Only index with decimation summaries stays in memory. Intervals needed for drawing
+ * are read from disk on demand and kept in LRU cache, so long history can be browsed
+ * with bounded memory usage. File is used as ring of at most size limit bytes, newest
+ * interval overwrites oldest ones, so disk usage is bounded too.
+ */
+class HistoryArchive
+{
+public:
+    /**
+     * @brief HistoryArchive constructor
+     * @param fname name of archive file, it's truncated on creation
+     * @param cached_intervals how many decoded intervals are kept in memory
+     * @param size_limit max bytes of archived intervals, 0 means no limit
+     * @throws runtime_error if archive file can't be created
+     */
+    explicit HistoryArchive(const std::string_view & fname = "history.bin", int cached_intervals = 8,
+        std::uint64_t size_limit = default_size_limit);
+
+    //1 GiB, about 67 million timestamps
+    static constexpr std::uint64_t default_size_limit = 1ULL << 30;
+
+    HistoryArchive(const HistoryArchive&) = delete;
+    HistoryArchive& operator=(const HistoryArchive&) = delete;
+
+    /**
+     * @brief Append
+     * @param vec interval to save at the end of archive
+     * @return true if interval was written to file
+     * @note intervals have to be appended in time order, oldest intervals are evicted
+     * when size limit is reached
+     */
+    bool Append(const RecordingVector & vec);
+
+    /**
+     * @brief Load_range
+     * @param min_time begin of requested time range
+     * @param max_time end of requested time range
+     * @param max_points max number of timestamps returned
+     * @return timestamps from range in time order. If range holds more than max_points
+     * timestamps, min & max voltage pairs of equal time buckets are returned instead.
+     * @note file is read without lock of index, so Append() doesn't wait for disk reads
+     */
+    [[nodiscard]] std::vector<Timestamp> Load_range(double min_time, double max_time, int max_points) const;
+
+    /**
+     * @brief Get_recording_params
+     * @return parameters of whole archived history, evicted intervals excluded
+     */
+    [[nodiscard]] RangeParams Get_recording_params() const;
+
+    /**
+     * @brief Get_interval_count
+     * @return number of archived intervals
+     */
+    [[nodiscard]] int Get_interval_count() const;
+
+    /**
+     * @brief Empty
+     * @return true if nothing was archived
+     */
+    [[nodiscard]] bool Empty() const;
+
+    /**
+     * @brief Clear
+     * @note removes all intervals from archive and truncates file
+     */
+    void Clear();
+
+    ~HistoryArchive();
+private:
+    /**
+     * @struct LoadedInterval
+     * Interval found in index under lock, read from file after lock is released
+     */
+    struct LoadedInterval
+    {
+        std::uint64_t _id;
+        std::uint64_t _offset;
+        RangeParams _params;
+        std::shared_ptr<const RecordingVector> _vec;
+    };
+
+    std::string _fname;
+    std::fstream _file;
+    //separate handle, so reading doesn't move position of writing
+    mutable std::ifstream _reader;
+    std::deque<ArchiveInterval> _index;
+    //id of _index.front(), ids of intervals are never reused, also after Clear()
+    std::uint64_t _first_id {0};
+    RangeParams _params;
+    std::uint64_t _write_offset {0};
+    std::uint64_t _size_limit;
+    std::vector<double> _io_buffer;
+    mutable BlockCache<std::uint64_t, std::shared_ptr<const RecordingVector>> _cache;
+    //guards index, cache and writing
+    mutable std::mutex _mutex;
+    mutable std::mutex _read_mutex;
+
+    /**
+     * @brief find_interval
+     * @param i index of interval in _index
+     * @return interval with decoded data if it is cached
+     * @note _mutex has to be locked
+     */
+    LoadedInterval find_interval(std::size_t i) const;
+
+    /**
+     * @brief load_intervals
+     * @param intervals intervals found by find_interval(), those not cached are read from file
+     * @note _mutex must not be locked, intervals evicted while they were read are removed
+     */
+    void load_intervals(std::vector<LoadedInterval> & intervals) const;
+
+    /**
+     * @brief evict
+     * @param bytes size of interval which is written at _write_offset
+     * @note _mutex has to be locked, removes intervals overwritten by new one
+     */
+    void evict(std::uint64_t bytes);
+
+    /**
+     * @brief build_summary
+     * @param vec interval to summarize
+     * @return min & max voltage of equal time buckets of interval
+     */
+    static std::vector<std::pair<double, double>> build_summary(const RecordingVector & vec);
+};
@@ -1,8 +1,11 @@
 #pragma once
 #include <iostream>
+#include <memory>
+#include <span>
 #include <SFML/Window.hpp>
 #include <SFML/Graphics.hpp>
 #include "IReader.h"
+#include "HistoryArchive.h"
 
 /**
 * @class IChart
@@ -26,7 +29,7 @@ virtual void Set_data(std::vector<Timestamp> data) = 0;
  * @brief adds data to the current data, and erases data which exceed max possible points.
  * @param new_timestamps data that will be added to the current data.
  */
-virtual void Add_data(const std::vector<Timestamp>& new_timestamps) = 0;
+virtual void Add_data(std::span<const Timestamp> new_timestamps) = 0;
 /**
  * @brief Checks if given cursor position is within the bonds of chart's drawing space.
  * @param target is an object for drawing. Probably window. 
@@ -36,6 +39,11 @@ virtual bool Is_cursor_on_chart(sf::RenderTarget& target) const = 0;
  * @brief clears current data and sets min_X to 0 and max_X based on current time span.
  */
 virtual void Reset_data() = 0;
+/**
+ * @brief sets archive from which visible data is loaded while chart is panned.
+ * @param archive is the archive with whole recorded history, can be nullptr.
+ */
+virtual void Set_archive(std::shared_ptr<const HistoryArchive> archive) = 0;
 [[nodiscard]] virtual sf::Vector2i Get_cursor() const = 0;
 [[nodiscard]] virtual float Get_width() const = 0;
 [[nodiscard]] virtual float Get_height() const = 0;
@@ -1,10 +1,12 @@
 #pragma once
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 #include <stdexcept>
 
 #include "RecordingContainers.h"
+#include "BlockQueue.h"
 
 /**
  * @enum ReaderState
@@ -20,6 +22,16 @@ enum class ReaderState
 };
 
 
+/**
+ * @struct HistorySnapshot
+ * This struct stores state of history read at once under lock of Reader
+ */
+struct HistorySnapshot
+{
+    RangeParams _params;        //parameters of whole history
+    std::size_t _intervals;     //number of intervals in history
+};
+
 /**
  * @class IReader
  * This class provides common interface for all implementations
@@ -34,6 +46,12 @@ public:
      * @return RecordingHistory with all timestamps collected
      */
     [[nodiscard]] virtual  const RecordingHistory& Get_data() const = 0;
+
+    /**
+     * @brief Get_history_snapshot
+     * @return parameters and size of history, safe to call while Reader thread pushes
+     */
+    [[nodiscard]] virtual HistorySnapshot Get_history_snapshot() const = 0;
     
     /**
      * @brief Get_state
@@ -60,6 +78,38 @@ public:
      */
     virtual void Set_history_time_limit(int limit_in_sec) = 0;
 
+    /**
+     * @brief Set_history_compression
+     * @param enabled if true, older intervals of history are stored compressed
+     */
+    virtual void Set_history_compression(bool enabled) = 0;
+
+    /**
+     * @brief Freeze
+     * @note history returned by Get_data() stops changing, acquisition continues
+     * in background buffer
+     */
+    virtual void Freeze() = 0;
+
+    /**
+     * @brief Unfreeze
+     * @note intervals acquired while frozen are spliced into history
+     */
+    virtual void Unfreeze() = 0;
+
+    /**
+     * @brief Is_frozen
+     * @return true if history is frozen
+     */
+    [[nodiscard]] virtual bool Is_frozen() const = 0;
+
+    /**
+     * @brief Set_block_queue
+     * @param queue queue to which every interval is added after it is pushed to history, can be nullptr
+     * @note has to be called before Start(), queue is filled also while history is frozen
+     */
+    virtual void Set_block_queue(std::shared_ptr<BlockQueue> queue) = 0;
+
     /**
      * @brief Start
      * @note starts execution of Reader thread
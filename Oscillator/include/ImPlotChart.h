@@ -0,0 +1,208 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "IChart.h"
+#include "BlockPool.h"
+#include "MathChannel.h"
+#include "SummaryPyramid.h"
+
+/**
+ * @class ImPlotChart
+ * @brief Implementation of class IChart. It draws a line chart with ImPlot.
+ * Added data is kept as intervals of RecordingHistory and ImPlot reads them in place
+ * through getter (raw points) or stride (decimated points) API, nothing is copied per frame.
+ * Zoomed out view is drawn from SummaryPyramid when it is given, instead of decimating points.
+ * Optional math trace is computed from this channel (A) and channel B only for visible range.
+ * @note Draw() has to be called between ImGui::SFML::Update and ImGui::SFML::Render
+ */
+class ImPlotChart final: public IChart
+{
+public:
+/**
+ * @brief constructor with parameters
+ * @param data is data that will be passed as charts default data
+ * @param width is the width of the drawing area
+ * @param height is the height of the drawing area
+ * @param origin is the position of left bottom corner of a chart.
+ * @param min_Y is min value of Y axis.
+ * @param max_Y is max value of Y axis.
+ * @param history_seconds how many seconds of added data are kept.
+ */
+ImPlotChart(std::span<const Timestamp> data, float width, float height, sf::Vector2f origin = sf::Vector2f(0., 0.), float min_Y = -2.5, float max_Y = 2.5, int history_seconds = 60);
+/**
+ * @brief Adds data as new interval, the oldest interval is removed when history is full.
+ * @param new_timestamps new data that will be added to current data.
+ */
+void Add_data(std::span<const Timestamp> new_timestamps) override;
+/**
+ * @brief Adds data of channel B as new interval, it is used only by math trace.
+ * @param new_timestamps new data of channel B.
+ */
+void Add_channel_b_data(std::span<const Timestamp> new_timestamps);
+/**
+ * @brief shows math trace on secondary Y axis, it replaces previous math trace.
+ * @param operation expression over channel A (added data) and channel B.
+ */
+void Show_math(MathOperation operation);
+/**
+ * @brief hides math trace, its cached results are released.
+ */
+void Hide_math();
+/**
+ * @brief draws a line chart based on data given to the class.
+ * @param target is an object for drawing. Probably window.
+ */
+void Draw(sf::RenderTarget& target) override;
+/**
+ * @brief sets data for chart to use.
+ * @param data is the data that will be set.
+ */
+void Set_data(std::vector<Timestamp> data) override;
+/**
+ * @brief Checks if given cursor position is within the bonds of chart's drawing space.
+ * @param target is an object for drawing. Probably window.
+ */
+bool Is_cursor_on_chart(sf::RenderTarget& target) const override;
+/**
+ * @brief clears current data.
+ */
+void Reset_data() override;
+/**
+ * @brief sets archive from which visible data is loaded while chart is panned.
+ * @param archive is the archive with whole recorded history, can be nullptr.
+ */
+void Set_archive(std::shared_ptr<const HistoryArchive> archive) override;
+/**
+ * @brief sets summaries from which zoomed out view is drawn.
+ * @param summary is the pyramid of the same data as added to chart, can be nullptr.
+ */
+void Set_summary(std::shared_ptr<const SummaryPyramid> summary);
+[[nodiscard]] sf::Vector2i Get_cursor() const override;
+[[nodiscard]] float Get_width() const override;
+[[nodiscard]] float Get_height() const override;
+[[nodiscard]] float Get_zoom() const override;
+[[nodiscard]] float Get_scrolling() const override;
+[[nodiscard]] float Get_panning() const override;
+[[nodiscard]] float Get_time_span() const override;
+void Set_cursor(sf::Vector2i postion) override;
+void Set_width(float new_width) override;
+void Set_height(float new_height) override;
+/**
+ * @brief sets zoom, visible time span is base time span divided by zoom.
+ * @param new_zoom zoom from 1.0 to 16.0
+ */
+void Set_zoom(float new_zoom) override;
+void Set_origin(sf::Vector2f new_origin) override;
+void Set_scrolling(bool should_scroll) override;
+void Set_panning(bool should_pan) override;
+/**
+ * @brief Sets color of the chart.
+ * @param new_color a color to which chart will be set.
+ */
+void Set_color(sf::Color new_color) override;
+/**
+ * @brief Moves visible time range by pan_value, within recorded (or archived) data.
+ * @param pan_value value that will change visible time range.
+ */
+void Set_pan(float pan_value) override;
+
+/**
+ * @struct Series
+ * Visible part of history: spans of intervals and index of first visible point.
+ */
+struct Series
+{
+    std::vector<std::span<const Timestamp>> _spans;
+    /**
+     * Global index of first point of each span.
+     */
+    std::vector<std::size_t> _offsets;
+    std::size_t _first = 0;
+    /**
+     * Span of last read point, points are read in order so search is rarely needed.
+     */
+    std::size_t _last_span = 0;
+
+    /**
+     * @brief At
+     * @param index global index of point
+     * @return point with given index
+     */
+    [[nodiscard]] const Timestamp& At(std::size_t index);
+};
+private:
+/**
+ * @brief Push_interval
+ * @param history history to which interval is pushed
+ * @param new_timestamps data of interval
+ */
+void Push_interval(RecordingHistory & history, std::span<const Timestamp> new_timestamps);
+/**
+ * @brief plots visible part of math trace, decimated if there are more than two points per pixel.
+ */
+void Plot_math();
+/**
+ * @brief moves view to the newest data when scrolling, keeps it when panning.
+ */
+void Update_view();
+/**
+ * @brief collects intervals overlapping view into m_series.
+ * @return number of visible points
+ */
+std::size_t Collect_visible();
+/**
+ * @brief fills m_decimated with min & max voltage of each pixel column of visible points.
+ * @param count number of visible points
+ * @param buckets number of pixel columns
+ */
+void Decimate(std::size_t count, int buckets);
+/**
+ * @brief replaces m_archive_data with archived data around current view, when view left loaded range.
+ */
+void Load_visible_archive();
+/**
+ * @brief plots visible points, decimated if there are more than two per pixel.
+ */
+void Plot_visible();
+
+std::string m_window_name;
+float m_data_min_Y;
+float m_data_max_Y;
+/**
+ * Span of time visible for zoom = 1.0
+ */
+float m_base_time_span;
+float m_time_span;
+float m_zoom;
+double m_view_min_time;
+double m_view_max_time;
+/**
+ * Buffers of intervals are recycled, m_pool has to outlive m_history.
+ */
+BlockPool m_pool;
+RecordingHistory m_history;
+Series m_series;
+std::vector<Timestamp> m_decimated;
+/**
+ * History of channel B, kept only for math trace.
+ */
+RecordingHistory m_history_b;
+/**
+ * Math trace, nullptr when hidden.
+ */
+std::unique_ptr<MathChannel> m_math;
+std::vector<Timestamp> m_math_data;
+std::vector<Timestamp> m_math_decimated;
+/**
+ * Archive with whole history, used while panning beyond m_history.
+ */
+std::shared_ptr<const HistoryArchive> m_archive;
+std::vector<Timestamp> m_archive_data;
+/**
+ * Summaries of added data, zoomed out view needs only few buckets of them.
+ */
+std::shared_ptr<const SummaryPyramid> m_summary;
+double m_loaded_min_time = 0.0;
+double m_loaded_max_time = 0.0;
+float m_loaded_time_span = 0.f;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+/**
+ * @class IntensityTexture
+ * @brief Converts intensities of DensityGrid to colors of palette and keeps them in texture.
+ * Palette goes from background through color of chart to white. Cost of update and draw
+ * depends only on size of grid.
+ */
+class IntensityTexture
+{
+public:
+IntensityTexture();
+/**
+ * @brief sets color of palette used for often hit bins.
+ * @param new_color color of chart.
+ */
+void Set_color(sf::Color new_color);
+/**
+ * @brief color of bins without hits.
+ */
+[[nodiscard]] sf::Color Get_background() const;
+/**
+ * @brief converts intensities to pixels and uploads them to texture.
+ * @param intensity row-major intensities from 0.0 to 1.0
+ * @param columns width of grid
+ * @param rows height of grid
+ * @param changed false if intensities did not change since last update
+ */
+void Update(const std::vector<float>& intensity, unsigned columns, unsigned rows, bool changed);
+/**
+ * @brief draws texture stretched to given rectangle.
+ * @param target is an object for drawing. Probably window.
+ * @param top_left position of top left corner.
+ * @param size size of drawn rectangle.
+ */
+void Draw(sf::RenderTarget& target, sf::Vector2f top_left, sf::Vector2f size) const;
+private:
+std::array<sf::Color, 256> m_palette;
+std::vector<std::uint8_t> m_pixels;
+sf::Texture m_texture;
+};
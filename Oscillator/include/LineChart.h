@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include "IChart.h"
 
 /**
@@ -17,12 +18,12 @@ public:
  * @param min_Y is min value of Y axis.
  * @param max_Y is max value of Y axis.
  */
-LineChart(std::vector<Timestamp> data, float width, float height, sf::Vector2f origin = sf::Vector2f(0., 0.), float min_Y = -2.5, float max_Y = 2.5);
+LineChart(std::span<const Timestamp> data, float width, float height, sf::Vector2f origin = sf::Vector2f(0., 0.), float min_Y = -2.5, float max_Y = 2.5);
 /**
  * @brief Adds data to the current m_data, and erases the data that is at the end
  * @param new_timestamps new data that will be added to current data.
  */
-void Add_data(const std::vector<Timestamp>& new_timestamps) override;
+void Add_data(std::span<const Timestamp> new_timestamps) override;
 
 /**
  * @brief draws a line chart based on data given to the class.
@@ -43,6 +44,11 @@ bool Is_cursor_on_chart(sf::RenderTarget& target) const override;
  * @brief clears current data and sets min_X to 0 and max_X based on current time span.
  */
 void Reset_data() override;
+/**
+ * @brief sets archive from which visible data is loaded while chart is panned.
+ * @param archive is the archive with whole recorded history, can be nullptr.
+ */
+void Set_archive(std::shared_ptr<const HistoryArchive> archive) override;
 [[nodiscard]] sf::Vector2i Get_cursor() const override;
 [[nodiscard]] float Get_width() const override;
 [[nodiscard]] float Get_height() const override;
@@ -68,11 +74,15 @@ void Set_color(sf::Color new_color) override;
  * @param pan_value value that will change m_view~ values.
  */
 void Set_pan(float pan_value) override;
-private:
 /**
  * @brief updates geometry based on the data that was provided
  */
 void Update_geometry();
+private:
+/**
+ * @brief replaces m_data with archived data around current view, when view left already loaded range.
+ */
+void Load_visible_archive();
 /**
  * @brief draws a line.
  * @param begin starting point of the line.
@@ -139,4 +149,23 @@ int m_end;
  * min zoom = 1/3, and max zoom = 16.0
  */
 float m_zoom;
+/**
+ * Moment of last Update_geometry(), scrolling moves view by time elapsed since then.
+ */
+std::chrono::steady_clock::time_point m_last_update;
+/**
+ * Archive with whole history, used while panning.
+ */
+std::shared_ptr<const HistoryArchive> m_archive;
+/**
+ * Live data put aside while m_data holds data loaded from archive, restored when panning ends.
+ */
+std::vector<Timestamp> m_live_data;
+bool m_showing_archive = false;
+/**
+ * Time range and time span for which m_data was loaded from archive.
+ */
+float m_loaded_min_time = 0.f;
+float m_loaded_max_time = 0.f;
+float m_loaded_time_span = 0.f;
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <span>
+#include <vector>
+
+#include "RecordingContainers.h"
+
+/**
+ * @enum MathOperation
+ * @note defines expression evaluated by MathChannel
+ */
+enum class MathOperation
+{
+    ADD,            //A + B
+    SUBTRACT,       //A - B
+    MULTIPLY,       //A * B
+    DERIVATIVE,     //dA/dt
+    INTEGRAL        //integral of A over time
+};
+
+/**
+ * @class MathChannel
+ * This class is virtual channel defined by expression over acquired channels. It does not copy
+ * histories of its sources, results are computed lazily per interval of channel A, only for
+ * intervals overlapping requested time range, and cached under sequence number of interval.
+ * Cached intervals which were evicted from history of channel A are dropped on next evaluation,
+ * so hidden channel costs nothing and cache never outgrows history.
+ * @note sources are read without locking, owner calls Evaluate() from thread which changes them
+ */
+class MathChannel final
+{
+public:
+    /**
+     * @brief MathChannel constructor
+     * @param operation evaluated expression
+     * @param a history of channel A, has to outlive math channel
+     * @param b history of channel B, needed by binary operations, has to outlive math channel
+     * @throw std::runtime_error if binary operation has no channel B
+     */
+    MathChannel(MathOperation operation, const RecordingHistory & a, const RecordingHistory * b = nullptr);
+
+    /**
+     * @brief Evaluate
+     * @param min_time begin of requested time range
+     * @param max_time end of requested time range
+     * @param out timestamps of result within requested range, in time order
+     * @note binary operations interpolate B at times of A, so result has samples of A covered by B
+     */
+    void Evaluate(double min_time, double max_time, std::vector<Timestamp> & out);
+
+    /**
+     * @brief Invalidate
+     * @note drops all cached results, e.g. after sources were replaced, integral starts from zero
+     */
+    void Invalidate();
+
+    /**
+     * @brief Get_operation
+     * @return evaluated expression
+     */
+    [[nodiscard]] MathOperation Get_operation() const;
+
+    /**
+     * @brief Get_cached_intervals
+     * @return number of intervals with cached result
+     */
+    [[nodiscard]] std::size_t Get_cached_intervals() const;
+
+    /**
+     * @brief Get_computed_intervals
+     * @return number of intervals computed since creation, cache hits are not counted
+     */
+    [[nodiscard]] std::uint64_t Get_computed_intervals() const;
+
+    /**
+     * @brief Is_binary
+     * @param operation expression
+     * @return true if expression needs channel B
+     */
+    [[nodiscard]] static bool Is_binary(MathOperation operation);
+
+    /**
+     * @brief Get_name
+     * @param operation expression
+     * @return short name of expression, e.g. "A-B"
+     */
+    [[nodiscard]] static const char* Get_name(MathOperation operation);
+private:
+    /**
+     * @struct Block
+     * Result computed from one interval of channel A
+     */
+    struct Block
+    {
+        std::vector<Timestamp> _data;
+        //value of integral at end of interval, start of next interval
+        double _end_value = 0.0;
+    };
+
+    MathOperation _operation;
+    const RecordingHistory & _a;
+    const RecordingHistory * _b;
+    //results under sequence numbers of intervals of channel A
+    std::map<std::uint64_t, Block> _cache;
+    //result of interval which can't be cached yet, B did not cover it whole
+    Block _partial;
+    //value of integral at end of evicted intervals
+    double _evicted_end_value {0.0};
+    std::uint64_t _computed {0};
+
+    //reused buffers, channel B has its own, so span of decompressed A stays valid while B is collected
+    RecordingVector::type _decompressed;
+    RecordingVector::type _decompressed_b;
+    std::vector<Timestamp> _b_samples;
+
+    /**
+     * @brief compute
+     * @param samples samples of interval of channel A
+     * @param previous last sample of previous interval, nullptr if there is none
+     * @param start_value value of integral at start of interval
+     * @param block result
+     * @return true if result is complete and can be cached
+     */
+    bool compute(std::span<const Timestamp> samples, const Timestamp * previous, double start_value, Block & block);
+
+    /**
+     * @brief collect_b
+     * @param min_time begin of needed range
+     * @param max_time end of needed range
+     * @note copies samples of B around range into _b_samples, one sample outside range on both sides
+     */
+    void collect_b(double min_time, double max_time);
+
+    /**
+     * @brief samples_of
+     * @param vec interval
+     * @param scratch buffer for decompressed interval
+     * @return samples of interval
+     */
+    static std::span<const Timestamp> samples_of(const RecordingVector & vec, RecordingVector::type & scratch);
+};
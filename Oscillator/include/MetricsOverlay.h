@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include "PipelineMetrics.h"
+
+/**
+ * @class MetricsOverlay
+ * @brief Draws ImGui window with live pipeline statistics: latency of every stage,
+ * counters, gauges, threads and plot of recent frame times.
+ */
+class MetricsOverlay
+{
+public:
+/**
+ * @brief constructor
+ * @param refresh_period how often statistics are taken from PipelineMetrics
+ */
+explicit MetricsOverlay(std::chrono::milliseconds refresh_period = std::chrono::milliseconds(250));
+/**
+ * @brief draws overlay window.
+ * @note has to be called between ImGui::SFML::Update and ImGui::SFML::Render
+ */
+void Draw();
+/**
+ * @brief shows or hides overlay.
+ * @param visible true to show overlay.
+ */
+void Set_visible(bool visible);
+/**
+ * @brief checks if overlay is shown.
+ */
+bool Is_visible() const;
+private:
+/**
+ * @brief draws table with latency of pipeline stages.
+ */
+void Draw_stages() const;
+/**
+ * @brief draws counters, their rates and gauges.
+ */
+void Draw_counters() const;
+/**
+ * @brief draws table with statistics of every thread.
+ */
+void Draw_threads() const;
+/**
+ * @brief draws plot of recent frame times.
+ */
+void Draw_frame_times() const;
+
+static constexpr int frame_history = 300;
+
+bool m_visible;
+std::chrono::milliseconds m_refresh_period;
+std::chrono::steady_clock::time_point m_last_refresh;
+std::chrono::steady_clock::time_point m_last_frame;
+MetricsSnapshot m_snapshot;
+std::array<double, pipeline_counters> m_rates;
+std::array<float, frame_history> m_frame_times;
+int m_frame_offset;
+};
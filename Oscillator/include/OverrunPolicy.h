@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "RecordingContainers.h"
+
+/**
+ * @enum OverrunPolicy
+ * @note defines what transport does when its consumer falls behind
+ */
+enum class OverrunPolicy
+{
+    BLOCK,          //producer waits for consumer
+    DROP_OLDEST,    //oldest interval not taken by consumer is dropped
+    DROP_NEWEST,    //new interval is dropped
+    DECIMATE        //intervals are decimated while consumer is behind, dropped when it is full
+};
+
+/**
+ * @brief Get_overrun_policy_name
+ * @param policy overrun policy
+ * @return name of policy, as accepted by Parse_overrun_policy()
+ */
+[[nodiscard]] const char* Get_overrun_policy_name(OverrunPolicy policy);
+
+/**
+ * @brief Parse_overrun_policy
+ * @param name "block", "drop-oldest", "drop-newest" or "decimate"
+ * @return policy, empty if name is unknown
+ */
+[[nodiscard]] std::optional<OverrunPolicy> Parse_overrun_policy(std::string_view name);
+
+/**
+ * @brief Get_decimation_factor
+ * @param load fill of transport, 0.0 empty, 1.0 full
+ * @return 1 while transport is less than half full, 2 up to three quarters, 4 above
+ */
+[[nodiscard]] int Get_decimation_factor(double load);
+
+/**
+ * @brief Decimate_values
+ * @param values samples of interval
+ * @param factor every factor-th sample is kept, last one is always kept
+ * @param out kept samples, it is cleared first
+ */
+void Decimate_values(std::span<const double> values, int factor, std::vector<double> & out);
+
+/**
+ * @brief Decimate_interval
+ * @param interval interval to decimate, compressed one is decompressed
+ * @param factor every factor-th timestamp is kept, last one is always kept
+ * @return decimated copy of interval with the same time range
+ */
+[[nodiscard]] RecordingVector Decimate_interval(const RecordingVector & interval, int factor);
+
+/**
+ * @class GapDetector
+ * This class follows sequence numbers of intervals received by reader and tells how many
+ * intervals were lost before received one, e.g. dropped by producer on overrun.
+ */
+class GapDetector
+{
+public:
+    /**
+     * @brief Check
+     * @param sequence sequence number of received interval
+     * @return number of intervals missing before it, 0 after Reset() or when producer restarted
+     */
+    std::uint64_t Check(std::uint64_t sequence);
+
+    /**
+     * @brief Reset
+     * @note next checked interval starts new sequence
+     */
+    void Reset();
+private:
+    std::uint64_t _next_sequence {0};
+    bool _started {false};
+};
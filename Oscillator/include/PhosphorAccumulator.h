@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "DensityGrid.h"
+#include "RecordingContainers.h"
+
+/**
+ * @struct PhosphorSettings
+ * This struct stores parameters of phosphor (persistence) accumulation
+ */
+struct PhosphorSettings
+{
+    int _columns = 512;             //time bins of one sweep
+    int _rows = 256;                //voltage bins
+    double _sweep_time = 0.2;       //seconds shown by one sweep
+    double _pretrigger = 0.1;       //part of sweep shown before trigger, 0.0 - 0.9
+    double _min_voltage = -2.5;
+    double _max_voltage = 2.5;
+    double _trigger_level = 0.0;
+    bool _rising_edge = true;
+    double _half_life = 0.5;        //seconds after which hits lose half of intensity
+};
+
+/**
+ * @class PhosphorAccumulator
+ * This class imitates digital phosphor of oscilloscope. Pushed timestamps are searched
+ * for trigger crossings in its own thread, every triggered sweep is binned into 2D hit-count
+ * histogram (time x voltage) and whole histogram decays with time. Cost of reading histogram
+ * depends only on its size, not on number of accumulated sweeps.
+ */
+class PhosphorAccumulator final
+{
+public:
+    explicit PhosphorAccumulator(const PhosphorSettings & settings = PhosphorSettings());
+
+    PhosphorAccumulator(const PhosphorAccumulator&) = delete;
+    PhosphorAccumulator& operator=(const PhosphorAccumulator&) = delete;
+
+    /**
+     * @brief Push
+     * @param timestamps new timestamps in time order, copied to input buffer, ignored when stopped
+     */
+    void Push(std::span<const Timestamp> timestamps);
+
+    /**
+     * @brief Set_settings
+     * @param settings new parameters, histogram is cleared if its geometry changed
+     */
+    void Set_settings(const PhosphorSettings & settings);
+
+    /**
+     * @brief Get_settings
+     * @return current parameters
+     */
+    [[nodiscard]] PhosphorSettings Get_settings() const;
+
+    /**
+     * @brief Copy_intensity
+     * @param out row-major intensities from 0.0 to 1.0 (log scaled hits), first row is max voltage
+     * @return true if histogram changed since last copy
+     */
+    bool Copy_intensity(std::vector<float> & out);
+
+    /**
+     * @brief Get_sweep_count
+     * @return number of sweeps accumulated since creation
+     */
+    [[nodiscard]] std::uint64_t Get_sweep_count() const;
+
+    /**
+     * @brief Clear
+     * @note clears histogram and not processed input
+     */
+    void Clear();
+
+    /**
+     * @brief Start
+     * @note starts execution of accumulator thread
+     */
+    void Start();
+
+    /**
+     * @brief Stop
+     * @note stops accumulation and decay, histogram is kept
+     */
+    void Stop();
+
+    /**
+     * @brief Resume
+     * @note resumes execution after Stop() was called
+     */
+    void Resume();
+
+    /**
+     * @brief Destroy
+     * @note destroys thread, after this new thread with Start() can be created
+     */
+    void Destroy();
+
+    ~PhosphorAccumulator();
+private:
+    using clock = std::chrono::steady_clock;
+
+    PhosphorSettings _settings;
+    //hit counts, guarded by _grid_mutex
+    DensityGrid _grid;
+    mutable std::mutex _grid_mutex;
+    clock::time_point _last_decay;
+
+    //input filled by Push(), swapped with _block by accumulator thread
+    std::vector<Timestamp> _input;
+    std::mutex _input_mutex;
+    std::condition_variable _input_cv;
+
+    //owned by accumulator thread
+    std::vector<Timestamp> _block;
+    std::vector<Timestamp> _work;       //not finished samples of previous blocks + new block
+    std::vector<std::int32_t> _bins;
+    std::size_t _scan_from {0};         //index in _work from which next trigger is searched
+    std::atomic_bool _reset_work {false};
+
+    std::atomic_uint64_t _sweeps {0};
+    std::thread _thread;
+
+    //states
+    std::atomic_bool _destroyed {true};
+    std::atomic_bool _destroy_flag {false};
+    std::atomic_bool _stop_flag {false};
+    std::atomic_bool _running {false};
+
+    /**
+     * @brief accumulate
+     * @param settings parameters copied at begin of pass
+     * @note finds triggers in _work and bins every complete sweep
+     */
+    void accumulate(const PhosphorSettings & settings);
+
+    /**
+     * @brief bin_sweep
+     * @param first index of first sample of sweep in _work
+     * @param last index after last sample of sweep in _work
+     * @param origin time of left edge of sweep
+     * @param settings parameters of accumulation
+     */
+    void bin_sweep(std::size_t first, std::size_t last, double origin, const PhosphorSettings & settings);
+
+    /**
+     * @brief decay
+     * @param now current time
+     * @note multiplies histogram by factor of time elapsed since last decay, needs _grid_mutex
+     */
+    void decay(clock::time_point now);
+
+    /**
+     * @brief running_loop
+     * @note loop in which input is accumulated
+     */
+    void running_loop(void);
+};
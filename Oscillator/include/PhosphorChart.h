@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include "IChart.h"
+#include "IntensityTexture.h"
+#include "PhosphorAccumulator.h"
+
+/**
+ * @class PhosphorChart
+ * @brief Implementation of class IChart. It draws persistence (phosphor) view: triggered sweeps
+ * are accumulated by PhosphorAccumulator in its own thread and chart only uploads histogram as
+ * a texture, so cost of a frame does not depend on number of sweeps or points.
+ * @note Zoom changes length of sweep, pan moves trigger point within the sweep.
+ */
+class PhosphorChart final: public IChart
+{
+public:
+/**
+ * @brief constructor with parameters
+ * @param data is data that will be passed as charts default data
+ * @param width is the width of the drawing area
+ * @param height is the height of the drawing area
+ * @param origin is the position of left bottom corner of a chart.
+ * @param min_Y is min value of Y axis.
+ * @param max_Y is max value of Y axis.
+ * @param settings parameters of accumulation, voltage range is taken from min_Y and max_Y.
+ */
+PhosphorChart(std::span<const Timestamp> data, float width, float height, sf::Vector2f origin = sf::Vector2f(0., 0.), float min_Y = -2.5, float max_Y = 2.5, const PhosphorSettings & settings = PhosphorSettings());
+/**
+ * @brief passes data to accumulator.
+ * @param new_timestamps new data that will be added to current data.
+ */
+void Add_data(std::span<const Timestamp> new_timestamps) override;
+/**
+ * @brief draws histogram of sweeps as a texture.
+ * @param target is an object for drawing. Probably window.
+ */
+void Draw(sf::RenderTarget& target) override;
+/**
+ * @brief clears accumulated sweeps and accumulates given data.
+ * @param data is the data that will be set.
+ */
+void Set_data(std::vector<Timestamp> data) override;
+/**
+ * @brief Checks if given cursor position is within the bonds of chart's drawing space.
+ * @param target is an object for drawing. Probably window.
+ */
+bool Is_cursor_on_chart(sf::RenderTarget& target) const override;
+/**
+ * @brief clears accumulated sweeps.
+ */
+void Reset_data() override;
+/**
+ * @brief phosphor view shows only live sweeps, archive is not used.
+ * @param archive is the archive with whole recorded history, can be nullptr.
+ */
+void Set_archive(std::shared_ptr<const HistoryArchive> archive) override;
+[[nodiscard]] sf::Vector2i Get_cursor() const override;
+[[nodiscard]] float Get_width() const override;
+[[nodiscard]] float Get_height() const override;
+[[nodiscard]] float Get_zoom() const override;
+[[nodiscard]] float Get_scrolling() const override;
+/**
+ * @brief trigger point can be moved while sweeps are accumulated.
+ */
+[[nodiscard]] float Get_panning() const override;
+[[nodiscard]] float Get_time_span() const override;
+/**
+ * @brief number of sweeps accumulated since creation.
+ */
+[[nodiscard]] std::uint64_t Get_sweep_count() const;
+void Set_cursor(sf::Vector2i postion) override;
+void Set_width(float new_width) override;
+void Set_height(float new_height) override;
+/**
+ * @brief sets zoom, length of sweep is base time span divided by zoom.
+ * @param new_zoom zoom from 1.0 to 16.0
+ */
+void Set_zoom(float new_zoom) override;
+void Set_origin(sf::Vector2f new_origin) override;
+/**
+ * @brief stops accumulation (histogram stays as it is) or resumes it.
+ * @param should_scroll false freezes histogram.
+ */
+void Set_scrolling(bool should_scroll) override;
+void Set_panning(bool should_pan) override;
+/**
+ * @brief Sets color of the most hit bins, palette goes from background through it to white.
+ * @param new_color a color to which chart will be set.
+ */
+void Set_color(sf::Color new_color) override;
+/**
+ * @brief Moves trigger point within the sweep, histogram is cleared.
+ * @param pan_value time by which trigger point is moved.
+ * @note ignored while accumulation is stopped, so frozen histogram is kept.
+ */
+void Set_pan(float pan_value) override;
+private:
+PhosphorAccumulator m_accumulator;
+float m_data_min_Y;
+float m_data_max_Y;
+/**
+ * Length of sweep for zoom = 1.0
+ */
+float m_base_time_span;
+float m_time_span;
+float m_zoom;
+std::vector<float> m_intensity;
+IntensityTexture m_texture;
+};
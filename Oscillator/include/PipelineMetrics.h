@@ -0,0 +1,243 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Tracer.h"
+
+/**
+ * @enum PipelineStage
+ * @note defines stages of pipeline which duration is measured
+ */
+enum class PipelineStage
+{
+    GENERATE,   //Generator computes interval values
+    WRITE,      //Generator writes interval to file
+    DETECT,     //from file being written to Reader noticing it
+    PARSE,      //Reader parses interval
+    FILTER,     //Reader filters interval
+    PUSH,       //Reader pushes interval to history
+    SUMMARIZE,  //render summary of interval is built
+    INDEX,      //capture file is indexed in background
+    RENDER,     //chart draws frame
+    FRAME,      //whole frame of main loop
+    COUNT
+};
+
+/**
+ * @enum PipelineCounter
+ * @note defines events counted in pipeline
+ */
+enum class PipelineCounter
+{
+    POINTS_GENERATED,
+    POINTS_PARSED,
+    INTERVALS_PUSHED,
+    BLOCKS_DROPPED,
+    INTERVALS_OVERRUN,
+    INTERVALS_DECIMATED,
+    FRAMES,
+    COUNT
+};
+
+/**
+ * @enum PipelineGauge
+ * @note defines values which last state is kept
+ */
+enum class PipelineGauge
+{
+    VERTEX_COUNT,
+    VISIBLE_POINTS,
+    QUEUE_DEPTH,
+    SUMMARY_PENDING,
+    COUNT
+};
+
+constexpr std::size_t pipeline_stages = static_cast<std::size_t>(PipelineStage::COUNT);
+constexpr std::size_t pipeline_counters = static_cast<std::size_t>(PipelineCounter::COUNT);
+constexpr std::size_t pipeline_gauges = static_cast<std::size_t>(PipelineGauge::COUNT);
+
+/**
+ * @brief Get_stage_name
+ * @param stage stage of pipeline
+ * @return readable name of stage
+ */
+[[nodiscard]] const char* Get_stage_name(PipelineStage stage);
+
+/**
+ * @brief Get_counter_name
+ * @param counter counter of pipeline
+ * @return readable name of counter
+ */
+[[nodiscard]] const char* Get_counter_name(PipelineCounter counter);
+
+/**
+ * @struct StageSnapshot
+ * This struct stores latency statistics of one stage: count, sum, max and
+ * histogram with power of two buckets of nanoseconds.
+ */
+struct StageSnapshot
+{
+    static constexpr int buckets = 40;
+
+    std::uint64_t _count = 0;
+    std::uint64_t _total_ns = 0;
+    std::uint64_t _max_ns = 0;
+    std::array<std::uint64_t, buckets> _histogram {};
+
+    /**
+     * @brief Get_mean_ns
+     * @return mean duration in nanoseconds
+     */
+    [[nodiscard]] double Get_mean_ns() const;
+
+    /**
+     * @brief Get_percentile_ns
+     * @param percentile value from 0.0 to 1.0
+     * @return upper bound of histogram bucket with requested percentile
+     */
+    [[nodiscard]] std::uint64_t Get_percentile_ns(double percentile) const;
+};
+
+/**
+ * @struct ThreadSnapshot
+ * This struct stores statistics of one thread
+ */
+struct ThreadSnapshot
+{
+    std::string _name;
+    std::array<std::uint64_t, pipeline_stages> _stage_counts {};
+    std::array<std::uint64_t, pipeline_counters> _counters {};
+};
+
+/**
+ * @struct MetricsSnapshot
+ * This struct stores statistics of all threads merged and of each thread separately
+ */
+struct MetricsSnapshot
+{
+    std::array<StageSnapshot, pipeline_stages> _stages {};
+    std::array<std::uint64_t, pipeline_counters> _counters {};
+    std::array<std::int64_t, pipeline_gauges> _gauges {};
+    std::vector<ThreadSnapshot> _threads;
+};
+
+/**
+ * @class PipelineMetrics
+ * This class collects pipeline statistics. Every thread writes only to its own
+ * counters and histograms (registered on first use), so recording is a few relaxed
+ * atomic stores without contention. Get_snapshot() merges data of all threads.
+ */
+class PipelineMetrics
+{
+public:
+    /**
+     * @brief Instance
+     * @return metrics shared by whole application
+     */
+    static PipelineMetrics& Instance();
+
+    PipelineMetrics(const PipelineMetrics&) = delete;
+    PipelineMetrics& operator=(const PipelineMetrics&) = delete;
+
+    /**
+     * @brief Set_thread_name
+     * @param name name of calling thread shown in snapshot and in trace
+     */
+    void Set_thread_name(const std::string_view & name);
+
+    /**
+     * @brief Record
+     * @param stage measured stage
+     * @param duration duration of stage
+     */
+    void Record(PipelineStage stage, std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Add
+     * @param counter counter to increase
+     * @param value value added to counter
+     */
+    void Add(PipelineCounter counter, std::uint64_t value = 1);
+
+    /**
+     * @brief Set_gauge
+     * @param gauge gauge to set
+     * @param value new value of gauge
+     */
+    void Set_gauge(PipelineGauge gauge, std::int64_t value);
+
+    /**
+     * @brief Get_snapshot
+     * @return statistics merged from all threads
+     */
+    [[nodiscard]] MetricsSnapshot Get_snapshot() const;
+
+    /**
+     * @brief Reset
+     * @note zeroes all statistics, names of threads are kept
+     */
+    void Reset();
+private:
+    /**
+     * @struct ThreadMetrics
+     * Statistics written by one thread only.
+     */
+    struct ThreadMetrics
+    {
+        std::string _name;
+        std::array<std::array<std::atomic_uint64_t, StageSnapshot::buckets>, pipeline_stages> _histograms {};
+        std::array<std::atomic_uint64_t, pipeline_stages> _totals {};
+        std::array<std::atomic_uint64_t, pipeline_stages> _max {};
+        std::array<std::atomic_uint64_t, pipeline_counters> _counters {};
+    };
+
+    PipelineMetrics() = default;
+
+    /**
+     * @brief local
+     * @return statistics of calling thread, registered on first call
+     */
+    ThreadMetrics& local();
+
+    mutable std::mutex _registry_mutex;
+    std::vector<std::unique_ptr<ThreadMetrics>> _threads;
+    std::array<std::atomic_int64_t, pipeline_gauges> _gauges {};
+};
+
+/**
+ * @class ScopedStageTimer
+ * This class measures time from its creation to its destruction and records it
+ * as duration of pipeline stage. When Tracer is enabled it is also recorded as trace event.
+ */
+class ScopedStageTimer
+{
+public:
+    explicit ScopedStageTimer(PipelineStage stage)
+        : _stage(stage), _start(std::chrono::steady_clock::now())
+    {
+        //Empty
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+    ~ScopedStageTimer()
+    {
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        PipelineMetrics::Instance().Record(_stage, end - _start);
+        Tracer & tracer = Tracer::Instance();
+        if (tracer.Is_enabled())
+        {
+            tracer.Record(Get_stage_name(_stage), _start, end);
+        }
+    }
+private:
+    PipelineStage _stage;
+    std::chrono::steady_clock::time_point _start;
+};
@@ -0,0 +1,214 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ReadCompletion
+ * This struct stores result of one submitted read
+ */
+struct ReadCompletion
+{
+    std::uint64_t _tag;     //tag given to submit
+    int _buffer;            //buffer into which data was read
+    int _result;            //number of bytes read, 0 at end of file or closed socket, -errno on error
+};
+
+/**
+ * @class ReadEngine
+ * This class provides interface for engines which run reads of readers. Engine owns fixed set
+ * of equally sized buffers, reader acquires buffer, submits read into it and gets completion
+ * later, so several reads can be in flight at once. Every buffer has at most one read in flight.
+ * @note engine is used by one thread, thread of its reader
+ */
+class ReadEngine
+{
+public:
+    /**
+     * @brief ReadEngine constructor
+     * @param buffer_count number of buffers
+     * @param buffer_size bytes of one buffer
+     */
+    ReadEngine(std::size_t buffer_count, std::size_t buffer_size);
+
+    ReadEngine(const ReadEngine&) = delete;
+    ReadEngine& operator=(const ReadEngine&) = delete;
+
+    /**
+     * @brief Acquire_buffer
+     * @return index of free buffer, -1 if all buffers are in use
+     */
+    [[nodiscard]] int Acquire_buffer();
+
+    /**
+     * @brief Release_buffer
+     * @param buffer index of buffer which is not needed anymore
+     */
+    void Release_buffer(int buffer);
+
+    /**
+     * @brief Get_buffer
+     * @param buffer index of buffer
+     * @return memory of buffer
+     */
+    [[nodiscard]] std::span<char> Get_buffer(int buffer);
+
+    /**
+     * @brief Get_buffer_size
+     * @return bytes of one buffer
+     */
+    [[nodiscard]] std::size_t Get_buffer_size() const;
+
+    /**
+     * @brief Read_file
+     * @param fname path to file
+     * @param out whole content of file, buffer is reused between calls
+     * @return false if file can't be opened or read
+     * @note file is read in chunks of buffer size, as many chunks in flight as there are buffers
+     */
+    [[nodiscard]] bool Read_file(const std::filesystem::path & fname, std::string & out);
+
+    /**
+     * @brief Submit_read
+     * @param fd file to read
+     * @param buffer acquired buffer
+     * @param length bytes to read, at most buffer size
+     * @param offset position in file
+     * @param tag value returned in completion
+     * @return false if read could not be submitted
+     */
+    virtual bool Submit_read(int fd, int buffer, std::size_t length, std::uint64_t offset, std::uint64_t tag) = 0;
+
+    /**
+     * @brief Submit_recv
+     * @param fd socket to read
+     * @param buffer acquired buffer, filled up to its size
+     * @param tag value returned in completion
+     * @return false if read could not be submitted
+     */
+    virtual bool Submit_recv(int fd, int buffer, std::uint64_t tag) = 0;
+
+    /**
+     * @brief Wait
+     * @param out completions are appended to it
+     * @param timeout_ms how long to wait for first completion
+     * @return number of appended completions, 0 on timeout
+     * @note submitted reads are started at latest by this call
+     */
+    virtual std::size_t Wait(std::vector<ReadCompletion> & out, int timeout_ms) = 0;
+
+    /**
+     * @brief Get_name
+     * @return name of engine, e.g. "io_uring"
+     */
+    [[nodiscard]] virtual const char* Get_name() const = 0;
+
+    virtual ~ReadEngine() = default;
+protected:
+    std::size_t _buffer_size;
+    //memory of all buffers, buffer i starts at i * _buffer_size
+    std::vector<char> _memory;
+    std::vector<int> _free_buffers;
+    std::vector<ReadCompletion> _file_completions;
+};
+
+/**
+ * @class SyncReadEngine
+ * This class runs reads synchronously inside Wait(), it is used where io_uring is not available.
+ */
+class SyncReadEngine final : public ReadEngine
+{
+public:
+    SyncReadEngine(std::size_t buffer_count, std::size_t buffer_size);
+
+    bool Submit_read(int fd, int buffer, std::size_t length, std::uint64_t offset, std::uint64_t tag) override;
+    bool Submit_recv(int fd, int buffer, std::uint64_t tag) override;
+    std::size_t Wait(std::vector<ReadCompletion> & out, int timeout_ms) override;
+    [[nodiscard]] const char* Get_name() const override;
+private:
+    /**
+     * @struct Request
+     * Submitted read which was not run yet
+     */
+    struct Request
+    {
+        int _fd;
+        int _buffer;
+        std::size_t _length;
+        std::uint64_t _offset;
+        std::uint64_t _tag;
+        bool _is_recv;
+    };
+    std::vector<Request> _requests;
+};
+
+/**
+ * @class UringReadEngine
+ * This class submits reads to io_uring of kernel (raw system calls, no liburing). Buffers are
+ * registered, so file reads use fixed buffers and kernel does not map them per read. Reads
+ * submitted before Wait() are passed to kernel together with single system call.
+ */
+class UringReadEngine final : public ReadEngine
+{
+public:
+    /**
+     * @brief UringReadEngine constructor
+     * @param buffer_count number of buffers, also number of reads in flight
+     * @param buffer_size bytes of one buffer
+     * @throw std::runtime_error if io_uring is not available
+     */
+    UringReadEngine(std::size_t buffer_count, std::size_t buffer_size);
+
+    bool Submit_read(int fd, int buffer, std::size_t length, std::uint64_t offset, std::uint64_t tag) override;
+    bool Submit_recv(int fd, int buffer, std::uint64_t tag) override;
+    std::size_t Wait(std::vector<ReadCompletion> & out, int timeout_ms) override;
+    [[nodiscard]] const char* Get_name() const override;
+
+    ~UringReadEngine();
+private:
+    int _ring_fd {-1};
+    void * _ring {nullptr};
+    std::size_t _ring_size {0};
+    void * _entries {nullptr};
+    std::size_t _entries_size {0};
+    //fields of rings shared with kernel
+    std::uint32_t * _sq_head {nullptr};
+    std::uint32_t * _sq_tail {nullptr};
+    std::uint32_t _sq_mask {0};
+    std::uint32_t _sq_capacity {0};
+    std::uint32_t * _sq_array {nullptr};
+    std::uint32_t * _cq_head {nullptr};
+    std::uint32_t * _cq_tail {nullptr};
+    std::uint32_t _cq_mask {0};
+    void * _cqes {nullptr};
+    std::uint32_t _to_submit {0};
+    //true if buffers were registered, otherwise plain reads are used
+    bool _is_fixed {false};
+    //tag of read in flight, per buffer
+    std::vector<std::uint64_t> _tags;
+
+    /**
+     * @brief next_entry
+     * @return free submission queue entry, nullptr if queue is full
+     */
+    void* next_entry();
+
+    /**
+     * @brief release
+     * @note unmaps rings and closes io_uring
+     */
+    void release();
+};
+
+/**
+ * @brief Create_read_engine
+ * @param buffer_count number of buffers, also number of reads in flight
+ * @param buffer_size bytes of one buffer
+ * @param prefer_uring if false, synchronous engine is created
+ * @return io_uring engine if kernel supports it, otherwise synchronous engine
+ */
+[[nodiscard]] std::unique_ptr<ReadEngine> Create_read_engine(std::size_t buffer_count = 8,
+    std::size_t buffer_size = 1 << 18, bool prefer_uring = true);
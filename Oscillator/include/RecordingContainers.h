@@ -1,8 +1,15 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <memory_resource>
+#include <span>
 #include <list>
 #include <vector>
 
+class CompressedBlock;
+
 /**
  * @struct Timestamp
  * This struct stores info about voltage and time for one point
@@ -111,17 +118,36 @@ struct RangeParams
 
 /**
  * @class RecordingVector
- * This class implements storage for Timestamps of one interval (now 1 seconds)
+ * This class implements storage for Timestamps of one interval (now 1 seconds).
+ * Interval can be compressed, then timestamps are available only through
+ * Decompress() or RecordingHistory::iterator.
+ * Timestamps are allocated from memory resource given in constructor (allocation policy),
+ * e.g. BlockPool, so buffers of removed intervals can be reused by new ones.
+ * Copies always use default memory resource. Interval can also be view of immutable block
+ * shared with other consumers (e.g. BlockQueue), then its timestamps are copied only when
+ * they are changed, and copies of view share the block too.
  */
 class RecordingVector
 {
 public:
-    using iterator = std::vector<Timestamp>::iterator;
-    using type = std::vector<Timestamp>;
+    using type = std::pmr::vector<Timestamp>;
+    using iterator = type::iterator;
     using value_type = Timestamp;
 
     RecordingVector() = default;
 
+    /**
+     * @brief RecordingVector constructor
+     * @param resource memory resource from which timestamps are allocated
+     */
+    explicit RecordingVector(std::pmr::memory_resource * resource);
+
+    /**
+     * @brief RecordingVector constructor
+     * @param block immutable interval which timestamps are shared, not copied
+     */
+    explicit RecordingVector(std::shared_ptr<const RecordingVector> block);
+
     /**
      * @brief Get_recording_params
      * @return parameters of interval recording
@@ -137,13 +163,14 @@ public:
     /**
      * @brief Get_container
      * @return vector with timestamps
-     * @note readonly
+     * @note readonly, empty if interval is compressed
      */
     [[nodiscard]] const type& Get_container() const;
 
     /**
      * @brief Get_container
      * @return vector with timestamps
+     * @note empty if interval is compressed, timestamps of shared block are copied first
      */
     [[nodiscard]] type& Get_container();
 
@@ -152,9 +179,34 @@ public:
      * @brief operator[]
      * @param i index of timestamp
      * @return indexed timestamp
+     * @note if interval is compressed whole interval is decompressed, prefer iterators
      */
     [[nodiscard]] Timestamp operator[](unsigned i) const;
 
+    /**
+     * @brief Compress
+     * @note replaces timestamps with their compressed form and releases their memory
+     */
+    void Compress();
+
+    /**
+     * @brief Is_compressed
+     * @return true if timestamps are stored compressed
+     */
+    [[nodiscard]] bool Is_compressed() const;
+
+    /**
+     * @brief Get_compressed
+     * @return compressed timestamps or nullptr if interval is not compressed
+     */
+    [[nodiscard]] std::shared_ptr<const CompressedBlock> Get_compressed() const;
+
+    /**
+     * @brief Decompress
+     * @return copy of timestamps, decompressed if needed
+     */
+    [[nodiscard]] type Decompress() const;
+
     /**
      * @brief Set_vector
      * @param vec vector with timestamp to be set for this container
@@ -178,6 +230,21 @@ public:
 private:
     type _data;
     RangeParams _params;
+    //shared, so copies of compressed interval don't copy compressed data
+    std::shared_ptr<const CompressedBlock> _compressed;
+    //block which timestamps are used instead of _data, it is never changed
+    std::shared_ptr<const RecordingVector> _block;
+};
+
+/**
+ * @struct HistoryGap
+ * This struct stores time range of intervals which were lost before they reached history
+ */
+struct HistoryGap
+{
+    double _start_time;
+    double _end_time;
+    std::uint64_t _lost_intervals;
 };
 
 /**
@@ -185,14 +252,18 @@ private:
  * This class implements storage for intervals containing Timestamps. Limit can be
  * set to manage how many intervals (now 1 interval == 1 second) will be saved. After
  * limit is reach oldest interval is removed and newest saved.
+ * List nodes come from own pool, so pushing and removing intervals doesn't allocate
+ * after history limit is reached.
  */
 class RecordingHistory
 {
 public:
     using value_type = RecordingVector;
-    using type = std::list<RecordingVector>;
+    using type = std::pmr::list<RecordingVector>;
 
     RecordingHistory() = default;
+    RecordingHistory(const RecordingHistory & other);
+    RecordingHistory& operator=(const RecordingHistory & other);
 
     /**
      * @brief Set_history_time_limit
@@ -201,6 +272,13 @@ public:
      */
     void Set_history_time_limit(int limit_in_sec);
 
+    /**
+     * @brief Set_compression
+     * @param enabled if true, intervals older than two newest are compressed
+     * @note two newest intervals always stay raw for the live view
+     */
+    void Set_compression(bool enabled);
+
     /**
      * @brief Get_recording_params
      * @return parameters of saved history
@@ -226,14 +304,30 @@ public:
     /**
      * @brief Get_newest_recordingVector
      * @return newest RecordingVector containing new data read
+     * @note reference is valid until interval is removed from history
      */
-    [[nodiscard]] RecordingVector Get_newest_recordingVector() const;
+    [[nodiscard]] const RecordingVector& Get_newest_recordingVector() const;
 
     /**
      * @brief Get_before_newest_recordingVector
      * @return one before newest RecordingVector containing new data read
+     * @note reference is valid until interval is removed from history
+     */
+    [[nodiscard]] const RecordingVector& Get_before_newest_recordingVector() const;
+
+    /**
+     * @brief Get_newest_view
+     * @return view of timestamps of newest interval, without copying them
+     * @note view is valid until interval is removed from history
+     */
+    [[nodiscard]] std::span<const Timestamp> Get_newest_view() const;
+
+    /**
+     * @brief Get_before_newest_view
+     * @return view of timestamps of one before newest interval, without copying them
+     * @note view is valid until interval is removed from history
      */
-    [[nodiscard]] RecordingVector Get_before_newest_recordingVector() const;
+    [[nodiscard]] std::span<const Timestamp> Get_before_newest_view() const;
 
     /**
      * @brief Get_container
@@ -256,6 +350,58 @@ public:
      */
     bool Push_recordingVector(RecordingVector && vec);
 
+    /**
+     * @brief Freeze
+     * @note history stops changing, pushed intervals are kept in backlog until Unfreeze()
+     */
+    void Freeze();
+
+    /**
+     * @brief Unfreeze
+     * @return number of intervals moved from backlog to history
+     * @note intervals are spliced, so they are neither copied nor reallocated
+     */
+    std::size_t Unfreeze();
+
+    /**
+     * @brief Is_frozen
+     * @return true if history is frozen
+     */
+    [[nodiscard]] bool Is_frozen() const;
+
+    /**
+     * @brief Get_backlog_size
+     * @return number of intervals pushed while frozen
+     */
+    [[nodiscard]] std::size_t Get_backlog_size() const;
+
+    /**
+     * @brief Get_pushed_intervals
+     * @return number of intervals that entered history since its creation
+     * @note it never decreases, so consumer can tell how many intervals are new
+     */
+    [[nodiscard]] std::uint64_t Get_pushed_intervals() const;
+
+    /**
+     * @brief Record_gap
+     * @param gap time range of lost intervals, it is placed after newest interval
+     * @note gaps are removed together with intervals older than them
+     */
+    void Record_gap(const HistoryGap & gap);
+
+    /**
+     * @brief Get_gaps
+     * @return gaps within stored history, oldest first
+     */
+    [[nodiscard]] const std::deque<HistoryGap>& Get_gaps() const;
+
+    /**
+     * @brief Get_lost_intervals
+     * @return number of intervals lost since history creation
+     * @note it never decreases, like Get_pushed_intervals()
+     */
+    [[nodiscard]] std::uint64_t Get_lost_intervals() const;
+
     /**
      * @brief Empty
      * @return true if no timestamps saved
@@ -279,6 +425,7 @@ public:
     public:
         using list_iter = type::const_iterator;
         using vec_iter = type::value_type::type::const_iterator;
+        using vec_type = type::value_type::type;
         using value_type = Timestamp;
         iterator(const RecordingHistory * _recHis_ptr, int list_index, int timestamp_index);
         iterator(const iterator &) = default;
@@ -324,6 +471,20 @@ public:
         const RecordingHistory * _data_ptr;
         list_iter _list_it;
         vec_iter _vec_it;
+        //decompressed copy of interval pointed by _list_it, if it is compressed
+        std::shared_ptr<const vec_type> _decompressed;
+
+        /**
+         * @brief enter_interval
+         * @return timestamps of interval pointed by _list_it, decompressed if needed
+         */
+        const vec_type& enter_interval();
+
+        /**
+         * @brief current_interval
+         * @return timestamps of interval pointed by _list_it
+         */
+        [[nodiscard]] const vec_type& current_interval() const;
     };
 
     /**
@@ -338,7 +499,25 @@ public:
      */
     [[nodiscard]] iterator End() const;
 private:
-    type _data;
+    /**
+     * @brief appended
+     * @note updates compression, parameters and counter after interval was appended to _data
+     */
+    void appended();
+
+    std::pmr::unsynchronized_pool_resource _node_pool;
+    type _data {&_node_pool};
+    //intervals pushed while frozen, same allocator as _data so they can be spliced
+    type _backlog {&_node_pool};
     RangeParams _params;
     int _recordingVectors_limit {30};  //One recording == 1 second of history
+    bool _compression {false};
+    std::atomic_bool _frozen {false};
+    std::atomic_uint64_t _pushed_intervals {0};
+    std::deque<HistoryGap> _gaps;
+    std::atomic_uint64_t _lost_intervals {0};
+
+    //last interval decompressed by operator[], so indexing in order doesn't decompress each time
+    mutable std::weak_ptr<const CompressedBlock> _indexed_block;
+    mutable RecordingVector::type _indexed_data;
 };
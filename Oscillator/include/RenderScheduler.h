@@ -0,0 +1,90 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @enum DirtyFlag
+ * @note defines reasons for which frame has to be redrawn, flags can be combined
+ */
+enum class DirtyFlag : std::uint8_t
+{
+    NONE    = 0,
+    DATA    = 1 << 0,   //new data added to chart
+    VIEW    = 1 << 1,   //zoom, pan or scrolling changed visible range
+    CURSOR  = 1 << 2,   //cursor moved
+    OVERLAY = 1 << 3,   //overlay (ImGui) needs refresh
+    WINDOW  = 1 << 4    //window resized, exposed or got focus
+};
+
+/**
+ * @class RenderScheduler
+ * @brief Decides when main loop draws a frame. Frame is drawn only if something marked it dirty,
+ * and not more often than frame limit allows. Between frames main loop waits for events with
+ * timeout from Get_wait_time(), so when nothing changes it sleeps instead of spinning.
+ */
+class RenderScheduler
+{
+public:
+using clock = std::chrono::steady_clock;
+/**
+ * @brief constructor
+ * @param frame_limit max frames per second, 0 means no limit
+ * @param idle_wait max time main loop waits for events when nothing is dirty
+ */
+explicit RenderScheduler(int frame_limit = 60, std::chrono::milliseconds idle_wait = std::chrono::milliseconds(50));
+/**
+ * @brief marks frame as dirty.
+ * @param flag reason of redraw.
+ */
+void Mark_dirty(DirtyFlag flag);
+/**
+ * @brief requests redraw at least every period, e.g. for overlay with live values.
+ * @param period period of refresh, zero disables it.
+ */
+void Set_refresh_period(std::chrono::milliseconds period);
+/**
+ * @brief sets max frames per second.
+ * @param frame_limit max frames per second, 0 means no limit
+ */
+void Set_frame_limit(int frame_limit);
+/**
+ * @brief checks if frame should be drawn now.
+ * @return true if frame is dirty and frame limit allows drawing.
+ */
+[[nodiscard]] bool Should_draw();
+/**
+ * @brief calculates how long main loop can wait for events.
+ * @return zero if frame should be drawn now.
+ */
+[[nodiscard]] std::chrono::microseconds Get_wait_time();
+/**
+ * @brief clears dirty flags, has to be called after frame was drawn.
+ */
+void Frame_drawn();
+/**
+ * @brief checks if given flag is set.
+ */
+[[nodiscard]] bool Is_dirty(DirtyFlag flag) const;
+/**
+ * @brief checks if any flag is set.
+ */
+[[nodiscard]] bool Is_dirty() const;
+[[nodiscard]] std::uint64_t Get_drawn_frames() const;
+[[nodiscard]] std::uint64_t Get_skipped_frames() const;
+private:
+/**
+ * @brief sets OVERLAY flag when refresh period passed.
+ */
+void Check_refresh(clock::time_point now);
+
+std::uint8_t m_dirty;
+clock::duration m_frame_period;
+std::chrono::milliseconds m_idle_wait;
+std::chrono::milliseconds m_refresh_period;
+clock::time_point m_last_frame;
+std::uint64_t m_drawn_frames;
+/**
+ * Loop iterations in which nothing had to be drawn.
+ */
+std::uint64_t m_skipped_frames;
+};
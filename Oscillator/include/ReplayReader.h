@@ -0,0 +1,218 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+#include "IReader.h"
+#include "BlockPool.h"
+#include "CaptureIndex.h"
+#include "TaskPool.h"
+
+/**
+ * @enum ReplayMode
+ * @note defines how fast recorded capture is played back
+ */
+enum class ReplayMode
+{
+    REAL_TIME,
+    ACCELERATED,
+    AS_FAST_AS_POSSIBLE
+};
+
+/**
+ * @class ReplayReader
+ * This class implements IReader interface that plays back recorded capture file
+ * (lines of "time voltage", like files created by Generator). Capture is split into
+ * intervals (now 1 second) which are pushed to RecordingHistory with the same pace as
+ * they were recorded, N times faster or as fast as possible. Prefetch thread parses
+ * capture ahead of playback, so pacing is not disturbed by parsing. Capture is mapped
+ * and its intervals are found by CaptureIndex, so first interval is played right after
+ * Start() while rest of capture is indexed in background by TaskPool.
+ */
+class ReplayReader final : public IReader
+{
+public:
+    ReplayReader(const std::string_view & fname, ReplayMode mode = ReplayMode::REAL_TIME,
+        double speed = 1.0);
+
+    /**
+     * @brief Get_data
+     * @return RecordingHistory with all timestamps replayed
+     */
+    [[nodiscard]] const RecordingHistory& Get_data() const override;
+
+    /**
+     * @brief Get_history_snapshot
+     * @return parameters and size of history, safe to call while Reader thread pushes
+     */
+    [[nodiscard]] HistorySnapshot Get_history_snapshot() const override;
+
+    /**
+     * @brief Get_state
+     * @return state of the reader
+     */
+    [[nodiscard]] ReaderState Get_state() const override;
+
+    /**
+     * @brief Check_if_new_data_loaded
+     * @return true if new data after last call to this function was loaded
+     */
+    [[nodiscard]] bool Check_if_new_data_loaded() override;
+
+    /**
+     * @brief Set_file
+     * @param fname name of capture file to replay
+     * @return true if file exists and replay is not running
+     */
+    [[nodiscard]] bool Set_file(const std::string_view & fname) override;
+
+    /**
+     * @brief Set_history_time_limit
+     * @param limit_in_sec limit of seconds of input history stored
+     */
+    void Set_history_time_limit(int limit_in_sec) override;
+
+    /**
+     * @brief Set_history_compression
+     * @param enabled if true, older intervals of history are stored compressed
+     */
+    void Set_history_compression(bool enabled) override;
+
+    /**
+     * @brief Freeze
+     * @note history returned by Get_data() stops changing, acquisition continues
+     * in background buffer
+     */
+    void Freeze() override;
+
+    /**
+     * @brief Unfreeze
+     * @note intervals acquired while frozen are spliced into history
+     */
+    void Unfreeze() override;
+
+    /**
+     * @brief Is_frozen
+     * @return true if history is frozen
+     */
+    [[nodiscard]] bool Is_frozen() const override;
+
+    /**
+     * @brief Set_block_queue
+     * @param queue queue to which every interval is added after it is pushed to history, can be nullptr
+     * @note has to be called before Start(), queue is filled also while history is frozen
+     */
+    void Set_block_queue(std::shared_ptr<BlockQueue> queue) override;
+
+    /**
+     * @brief Set_replay_mode
+     * @param mode pace of playback
+     * @param speed how many times faster than real time capture is replayed,
+     * used only with ReplayMode::ACCELERATED
+     */
+    void Set_replay_mode(ReplayMode mode, double speed = 1.0);
+
+    /**
+     * @brief Set_prefetch_depth
+     * @param intervals how many parsed intervals can wait for playback
+     */
+    void Set_prefetch_depth(int intervals);
+
+    /**
+     * @brief Set_task_pool
+     * @param pool pool which indexes capture in background and parses large intervals,
+     * nullptr means prefetch thread does both
+     * @note has to be called before Start()
+     */
+    void Set_task_pool(std::shared_ptr<TaskPool> pool);
+
+    /**
+     * @brief Get_capture_index
+     * @return index of capture replayed since Start(), nullptr before it
+     */
+    [[nodiscard]] std::shared_ptr<CaptureIndex> Get_capture_index() const;
+
+    /**
+     * @brief Is_finished
+     * @return true if whole capture was replayed
+     */
+    [[nodiscard]] bool Is_finished() const;
+
+    /**
+     * @brief Get_replayed_points
+     * @return number of timestamps pushed to history since Start()
+     */
+    [[nodiscard]] long long Get_replayed_points() const;
+
+    /**
+     * @brief Start
+     * @note starts execution of prefetch and playback threads
+     * @throws runtime_error if capture can't be opened
+     */
+    void Start() override;
+
+    /**
+     * @brief Stop
+     * @note pauses playback, capture position is kept
+     */
+    void Stop() override;
+
+    /**
+     * @brief Resume
+     * @note resumes playback after Stop() was called
+     */
+    void Resume() override;
+
+    /**
+     * @brief Destroy
+     * @note destroys threads, after this new threads with Start() can be created
+     */
+    void Destroy() override;
+
+    ~ReplayReader();
+private:
+    std::string _fname;
+    ReplayMode _mode;
+    double _speed;
+    //declared before _data and _prefetched, so it outlives intervals allocated from it, shared with blocks given to queue
+    std::shared_ptr<BlockPool> _pool {std::make_shared<BlockPool>()};
+    RecordingHistory _data;
+    //guards pushes against Freeze(), Unfreeze() and snapshots taken by other thread
+    mutable std::mutex _data_mutex;
+    std::shared_ptr<BlockQueue> _block_queue;
+    std::shared_ptr<TaskPool> _task_pool;
+    std::shared_ptr<CaptureIndex> _index;
+    std::thread _thread;
+    std::thread _prefetch_thread;
+    std::atomic<ReaderState> _state;
+    std::atomic_bool _new_data_loaded;
+    std::atomic_llong _replayed_points;
+
+    //prefetch queue shared by both threads
+    std::deque<RecordingVector> _prefetched;
+    std::mutex _prefetch_mutex;
+    std::condition_variable _prefetch_cv;
+    int _prefetch_depth {4};
+    bool _prefetch_done;
+
+    //states
+    std::atomic_bool _destroyed;
+    std::atomic_bool _destroy_flag;
+    std::atomic_bool _stop_flag;
+    std::atomic_bool _running;
+    std::atomic_bool _finished;
+
+    /**
+     * @brief prefetch_loop
+     * @note loop in which capture is parsed into intervals ahead of playback
+     */
+    void prefetch_loop(void);
+
+    /**
+     * @brief running_loop
+     * @note loop in which prefetched intervals are paced and pushed to history
+     */
+    void running_loop(void);
+};
@@ -0,0 +1,210 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IReader.h"
+#include "HistoryArchive.h"
+#include "BlockPool.h"
+#include "BlockSink.h"
+#include "ReadEngine.h"
+#include "OverrunPolicy.h"
+
+/**
+ * @class SocketReader
+ * This class implements IReader interface that receives intervals streamed by SocketSink
+ * over Unix domain socket, so acquisition source can run as separate process and nothing
+ * goes through filesystem. Reader listens on socket and serves one source at a time, every
+ * frame becomes one interval. Socket is read in large batches through ReadEngine (io_uring
+ * when kernel supports it) with one receive always in flight, and frames are decoded into
+ * intervals allocated from pool. Sequence numbers missing in stream (frames dropped by
+ * SocketSink on overrun) are recorded as gaps of history.
+ */
+class SocketReader final : public IReader
+{
+public:
+    /**
+     * @brief SocketReader constructor
+     * @param path path of socket on which reader listens
+     */
+    explicit SocketReader(const std::string_view & path = "oscillator.sock");
+
+    SocketReader(const SocketReader&) = delete;
+    SocketReader& operator=(const SocketReader&) = delete;
+
+    /**
+     * @brief Get_data
+     * @return RecordingHistory with all timestamps received
+     */
+    [[nodiscard]] const RecordingHistory& Get_data() const override;
+
+    /**
+     * @brief Get_history_snapshot
+     * @return parameters and size of history, safe to call while Reader thread pushes
+     */
+    [[nodiscard]] HistorySnapshot Get_history_snapshot() const override;
+
+    /**
+     * @brief Get_state
+     * @return state of the reader
+     */
+    [[nodiscard]] ReaderState Get_state() const override;
+
+    /**
+     * @brief Check_if_new_data_loaded
+     * @return true if new data after last call to this function was loaded
+     */
+    [[nodiscard]] bool Check_if_new_data_loaded() override;
+
+    /**
+     * @brief Set_file
+     * @param fname path of socket
+     * @return true if path was changed, it can't be changed while reader runs
+     */
+    [[nodiscard]] bool Set_file(const std::string_view & fname) override;
+
+    /**
+     * @brief Set_history_time_limit
+     * @param limit_in_sec limit of seconds of input history stored
+     */
+    void Set_history_time_limit(int limit_in_sec) override;
+
+    /**
+     * @brief Set_history_compression
+     * @param enabled if true, older intervals of history are stored compressed
+     */
+    void Set_history_compression(bool enabled) override;
+
+    /**
+     * @brief Freeze
+     * @note history returned by Get_data() stops changing, acquisition continues
+     * in background buffer
+     */
+    void Freeze() override;
+
+    /**
+     * @brief Unfreeze
+     * @note intervals acquired while frozen are spliced into history
+     */
+    void Unfreeze() override;
+
+    /**
+     * @brief Is_frozen
+     * @return true if history is frozen
+     */
+    [[nodiscard]] bool Is_frozen() const override;
+
+    /**
+     * @brief Set_block_queue
+     * @param queue queue to which every interval is added after it is pushed to history, can be nullptr
+     * @note has to be called before Start(), queue is filled also while history is frozen
+     */
+    void Set_block_queue(std::shared_ptr<BlockQueue> queue) override;
+
+    /**
+     * @brief Set_archive
+     * @param archive archive to which every received interval is appended, can be nullptr
+     * @note archive is cleared on Resume(), because time starts again from 0
+     */
+    void Set_archive(std::shared_ptr<HistoryArchive> archive);
+
+    /**
+     * @brief Get_rejected_connections
+     * @return number of connections closed because they sent malformed frame
+     */
+    [[nodiscard]] std::uint64_t Get_rejected_connections() const;
+
+    /**
+     * @brief Start
+     * @note starts listening on socket and execution of Reader thread
+     * @throw std::runtime_error if socket can't be created
+     */
+    void Start() override;
+
+    /**
+     * @brief Stop
+     * @note stops execution of Reader thread, source can't send until Resume()
+     */
+    void Stop() override;
+
+    /**
+     * @brief Resume
+     * @note resumes execution after Stop() was called
+     */
+    void Resume() override;
+
+    /**
+     * @brief Destroy
+     * @note destroys thread and closes socket, after this new thread with Start() can be created
+     */
+    void Destroy() override;
+
+    ~SocketReader();
+private:
+    double _start_time {0.0};
+    //time span of last interval, lost intervals are assumed to be as long
+    double _interval_span {0.0};
+    GapDetector _gap_detector;
+    std::string _path;
+    int _listen_socket {-1};
+    int _client_socket {-1};
+    //received bytes, frames are decoded from its begin
+    std::vector<char> _buffer;
+    std::size_t _buffered {0};
+    std::unique_ptr<ReadEngine> _engine;
+    std::vector<ReadCompletion> _completions;
+    //engine buffer of receive in flight, -1 if none
+    int _recv_buffer {-1};
+    //declared before _data, so it outlives intervals allocated from it, shared with blocks given to queue
+    std::shared_ptr<BlockPool> _pool {std::make_shared<BlockPool>()};
+    RecordingHistory _data;
+    //guards pushes to history against Freeze(), Unfreeze() and snapshots taken by other thread
+    mutable std::mutex _data_mutex;
+    std::shared_ptr<HistoryArchive> _archive;
+    std::shared_ptr<BlockQueue> _block_queue;
+    std::thread _thread;
+    std::atomic<ReaderState> _state {ReaderState::CREATED};
+    //set by Reader thread and Unfreeze(), cleared by consumer
+    std::atomic_bool _new_data_loaded {false};
+    std::atomic_uint64_t _rejected_connections {0};
+
+    //states
+    std::atomic_bool _destroyed {true};
+    std::atomic_bool _destroy_flag {false};
+    std::atomic_bool _stop_flag {false};
+    std::atomic_bool _running {false};
+
+    /**
+     * @brief accept_client
+     * @note waits shortly for source and accepts its connection
+     */
+    void accept_client();
+
+    /**
+     * @brief receive
+     * @note waits shortly for data of source, reads what is available and pushes complete frames
+     */
+    void receive();
+
+    /**
+     * @brief push_frame
+     * @param points samples of frame, pairs of time and voltage
+     * @param count number of samples
+     * @param sequence sequence number of frame
+     */
+    void push_frame(const char * points, std::size_t count, std::uint64_t sequence);
+
+    /**
+     * @brief close_client
+     * @note closes connection of source, incomplete frame is dropped
+     */
+    void close_client();
+
+    /**
+     * @brief running_loop
+     * @note loop in which Reader receives data
+     */
+    void running_loop(void);
+};
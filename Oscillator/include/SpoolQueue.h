@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class SpoolQueue
+ * This class implements queue of interval files in spool directory, which connects FileSink
+ * and FileReader. Producer writes every block to temporary file and publishes it by rename
+ * to "<sequence>.blk", so reader never sees partially written block. Producer can run several
+ * blocks ahead, reader consumes published blocks in order of their sequence numbers and removes
+ * them.
+ */
+class SpoolQueue
+{
+public:
+    /**
+     * @brief SpoolQueue constructor
+     * @param directory path of spool directory
+     */
+    explicit SpoolQueue(std::string_view directory);
+
+    /**
+     * @brief Reset
+     * @return true if spool directory exists and is empty
+     * @note directory is created, blocks left by previous run are removed
+     */
+    bool Reset();
+
+    /**
+     * @brief Publish
+     * @param content content of block
+     * @return true if block was published
+     */
+    bool Publish(std::string_view content);
+
+    /**
+     * @brief Skip
+     * @note sequence number of block which is not published is skipped, so reader sees gap
+     */
+    void Skip();
+
+    /**
+     * @brief Drop_oldest
+     * @return true if oldest published block was removed before reader took it
+     */
+    bool Drop_oldest();
+
+    /**
+     * @brief Get_pending
+     * @param out published blocks in order of sequence, it is cleared first
+     * @param max_count maximal number of returned blocks
+     */
+    void Get_pending(std::vector<std::filesystem::path> & out, std::size_t max_count) const;
+
+    /**
+     * @brief Count_pending
+     * @return number of published blocks which were not removed by reader yet
+     */
+    [[nodiscard]] std::size_t Count_pending() const;
+
+    /**
+     * @brief Get_directory
+     * @return path of spool directory
+     */
+    [[nodiscard]] const std::filesystem::path& Get_directory() const;
+
+    /**
+     * @brief Parse_sequence
+     * @param block path of file in spool directory
+     * @param sequence sequence number of block
+     * @return true if file is published block
+     */
+    static bool Parse_sequence(const std::filesystem::path & block, std::uint64_t & sequence);
+private:
+    std::filesystem::path _directory;
+    std::uint64_t _next_sequence {0};
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "BlockQueue.h"
+#include "RecordingContainers.h"
+#include "TaskPool.h"
+
+/**
+ * @struct SummaryBucket
+ * This struct stores extremes of consecutive points: points with min and max voltage.
+ */
+struct SummaryBucket
+{
+    double _start_time;
+    Timestamp _min;
+    Timestamp _max;
+};
+
+/**
+ * @struct SummaryProgress
+ * This struct stores how far building of summaries is
+ */
+struct SummaryProgress
+{
+    std::size_t _blocks;        //blocks added since Clear(), including evicted ones
+    std::size_t _summarized;    //blocks which summary levels are built
+
+    /**
+     * @brief Get_fraction
+     * @return summarized part of blocks, 1.0 if nothing was added
+     */
+    [[nodiscard]] double Get_fraction() const
+    {
+        return (_blocks == 0) ? 1.0 : static_cast<double>(_summarized) / _blocks;
+    }
+};
+
+/**
+ * @class SummaryPyramid
+ * This class keeps render summaries of intervals (blocks), so zoomed out view of long history
+ * is drawn from few buckets instead of all points. Summary of every block is independent
+ * reduction: level 0 has bucket of every bucket_points points, every next level merges
+ * level_fanout buckets of previous one, up to one bucket. Blocks are summarized in parallel by
+ * tasks of TaskPool, until then extremes of block from its RangeParams stand for it, so first
+ * frame is drawn immediately with coarse data which refines as blocks are summarized.
+ * Query() merges buckets of blocks upward to requested columns. Summaries of blocks older than
+ * history time limit are evicted, so pyramid covers the same time as history of chart.
+ * @note Add_block(), Query() and Clear() are called by one thread, tasks only fill levels
+ */
+class SummaryPyramid final
+{
+public:
+    //points of one bucket of level 0
+    static constexpr std::size_t bucket_points = 256;
+    //buckets of level merged into one bucket of next level
+    static constexpr std::size_t level_fanout = 4;
+
+    /**
+     * @brief SummaryPyramid constructor
+     * @param pool pool which builds summaries, nullptr means Add_block() builds them
+     */
+    explicit SummaryPyramid(std::shared_ptr<TaskPool> pool = nullptr);
+
+    SummaryPyramid(const SummaryPyramid&) = delete;
+    SummaryPyramid& operator=(const SummaryPyramid&) = delete;
+
+    /**
+     * @brief Set_history_time_limit
+     * @param limit_in_sec seconds before newest added point which are kept summarized
+     */
+    void Set_history_time_limit(int limit_in_sec);
+
+    /**
+     * @brief Add_block
+     * @param block interval newer than all added before
+     * @note summary is built later by task of pool, empty block is ignored, summaries older
+     * than history time limit are evicted
+     */
+    void Add_block(BlockHandle block);
+
+    /**
+     * @brief Query
+     * @param min_time begin of requested time range
+     * @param max_time end of requested time range
+     * @param columns number of equal time columns of range, e.g. pixels
+     * @param out min & max points of each column in time order, it is cleared first
+     * @return false if summaries are coarser than one column, points have to be decimated then
+     */
+    bool Query(double min_time, double max_time, int columns, std::vector<Timestamp> & out) const;
+
+    /**
+     * @brief Get_progress
+     * @return number of added and summarized blocks
+     */
+    [[nodiscard]] SummaryProgress Get_progress() const;
+
+    /**
+     * @brief Get_min_time
+     * @return time of oldest point which is summarized, 0.0 if nothing was added
+     */
+    [[nodiscard]] double Get_min_time() const;
+
+    /**
+     * @brief Clear
+     * @note forgets all blocks, tasks still running finish on their own data
+     */
+    void Clear();
+private:
+    /**
+     * @struct BlockSummary
+     * Summary of one block, levels are valid only after _ready is set
+     */
+    struct BlockSummary
+    {
+        double _min_time;
+        double _max_time;
+        //time of bucket of level 0
+        double _bucket_time;
+        //extremes from RangeParams, used until levels are built
+        SummaryBucket _envelope;
+        std::vector<std::vector<SummaryBucket>> _levels;
+        std::atomic_bool _ready {false};
+    };
+
+    std::shared_ptr<TaskPool> _pool;
+    //summaries in time order, the oldest are evicted from front
+    std::deque<std::shared_ptr<BlockSummary>> _blocks;
+    std::size_t _added {0};
+    int _time_limit {60};
+    //shared with tasks, which may outlive Clear()
+    std::shared_ptr<std::atomic<std::size_t>> _summarized;
+
+    /**
+     * @brief build_levels
+     * @param block interval to summarize
+     * @param summary summary which levels are built
+     */
+    static void build_levels(const RecordingVector & block, BlockSummary & summary);
+};
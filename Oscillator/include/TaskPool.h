@@ -0,0 +1,192 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PipelineMetrics.h"
+
+/**
+ * @enum TaskPriority
+ * @note defines order in which queued tasks are run, HIGH first
+ */
+enum class TaskPriority
+{
+    HIGH,       //on path from source to screen
+    NORMAL,
+    LOW,        //background work nobody waits for
+    COUNT
+};
+
+constexpr std::size_t task_priorities = static_cast<std::size_t>(TaskPriority::COUNT);
+
+/**
+ * @class TaskPool
+ * This class implements work-stealing pool of threads shared by CPU heavy stages of pipeline.
+ * It is owned by application and given to components which use it, so all stages together
+ * never run more threads than there are cores. Stages submit tasks of block granularity
+ * (interval, chunk of interval), task is queued with priority of its stage. Every worker has
+ * its own queue per priority, task submitted by worker goes to its own queue and worker
+ * takes newest task from it, idle worker steals oldest task of other workers. Task of higher
+ * priority is always taken before task of lower priority. Long running loops (readers,
+ * generator) keep their own threads, they mostly wait for I/O and timers.
+ */
+class TaskPool final
+{
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief TaskPool constructor
+     * @param workers number of worker threads, 0 means one less than hardware threads (at least one),
+     * thread waiting for its tasks runs queued tasks too
+     */
+    explicit TaskPool(std::size_t workers = 0);
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /**
+     * @brief Submit
+     * @param stage stage of pipeline which task belongs to, it gives priority
+     * @param task work to run, it must not throw (see TaskGroup)
+     */
+    void Submit(PipelineStage stage, Task task);
+
+    /**
+     * @brief Run_pending_task
+     * @param lowest lowest priority of task which may be run
+     * @return true if one queued task was run by calling thread
+     * @note used by threads which wait for their tasks, so waiting thread is not idle
+     */
+    bool Run_pending_task(TaskPriority lowest = TaskPriority::LOW);
+
+    /**
+     * @brief Set_stage_priority
+     * @param stage stage of pipeline
+     * @param priority priority of tasks submitted by stage from now on
+     */
+    void Set_stage_priority(PipelineStage stage, TaskPriority priority);
+
+    /**
+     * @brief Get_stage_priority
+     * @param stage stage of pipeline
+     * @return priority of tasks submitted by stage
+     */
+    [[nodiscard]] TaskPriority Get_stage_priority(PipelineStage stage) const;
+
+    /**
+     * @brief Get_worker_count
+     * @return number of worker threads
+     */
+    [[nodiscard]] std::size_t Get_worker_count() const;
+
+    /**
+     * @brief Get_stolen
+     * @return number of tasks run by other worker than one they were queued to
+     */
+    [[nodiscard]] std::uint64_t Get_stolen() const;
+
+    /**
+     * @brief TaskPool destructor
+     * @note waits only for running tasks, queued tasks are discarded
+     */
+    ~TaskPool();
+private:
+    /**
+     * @struct Worker
+     * Queues of one worker, owner takes from back, others steal from front
+     */
+    struct Worker
+    {
+        std::mutex _mutex;
+        std::array<std::deque<Task>, task_priorities> _queues;
+        std::thread _thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::array<std::atomic<TaskPriority>, pipeline_stages> _priorities;
+    //number of queued tasks, workers sleep while it is 0
+    std::atomic<std::size_t> _queued {0};
+    std::atomic<std::size_t> _next_worker {0};
+    std::atomic_uint64_t _stolen {0};
+    std::atomic_bool _destroy_flag {false};
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+
+    /**
+     * @brief take_task
+     * @param self index of calling worker, workers count if caller is not worker
+     * @param lowest lowest priority of task which may be taken
+     * @param task taken task
+     * @return false if no such task is queued
+     */
+    bool take_task(std::size_t self, TaskPriority lowest, Task & task);
+
+    /**
+     * @brief running_loop
+     * @param self index of worker
+     * @note loop in which worker runs tasks
+     */
+    void running_loop(std::size_t self);
+};
+
+/**
+ * @class TaskGroup
+ * This class submits related tasks to TaskPool and waits for all of them. Thread which waits
+ * runs queued tasks of at least priority of its group meanwhile, so nested groups don't block
+ * workers and waiting is not delayed by background work. Without pool tasks run immediately
+ * in calling thread. Exception thrown by task is rethrown by Wait().
+ */
+class TaskGroup final
+{
+public:
+    /**
+     * @brief TaskGroup constructor
+     * @param pool pool which runs tasks, can be nullptr
+     * @param stage stage of pipeline which tasks belong to
+     */
+    TaskGroup(TaskPool * pool, PipelineStage stage);
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * @brief Run
+     * @param task work to run, it can reference data of caller until Wait() returns
+     */
+    void Run(TaskPool::Task task);
+
+    /**
+     * @brief Wait
+     * @note returns when all tasks of group finished
+     * @throws exception thrown by first failed task
+     */
+    void Wait();
+
+    /**
+     * @brief TaskGroup destructor
+     * @note waits for tasks which were not waited for
+     */
+    ~TaskGroup();
+private:
+    TaskPool * _pool;
+    PipelineStage _stage;
+    std::mutex _mutex;
+    std::condition_variable _done;
+    std::size_t _pending {0};
+    std::exception_ptr _error;
+
+    /**
+     * @brief wait_pending
+     * @note waits for all tasks without rethrowing their exception
+     */
+    void wait_pending();
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <filesystem>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "RecordingContainers.h"
+#include "TaskPool.h"
+
+/**
+ * @class TextCodec
+ * This class encodes and decodes text format of Generator and FileReader, lines of
+ * "time voltage". Numbers are converted with std::to_chars and std::from_chars, which neither
+ * use locale nor go through streams. Large texts are decoded in parallel, they are split into
+ * chunks at line boundaries and every chunk is parsed by task of TaskPool.
+ */
+class TextCodec final
+{
+public:
+    /**
+     * @brief Encode_interval
+     * @param values voltages of one interval
+     * @param step time between two samples, time of first sample is 0
+     * @param last_time time of last sample, decimated interval keeps its last sample off step
+     * @param out encoded lines are appended to it, last line has no line break
+     * @note numbers are written in shortest form which is read back to the same double
+     */
+    static void Encode_interval(std::span<const double> values, double step, double last_time, std::string & out);
+
+    /**
+     * @brief Decode_interval
+     * @param text lines of "time voltage", time and voltage separated by spaces or tabs
+     * @param start_time time added to every timestamp read
+     * @param resource memory resource from which timestamps are allocated
+     * @param expected_points number of timestamps reserved before reading
+     * @param pool pool which parses chunks of large text, nullptr means calling thread parses whole text
+     * @return interval with read timestamps and its parameters
+     * @note incomplete or malformed line is skipped, so truncated text gives no bogus sample
+     */
+    [[nodiscard]] static RecordingVector Decode_interval(std::string_view text, double start_time,
+        std::pmr::memory_resource * resource = std::pmr::get_default_resource(), int expected_points = 0,
+        TaskPool * pool = nullptr);
+
+    /**
+     * @brief Read_file
+     * @param fname path to file
+     * @param out whole content of file, buffer is reused between calls
+     * @return false if file can't be opened or read
+     */
+    [[nodiscard]] static bool Read_file(const std::filesystem::path & fname, std::string & out);
+};
@@ -0,0 +1,152 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class Tracer
+ * This class records scoped trace events (name, start, duration) of every thread and
+ * writes them as Chrome trace JSON, which can be opened in chrome://tracing or Perfetto.
+ * Every thread writes only to its own ring buffer (registered on first event), so recording
+ * is lock free. When buffer is full the oldest events are overwritten. Recording is disabled
+ * by default and then costs one relaxed atomic load.
+ */
+class Tracer
+{
+public:
+    static constexpr std::size_t events_per_thread = 1 << 14;
+
+    /**
+     * @brief Instance
+     * @return tracer shared by whole application
+     */
+    static Tracer& Instance();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief Set_enabled
+     * @param enabled true to start recording events
+     */
+    void Set_enabled(bool enabled);
+
+    /**
+     * @brief Is_enabled
+     * @return true if events are recorded
+     */
+    [[nodiscard]] bool Is_enabled() const;
+
+    /**
+     * @brief Set_thread_name
+     * @param name name of calling thread shown in timeline
+     */
+    void Set_thread_name(const std::string_view & name);
+
+    /**
+     * @brief Record
+     * @param name name of event, has to be string literal (pointer is stored)
+     * @param start moment when event started
+     * @param end moment when event finished
+     */
+    void Record(const char * name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    /**
+     * @brief Write_chrome_trace
+     * @param out stream to which JSON is written
+     * @return number of written events
+     */
+    std::size_t Write_chrome_trace(std::ostream & out) const;
+
+    /**
+     * @brief Dump
+     * @param fname name of JSON file
+     * @return true if file was written
+     */
+    bool Dump(const std::string & fname) const;
+
+    /**
+     * @brief Clear
+     * @note drops recorded events, names of threads are kept
+     */
+    void Clear();
+private:
+    /**
+     * @struct Event
+     * Fields are atomic, because Write_chrome_trace() may read slot which is overwritten.
+     */
+    struct Event
+    {
+        std::atomic<const char*> _name {nullptr};
+        std::atomic_int64_t _start_ns {0};
+        std::atomic_int64_t _duration_ns {0};
+    };
+
+    /**
+     * @struct ThreadBuffer
+     * Ring buffer written by one thread only.
+     */
+    struct ThreadBuffer
+    {
+        std::string _name;
+        int _tid = 0;
+        std::atomic_uint64_t _head {0};   //number of events ever recorded
+        std::atomic_uint64_t _tail {0};   //first event not cleared
+        std::array<Event, events_per_thread> _events;
+    };
+
+    Tracer();
+
+    /**
+     * @brief local
+     * @return buffer of calling thread, registered on first call
+     */
+    ThreadBuffer& local();
+
+    std::atomic_bool _enabled {false};
+    std::chrono::steady_clock::time_point _epoch;
+    mutable std::mutex _registry_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> _threads;
+};
+
+/**
+ * @class TraceScope
+ * This class records trace event lasting from its creation to its destruction.
+ */
+class TraceScope
+{
+public:
+    /**
+     * @brief TraceScope constructor
+     * @param name name of event, has to be string literal
+     */
+    explicit TraceScope(const char * name)
+        : _name(Tracer::Instance().Is_enabled() ? name : nullptr)
+    {
+        if (_name)
+        {
+            _start = std::chrono::steady_clock::now();
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    ~TraceScope()
+    {
+        if (_name)
+        {
+            Tracer::Instance().Record(_name, _start, std::chrono::steady_clock::now());
+        }
+    }
+private:
+    const char * _name;
+    std::chrono::steady_clock::time_point _start;
+};
@@ -0,0 +1,179 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "DensityGrid.h"
+#include "RecordingContainers.h"
+
+/**
+ * @struct XYSettings
+ * This struct stores parameters of XY (Lissajous) accumulation
+ */
+struct XYSettings
+{
+    int _columns = 256;             //bins of channel X
+    int _rows = 256;                //bins of channel Y
+    double _min_x = -2.5;
+    double _max_x = 2.5;
+    double _min_y = -2.5;
+    double _max_y = 2.5;
+    double _half_life = 0.5;        //seconds after which hits lose half of intensity
+};
+
+/**
+ * @class XYAccumulator
+ * This class plots channel X against channel Y. Streams of both channels are pushed separately,
+ * in its own thread every sample of X is paired with Y interpolated at time of that sample and
+ * pair is binned into 2D hit-count histogram which decays with time. Samples are not drawn one
+ * by one, so cost of reading histogram does not depend on sample rate.
+ */
+class XYAccumulator final
+{
+public:
+    explicit XYAccumulator(const XYSettings & settings = XYSettings());
+
+    XYAccumulator(const XYAccumulator&) = delete;
+    XYAccumulator& operator=(const XYAccumulator&) = delete;
+
+    /**
+     * @brief Push_x
+     * @param timestamps new timestamps of channel X in time order, ignored when stopped
+     */
+    void Push_x(std::span<const Timestamp> timestamps);
+
+    /**
+     * @brief Push_y
+     * @param timestamps new timestamps of channel Y in time order, ignored when stopped
+     */
+    void Push_y(std::span<const Timestamp> timestamps);
+
+    /**
+     * @brief Set_settings
+     * @param settings new parameters, histogram is cleared if its geometry changed
+     */
+    void Set_settings(const XYSettings & settings);
+
+    /**
+     * @brief Get_settings
+     * @return current parameters
+     */
+    [[nodiscard]] XYSettings Get_settings() const;
+
+    /**
+     * @brief Copy_intensity
+     * @param out row-major intensities from 0.0 to 1.0 (log scaled hits), first row is max Y
+     * @return true if histogram changed since last copy
+     */
+    bool Copy_intensity(std::vector<float> & out);
+
+    /**
+     * @brief Get_paired_points
+     * @return number of X/Y pairs accumulated since creation
+     */
+    [[nodiscard]] std::uint64_t Get_paired_points() const;
+
+    /**
+     * @brief Get_dropped_points
+     * @return number of samples dropped because other channel did not cover their time
+     */
+    [[nodiscard]] std::uint64_t Get_dropped_points() const;
+
+    /**
+     * @brief Clear
+     * @note clears histogram and not processed input
+     */
+    void Clear();
+
+    /**
+     * @brief Start
+     * @note starts execution of accumulator thread
+     */
+    void Start();
+
+    /**
+     * @brief Stop
+     * @note stops accumulation and decay, histogram is kept
+     */
+    void Stop();
+
+    /**
+     * @brief Resume
+     * @note resumes execution after Stop() was called
+     */
+    void Resume();
+
+    /**
+     * @brief Destroy
+     * @note destroys thread, after this new thread with Start() can be created
+     */
+    void Destroy();
+
+    ~XYAccumulator();
+private:
+    using clock = std::chrono::steady_clock;
+
+    XYSettings _settings;
+    //hit counts, guarded by _grid_mutex
+    DensityGrid _grid;
+    mutable std::mutex _grid_mutex;
+    clock::time_point _last_decay;
+
+    //input filled by Push_x() and Push_y(), moved to _x_work and _y_work by accumulator thread
+    std::vector<Timestamp> _x_input;
+    std::vector<Timestamp> _y_input;
+    std::mutex _input_mutex;
+    std::condition_variable _input_cv;
+
+    //owned by accumulator thread
+    std::vector<Timestamp> _x_block;
+    std::vector<Timestamp> _y_block;
+    std::vector<Timestamp> _x_work;     //samples of X not paired yet
+    std::vector<Timestamp> _y_work;     //samples of Y needed for interpolation
+    std::vector<double> _x_values;
+    std::vector<double> _y_values;
+    std::vector<std::int32_t> _bins;
+    std::atomic_bool _reset_work {false};
+
+    std::atomic_uint64_t _paired_points {0};
+    std::atomic_uint64_t _dropped_points {0};
+    std::thread _thread;
+
+    //states
+    std::atomic_bool _destroyed {true};
+    std::atomic_bool _destroy_flag {false};
+    std::atomic_bool _stop_flag {false};
+    std::atomic_bool _running {false};
+
+    /**
+     * @brief align
+     * @note pairs samples of X with Y interpolated at their time into _x_values and _y_values,
+     * paired samples are removed from work buffers
+     */
+    void align();
+
+    /**
+     * @brief accumulate
+     * @param settings parameters copied at begin of pass
+     * @note bins aligned pairs into histogram
+     */
+    void accumulate(const XYSettings & settings);
+
+    /**
+     * @brief decay
+     * @param now current time
+     * @note multiplies histogram by factor of time elapsed since last decay, needs _grid_mutex
+     */
+    void decay(clock::time_point now);
+
+    /**
+     * @brief running_loop
+     * @note loop in which input is accumulated
+     */
+    void running_loop(void);
+};
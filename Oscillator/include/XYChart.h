@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include "IChart.h"
+#include "IntensityTexture.h"
+#include "XYAccumulator.h"
+
+/**
+ * @class XYChart
+ * @brief Implementation of class IChart. It plots channel X (added by Add_data) against
+ * channel Y (added by Add_y_data). Pairs of samples are accumulated as point density by
+ * XYAccumulator in its own thread and chart only uploads histogram as a texture, so cost
+ * of a frame does not depend on sample rate.
+ * @note Zoom narrows voltage range of both channels, chart has no time axis to pan.
+ */
+class XYChart final: public IChart
+{
+public:
+/**
+ * @brief constructor with parameters
+ * @param data is data of channel X that will be passed as charts default data
+ * @param width is the width of the drawing area
+ * @param height is the height of the drawing area
+ * @param origin is the position of left bottom corner of a chart.
+ * @param min_value is min value of both axes.
+ * @param max_value is max value of both axes.
+ * @param settings parameters of accumulation, ranges are taken from min_value and max_value.
+ */
+XYChart(std::span<const Timestamp> data, float width, float height, sf::Vector2f origin = sf::Vector2f(0., 0.), float min_value = -2.5, float max_value = 2.5, const XYSettings & settings = XYSettings());
+/**
+ * @brief passes data of channel X to accumulator.
+ * @param new_timestamps new data that will be added to current data.
+ */
+void Add_data(std::span<const Timestamp> new_timestamps) override;
+/**
+ * @brief passes data of channel Y to accumulator.
+ * @param new_timestamps new data that will be added to current data.
+ */
+void Add_y_data(std::span<const Timestamp> new_timestamps);
+/**
+ * @brief draws point density of X/Y pairs as a texture.
+ * @param target is an object for drawing. Probably window.
+ */
+void Draw(sf::RenderTarget& target) override;
+/**
+ * @brief clears accumulated pairs and sets given data of channel X.
+ * @param data is the data that will be set.
+ */
+void Set_data(std::vector<Timestamp> data) override;
+/**
+ * @brief Checks if given cursor position is within the bonds of chart's drawing space.
+ * @param target is an object for drawing. Probably window.
+ */
+bool Is_cursor_on_chart(sf::RenderTarget& target) const override;
+/**
+ * @brief clears accumulated pairs.
+ */
+void Reset_data() override;
+/**
+ * @brief XY view shows only live data, archive is not used.
+ * @param archive is the archive with whole recorded history, can be nullptr.
+ */
+void Set_archive(std::shared_ptr<const HistoryArchive> archive) override;
+[[nodiscard]] sf::Vector2i Get_cursor() const override;
+[[nodiscard]] float Get_width() const override;
+[[nodiscard]] float Get_height() const override;
+[[nodiscard]] float Get_zoom() const override;
+[[nodiscard]] float Get_scrolling() const override;
+[[nodiscard]] float Get_panning() const override;
+/**
+ * @brief XY chart has no time axis, returns 0.
+ */
+[[nodiscard]] float Get_time_span() const override;
+/**
+ * @brief number of X/Y pairs accumulated since creation.
+ */
+[[nodiscard]] std::uint64_t Get_paired_points() const;
+void Set_cursor(sf::Vector2i postion) override;
+void Set_width(float new_width) override;
+void Set_height(float new_height) override;
+/**
+ * @brief sets zoom, voltage range of both channels is base range divided by zoom.
+ * @param new_zoom zoom from 1.0 to 16.0
+ */
+void Set_zoom(float new_zoom) override;
+void Set_origin(sf::Vector2f new_origin) override;
+/**
+ * @brief stops accumulation (histogram stays as it is) or resumes it.
+ * @param should_scroll false freezes histogram.
+ */
+void Set_scrolling(bool should_scroll) override;
+void Set_panning(bool should_pan) override;
+/**
+ * @brief Sets color of the most hit bins, palette goes from background through it to white.
+ * @param new_color a color to which chart will be set.
+ */
+void Set_color(sf::Color new_color) override;
+/**
+ * @brief XY chart has no time axis, pan is ignored.
+ */
+void Set_pan(float pan_value) override;
+private:
+XYAccumulator m_accumulator;
+float m_data_min;
+float m_data_max;
+float m_zoom;
+std::vector<float> m_intensity;
+IntensityTexture m_texture;
+};
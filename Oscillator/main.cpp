@@ -4,30 +4,86 @@
 #include <iostream>
 #include <sstream>
 #include <filesystem>
+#include <optional>
+#include <cstring>
+#include <deque>
+#include <iterator>
 
 //Projects includes
 #include "IReader.h"
 #include "FileReader.h"
 #include "IChart.h"
 #include "LineChart.h"
+#include "ImPlotChart.h"
+#include "PhosphorChart.h"
+#include "XYChart.h"
+#include "BlockQueue.h"
+#include "TaskPool.h"
+#include "SummaryPyramid.h"
+#include "RenderScheduler.h"
 #include "DummyGenerator.h"
+#include "HistoryArchive.h"
+#include "PipelineMetrics.h"
+#include "Tracer.h"
+#include "MetricsOverlay.h"
+#include "imgui.h"
+#include "imgui-SFML.h"
+#include "implot.h"
 
-int main()
+int main(int argc, char ** argv)
 {
 sf::RenderWindow window(sf::VideoMode({ 800, 600 }), "IUiBG", sf::Style::Titlebar | sf::Style::Close);
+if (!ImGui::SFML::Init(window))
+{
+    std::cerr << "ImGui not initialized!\n";
+}
+ImPlot::CreateContext();
+PipelineMetrics & metrics = PipelineMetrics::Instance();
+metrics.Set_thread_name("UI");
+//every TraceScope records when tracing is enabled, so it runs only on request: --trace or T key
+for (int i = 1; i < argc; i++)
+{
+    if (std::strcmp(argv[i], "--trace") == 0)
+    {
+        Tracer::Instance().Set_enabled(true);
+    }
+}
+MetricsOverlay overlay;
+sf::Clock imgui_clock;
 Dummy::FuncIterator func = Dummy::Create_Func(Dummy::FuncType::SIN, 1000, 5, 2);
 Dummy::Generator gen(func, 1000);
+//second channel, plotted against first one in XY mode
+Dummy::FuncIterator func_y = Dummy::Create_Func(Dummy::FuncType::SIN, 1000, 4, 2);
+Dummy::Generator gen_y(func_y, 1000, "tmp_y");
 
-std::unique_ptr<IReader> reader = std::make_unique<FileReader>();
+std::shared_ptr<HistoryArchive> archive = std::make_shared<HistoryArchive>("history.bin");
+//CPU heavy work of both channels shares one pool sized to cores
+std::shared_ptr<TaskPool> task_pool = std::make_shared<TaskPool>();
+std::unique_ptr<FileReader> file_reader = std::make_unique<FileReader>();
+file_reader->Set_archive(archive);
+file_reader->Set_task_pool(task_pool);
+std::unique_ptr<IReader> reader = std::move(file_reader);
+std::unique_ptr<FileReader> file_reader_y = std::make_unique<FileReader>("tmp_y");
+file_reader_y->Set_task_pool(task_pool);
+std::unique_ptr<IReader> reader_y = std::move(file_reader_y);
+//intervals kept by readers, also while frozen, UI buffers the same number of blocks meanwhile
+constexpr int history_seconds = 30;
+reader->Set_history_time_limit(history_seconds);
+reader_y->Set_history_time_limit(history_seconds);
+//readers queue every pushed interval, main loop takes all of them each frame
+std::shared_ptr<BlockQueue> block_queue = std::make_shared<BlockQueue>();
+std::shared_ptr<BlockQueue> block_queue_y = std::make_shared<BlockQueue>();
+reader->Set_block_queue(block_queue);
+reader_y->Set_block_queue(block_queue_y);
+//render summaries of first channel are built by pool while blocks arrive
+std::shared_ptr<SummaryPyramid> summary = std::make_shared<SummaryPyramid>(task_pool);
 gen.Start();
 reader->Start();
+gen_y.Start();
+reader_y->Start();
 
 std::this_thread::sleep_for(std::chrono::seconds(3));
 
-std::ofstream file("output");
-RecordingHistory test = reader->Get_data();
-RecordingHistory::iterator iter = test.Begin();
-
 sf::Font font;
 if (!font.openFromFile("../Oscillator/assets/Roboto-Light.ttf"))
 {
@@ -40,19 +96,70 @@ text.setFillColor(sf::Color::Red);
 text.setStyle(sf::Text::Bold);
 text.setPosition(sf::Vector2f(30.f, 30.f));
 
-    std::unique_ptr<IChart> chart = std::make_unique<LineChart>(reader->Get_data().Get_newest_recordingVector().Get_container(), 600.f, 400.f, sf::Vector2f(100.0, 100.0), -2.5f, 2.5f);
-    chart->Set_color(sf::Color(255, 128, 0));
+    //B switches between hand-rolled LineChart, ImPlotChart, PhosphorChart and XYChart backend
+    enum class ChartBackend { LINE, IMPLOT, PHOSPHOR, XY };
+    ChartBackend backend = ChartBackend::LINE;
+    //second channel is given to XY chart and to math trace of ImPlotChart
+    XYChart * xy_chart = nullptr;
+    ImPlotChart * implot_chart = nullptr;
+    //N cycles math trace A+B, A-B, A*B, dA/dt, integral A and hidden
+    std::optional<MathOperation> math_operation;
+    auto create_chart = [&](ChartBackend type) -> std::unique_ptr<IChart> {
+        std::unique_ptr<IChart> new_chart;
+        xy_chart = nullptr;
+        implot_chart = nullptr;
+        if(type == ChartBackend::XY){
+            auto new_xy_chart = std::make_unique<XYChart>(reader->Get_data().Get_newest_view(), 400.f, 400.f, sf::Vector2f(200.0, 100.0), -2.5f, 2.5f);
+            new_xy_chart->Add_y_data(reader_y->Get_data().Get_newest_view());
+            xy_chart = new_xy_chart.get();
+            new_chart = std::move(new_xy_chart);
+        } else if(type == ChartBackend::IMPLOT){
+            auto new_implot_chart = std::make_unique<ImPlotChart>(reader->Get_data().Get_newest_view(), 600.f, 400.f, sf::Vector2f(100.0, 100.0), -2.5f, 2.5f);
+            new_implot_chart->Add_channel_b_data(reader_y->Get_data().Get_newest_view());
+            if(math_operation){
+                new_implot_chart->Show_math(*math_operation);
+            }
+            new_implot_chart->Set_summary(summary);
+            implot_chart = new_implot_chart.get();
+            new_chart = std::move(new_implot_chart);
+        } else if(type == ChartBackend::PHOSPHOR){
+            new_chart = std::make_unique<PhosphorChart>(reader->Get_data().Get_newest_view(), 600.f, 400.f, sf::Vector2f(100.0, 100.0), -2.5f, 2.5f);
+        } else {
+            new_chart = std::make_unique<LineChart>(reader->Get_data().Get_newest_view(), 600.f, 400.f, sf::Vector2f(100.0, 100.0), -2.5f, 2.5f);
+        }
+        new_chart->Set_color(sf::Color(255, 128, 0));
+        new_chart->Set_archive(archive);
+        return new_chart;
+    };
+    std::unique_ptr<IChart> chart = create_chart(backend);
     float panning_speed = 0.05f;
+    //frames are drawn only when data, view, cursor or overlay changed, at most 60 per second
+    const std::chrono::milliseconds overlay_refresh(250);
+    RenderScheduler scheduler(60);
+    scheduler.Set_refresh_period(overlay.Is_visible() ? overlay_refresh : std::chrono::milliseconds(0));
+    //intervals taken from queues this frame
+    std::vector<BlockHandle> blocks;
+    std::vector<BlockHandle> blocks_y;
+    //newest intervals taken while frozen, the same ones history keeps in its backlog, given to chart on unfreeze
+    std::deque<BlockHandle> frozen_blocks;
+    std::deque<BlockHandle> frozen_blocks_y;
+    //frame is redrawn when more blocks are summarized, so coarse view refines
+    std::size_t summarized_blocks = 0;
     while (window.isOpen())
     {
-        window.clear(sf::Color(61, 53, 53));
-        if( (ReaderState::STOPPED != reader->Get_state()) && reader->Check_if_new_data_loaded()){
-            // std::cout << "New data loaded!\n";
-            chart->Add_data(reader->Get_data().Get_newest_recordingVector().Get_container());
-        }
-        while (const std::optional event = window.pollEvent())
+        //sleeps in waitEvent until next frame is due, or for idle time when nothing changes
+        const std::chrono::microseconds wait_time = scheduler.Get_wait_time();
+        std::optional<sf::Event> event = (wait_time.count() > 0) ? window.waitEvent(sf::microseconds(wait_time.count())) : window.pollEvent();
+        for (; event; event = window.pollEvent())
         {
+            ImGui::SFML::ProcessEvent(window, *event);
             if (event->is<sf::Event::Closed>()) window.close();
+            if (event->is<sf::Event::Resized>() || event->is<sf::Event::FocusGained>()){
+                scheduler.Mark_dirty(DirtyFlag::WINDOW);
+            }
+            if (event->is<sf::Event::MouseButtonPressed>() || event->is<sf::Event::MouseButtonReleased>()){
+                scheduler.Mark_dirty(DirtyFlag::OVERLAY);
+            }
             if (const auto* mouseWheelScrolled = event->getIf<sf::Event::MouseWheelScrolled>())
             {
                 if(1 == mouseWheelScrolled->delta){
@@ -60,16 +167,63 @@ text.setPosition(sf::Vector2f(30.f, 30.f));
                 } else if (-1 == mouseWheelScrolled->delta){
                     chart->Set_zoom(chart->Get_zoom()*0.98);
                 }
+                scheduler.Mark_dirty(DirtyFlag::VIEW);
             }
             if (const auto * keyPressed = event->getIf<sf::Event::KeyPressed>()){
+                scheduler.Mark_dirty(DirtyFlag::VIEW);
+                if(keyPressed->scancode == sf::Keyboard::Scancode::B){
+                    switch(backend){
+                        case ChartBackend::LINE: backend = ChartBackend::IMPLOT; break;
+                        case ChartBackend::IMPLOT: backend = ChartBackend::PHOSPHOR; break;
+                        case ChartBackend::PHOSPHOR: backend = ChartBackend::XY; break;
+                        case ChartBackend::XY: backend = ChartBackend::LINE; break;
+                    }
+                    chart = create_chart(backend);
+                }
+                if(keyPressed->scancode == sf::Keyboard::Scancode::N){
+                    if(!math_operation){
+                        math_operation = MathOperation::ADD;
+                    } else if(*math_operation == MathOperation::INTEGRAL){
+                        math_operation.reset();
+                    } else {
+                        math_operation = static_cast<MathOperation>(static_cast<int>(*math_operation) + 1);
+                    }
+                    if(implot_chart && math_operation){
+                        implot_chart->Show_math(*math_operation);
+                    } else if(implot_chart){
+                        implot_chart->Hide_math();
+                    }
+                }
+                if(keyPressed->scancode == sf::Keyboard::Scancode::M){
+                    overlay.Set_visible(!overlay.Is_visible());
+                    scheduler.Set_refresh_period(overlay.Is_visible() ? overlay_refresh : std::chrono::milliseconds(0));
+                }
+                //first press starts tracing, second one writes trace and stops it
+                if(keyPressed->scancode == sf::Keyboard::Scancode::T){
+                    if(!Tracer::Instance().Is_enabled()){
+                        Tracer::Instance().Set_enabled(true);
+                        std::cout << "Tracing started, press T again to write trace.json\n";
+                    } else {
+                        if(Tracer::Instance().Dump("trace.json")){
+                            std::cout << "Trace written to trace.json\n";
+                        }
+                        Tracer::Instance().Set_enabled(false);
+                    }
+                }
+                //freezes displayed data, acquisition continues and is spliced back on unfreeze
                 if(keyPressed->scancode == sf::Keyboard::Scancode::Space){
-                    if(ReaderState::STOPPED == reader->Get_state()){
-                        chart->Reset_data();
-                        reader->Resume();
+                    if(reader->Is_frozen()){
+                        reader->Unfreeze();
+                        reader_y->Unfreeze();
+                        blocks.insert(blocks.end(), frozen_blocks.begin(), frozen_blocks.end());
+                        blocks_y.insert(blocks_y.end(), frozen_blocks_y.begin(), frozen_blocks_y.end());
+                        frozen_blocks.clear();
+                        frozen_blocks_y.clear();
                         chart->Set_panning(false);
                         chart->Set_scrolling(true);
                     } else {
-                        reader->Stop();
+                        reader->Freeze();
+                        reader_y->Freeze();
                         chart->Set_panning(true);
                         chart->Set_scrolling(false);
                     }
@@ -83,20 +237,78 @@ text.setPosition(sf::Vector2f(30.f, 30.f));
             }
             if (const auto * mouseMoved = event->getIf<sf::Event::MouseMoved>()){
                 chart->Set_cursor(mouseMoved->position);
+                scheduler.Mark_dirty(DirtyFlag::CURSOR);
             }
-            if (!chart->Get_scrolling()){
-                reader->Stop();
+        }
+        //queues are drained also while frozen, so they never overrun and drop newest blocks
+        block_queue->Drain(blocks);
+        block_queue_y->Drain(blocks_y);
+        if (reader->Is_frozen()){
+            const auto keep_newest = [](std::vector<BlockHandle> & taken, std::deque<BlockHandle> & frozen){
+                frozen.insert(frozen.end(), std::make_move_iterator(taken.begin()), std::make_move_iterator(taken.end()));
+                taken.clear();
+                while (frozen.size() > static_cast<std::size_t>(history_seconds)){
+                    frozen.pop_front();
+                }
+            };
+            keep_newest(blocks, frozen_blocks);
+            keep_newest(blocks_y, frozen_blocks_y);
+        }
+        metrics.Set_gauge(PipelineGauge::QUEUE_DEPTH, block_queue->Get_size());
+        const SummaryProgress progress = summary->Get_progress();
+        metrics.Set_gauge(PipelineGauge::SUMMARY_PENDING, progress._blocks - progress._summarized);
+        if (progress._summarized != summarized_blocks){
+            summarized_blocks = progress._summarized;
+            scheduler.Mark_dirty(DirtyFlag::DATA);
+        }
+        if (!blocks.empty() || !blocks_y.empty()){
+            for (const BlockHandle & block : blocks){
+                chart->Add_data(block->Get_container());
+                summary->Add_block(block);
             }
+            for (const BlockHandle & block : blocks_y){
+                if (xy_chart){
+                    xy_chart->Add_y_data(block->Get_container());
+                }
+                if (implot_chart){
+                    implot_chart->Add_channel_b_data(block->Get_container());
+                }
+            }
+            blocks.clear();
+            blocks_y.clear();
+            scheduler.Mark_dirty(DirtyFlag::DATA);
+        }
+        if (chart->Get_scrolling()){
+            scheduler.Mark_dirty(DirtyFlag::VIEW);
         }
+        if (!window.isOpen() || !scheduler.Should_draw()){
+            continue;
+        }
+
+        const auto frame_start = std::chrono::steady_clock::now();
+        window.clear(sf::Color(61, 53, 53));
         std::ostringstream ss;
         ss << static_cast<float>(chart->Get_zoom());
         text.setString(ss.str());
+        ImGui::SFML::Update(window, imgui_clock.restart());
+        overlay.Draw();
         chart->Draw(window);
         window.draw(text);
+        ImGui::SFML::Render(window);
         window.display();
+        scheduler.Frame_drawn();
+        const auto frame_end = std::chrono::steady_clock::now();
+        metrics.Record(PipelineStage::FRAME, frame_end - frame_start);
+        if(Tracer::Instance().Is_enabled()){
+            Tracer::Instance().Record("frame", frame_start, frame_end);
+        }
+        metrics.Add(PipelineCounter::FRAMES);
 
     }
 
+ ImPlot::DestroyContext();
+ ImGui::SFML::Shutdown();
  gen.Destroy();
+ gen_y.Destroy();
  return 0;
 }
@@ -0,0 +1,247 @@
+#include "BlockCompression.h"
+#include <bit>
+
+namespace
+{
+
+/**
+ * @class BitWriter
+ * Appends values of any bit width to vector of 64 bit words.
+ */
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<std::uint64_t> & words) : _words(words) {}
+
+    void Write(std::uint64_t value, int bits)
+    {
+        if (bits == 0)
+        {
+            return;
+        }
+        if (bits < 64)
+        {
+            value &= (std::uint64_t(1) << bits) - 1;
+        }
+        const int used = _bit_count % 64;
+        if (used == 0)
+        {
+            _words.push_back(0);
+        }
+        const int free_bits = 64 - used;
+        if (bits <= free_bits)
+        {
+            _words.back() |= value << (free_bits - bits);
+        }
+        else
+        {
+            _words.back() |= value >> (bits - free_bits);
+            _words.push_back(value << (64 - (bits - free_bits)));
+        }
+        _bit_count += bits;
+    }
+private:
+    std::vector<std::uint64_t> & _words;
+    std::size_t _bit_count {0};
+};
+
+/**
+ * @class BitReader
+ * Reads values written by BitWriter in the same order.
+ */
+class BitReader
+{
+public:
+    explicit BitReader(const std::vector<std::uint64_t> & words) : _words(words) {}
+
+    std::uint64_t Read(int bits)
+    {
+        if (bits == 0)
+        {
+            return 0;
+        }
+        const std::size_t word = _bit_pos / 64;
+        const int used = _bit_pos % 64;
+        const int free_bits = 64 - used;
+        std::uint64_t value = 0;
+        if (bits <= free_bits)
+        {
+            value = _words[word] >> (free_bits - bits);
+        }
+        else
+        {
+            value = (_words[word] << (bits - free_bits)) | (_words[word + 1] >> (64 - (bits - free_bits)));
+        }
+        _bit_pos += bits;
+        return (bits < 64) ? value & ((std::uint64_t(1) << bits) - 1) : value;
+    }
+private:
+    const std::vector<std::uint64_t> & _words;
+    std::size_t _bit_pos {0};
+};
+
+std::uint64_t zigzag(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/**
+ * delta of delta buckets: prefix of 1s ended with 0 selects number of value bits,
+ * last bucket has no ending 0
+ */
+constexpr int dod_value_bits[] = {0, 7, 9, 12, 32, 64};
+constexpr int dod_buckets = sizeof(dod_value_bits) / sizeof(dod_value_bits[0]);
+
+void write_dod(BitWriter & writer, std::int64_t dod)
+{
+    const std::uint64_t value = zigzag(dod);
+    for (int b = 0; b < dod_buckets; b++)
+    {
+        const int bits = dod_value_bits[b];
+        if (b == dod_buckets - 1 || (bits < 64 && value < (std::uint64_t(1) << bits)) || (b == 0 && value == 0))
+        {
+            //prefix: b ones, then zero if not last bucket
+            writer.Write((std::uint64_t(1) << b) - 1, b);
+            if (b != dod_buckets - 1)
+            {
+                writer.Write(0, 1);
+            }
+            writer.Write(value, bits);
+            return;
+        }
+    }
+}
+
+std::int64_t read_dod(BitReader & reader)
+{
+    int b = 0;
+    while (b < dod_buckets - 1 && reader.Read(1) == 1)
+    {
+        b++;
+    }
+    return unzigzag(reader.Read(dod_value_bits[b]));
+}
+
+} //namespace
+
+/**
+ * @brief CompressedBlock constructor
+ * @param data timestamps to compress
+ */
+CompressedBlock::CompressedBlock(std::span<const Timestamp> data)
+    : _count(data.size())
+{
+    BitWriter writer(_bits);
+    std::uint64_t prev_time = 0;
+    //deltas of bit patterns wrap around, so any pair of times is encoded without overflow
+    std::uint64_t prev_delta = 0;
+    std::uint64_t prev_voltage = 0;
+    int prev_leading = -1;
+    int prev_trailing = 0;
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        const std::uint64_t time = std::bit_cast<std::uint64_t>(data[i].Get_time());
+        const std::uint64_t voltage = std::bit_cast<std::uint64_t>(data[i].Get_voltage());
+        if (i == 0)
+        {
+            writer.Write(time, 64);
+            writer.Write(voltage, 64);
+        }
+        else
+        {
+            const std::uint64_t delta = time - prev_time;
+            write_dod(writer, static_cast<std::int64_t>(delta - prev_delta));
+            prev_delta = delta;
+
+            const std::uint64_t xored = voltage ^ prev_voltage;
+            if (xored == 0)
+            {
+                writer.Write(0, 1);
+            }
+            else
+            {
+                const int leading = std::min(std::countl_zero(xored), 63);
+                const int trailing = std::countr_zero(xored);
+                if (prev_leading >= 0 && leading >= prev_leading && trailing >= prev_trailing)
+                {
+                    //meaningful bits fit in previous window
+                    writer.Write(0b10, 2);
+                    writer.Write(xored >> prev_trailing, 64 - prev_leading - prev_trailing);
+                }
+                else
+                {
+                    const int meaningful = 64 - leading - trailing;
+                    writer.Write(0b11, 2);
+                    writer.Write(leading, 6);
+                    writer.Write(meaningful - 1, 6);
+                    writer.Write(xored >> trailing, meaningful);
+                    prev_leading = leading;
+                    prev_trailing = trailing;
+                }
+            }
+        }
+        prev_time = time;
+        prev_voltage = voltage;
+    }
+}
+
+/**
+ * @brief Decompress
+ * @param out container to which decompressed timestamps are appended
+ */
+void CompressedBlock::Decompress(RecordingVector::type & out) const
+{
+    out.reserve(out.size() + _count);
+    BitReader reader(_bits);
+    std::uint64_t time = 0;
+    std::uint64_t delta = 0;
+    std::uint64_t voltage = 0;
+    int leading = 0;
+    int trailing = 0;
+    for (std::size_t i = 0; i < _count; i++)
+    {
+        if (i == 0)
+        {
+            time = reader.Read(64);
+            voltage = reader.Read(64);
+        }
+        else
+        {
+            delta += static_cast<std::uint64_t>(read_dod(reader));
+            time += delta;
+            if (reader.Read(1) == 1)
+            {
+                if (reader.Read(1) == 1)
+                {
+                    leading = reader.Read(6);
+                    trailing = 64 - leading - (static_cast<int>(reader.Read(6)) + 1);
+                }
+                voltage ^= reader.Read(64 - leading - trailing) << trailing;
+            }
+        }
+        out.emplace_back(std::bit_cast<double>(time), std::bit_cast<double>(voltage));
+    }
+}
+
+/**
+ * @brief Size
+ * @return number of compressed timestamps
+ */
+std::size_t CompressedBlock::Size() const
+{
+    return _count;
+}
+
+/**
+ * @brief Get_bytes
+ * @return number of bytes used by compressed data
+ */
+std::size_t CompressedBlock::Get_bytes() const
+{
+    return _bits.size() * sizeof(std::uint64_t);
+}
@@ -0,0 +1,110 @@
+#include "BlockPool.h"
+#include <bit>
+
+/**
+ * @brief BlockPool constructor
+ * @param upstream resource used when free list of size class is empty
+ */
+BlockPool::BlockPool(std::pmr::memory_resource * upstream)
+    : _upstream(upstream)
+{
+    //Empty
+}
+
+/**
+ * @brief Get_upstream_allocations
+ * @return how many times buffer was allocated from upstream resource
+ */
+std::size_t BlockPool::Get_upstream_allocations() const
+{
+    return _upstream_allocations;
+}
+
+/**
+ * @brief Get_cached_bytes
+ * @return bytes held on free lists
+ */
+std::size_t BlockPool::Get_cached_bytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cached_bytes;
+}
+
+/**
+ * @brief Release
+ * @note gives all buffers from free lists back to upstream resource
+ */
+void BlockPool::Release()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int c = 0; c < size_classes; c++)
+    {
+        while (_free_lists[c])
+        {
+            free_node * node = _free_lists[c];
+            _free_lists[c] = node->_next;
+            _upstream->deallocate(node, min_class_bytes << c, alignof(std::max_align_t));
+        }
+    }
+    _cached_bytes = 0;
+}
+
+/**
+ * @brief size_class
+ * @param bytes requested size
+ * @return index of size class, buffer of this class has min_class_bytes << index bytes
+ */
+int BlockPool::size_class(std::size_t bytes)
+{
+    if (bytes <= min_class_bytes)
+    {
+        return 0;
+    }
+    return std::bit_width((bytes - 1) / min_class_bytes);
+}
+
+void* BlockPool::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    const int c = size_class(bytes);
+    if (c >= size_classes || alignment > alignof(std::max_align_t))
+    {
+        _upstream_allocations++;
+        return _upstream->allocate(bytes, alignment);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (free_node * node = _free_lists[c])
+        {
+            _free_lists[c] = node->_next;
+            _cached_bytes -= min_class_bytes << c;
+            return node;
+        }
+    }
+    _upstream_allocations++;
+    return _upstream->allocate(min_class_bytes << c, alignof(std::max_align_t));
+}
+
+void BlockPool::do_deallocate(void * ptr, std::size_t bytes, std::size_t alignment)
+{
+    const int c = size_class(bytes);
+    if (c >= size_classes || alignment > alignof(std::max_align_t))
+    {
+        _upstream->deallocate(ptr, bytes, alignment);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    free_node * node = static_cast<free_node*>(ptr);
+    node->_next = _free_lists[c];
+    _free_lists[c] = node;
+    _cached_bytes += min_class_bytes << c;
+}
+
+bool BlockPool::do_is_equal(const std::pmr::memory_resource & other) const noexcept
+{
+    return this == &other;
+}
+
+BlockPool::~BlockPool()
+{
+    Release();
+}
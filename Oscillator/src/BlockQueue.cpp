@@ -0,0 +1,214 @@
+#include "BlockQueue.h"
+#include "PipelineMetrics.h"
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+/**
+ * @brief Make_block
+ * @param interval interval moved into block, its timestamps are not copied
+ * @param pool pool from which timestamps were allocated, block is allocated from it too and keeps it alive
+ * @return immutable block, reader pushes view of it (RecordingVector(block)) to history
+ */
+BlockHandle Make_block(RecordingVector && interval, const std::shared_ptr<BlockPool> & pool)
+{
+    return std::allocate_shared<RecordingVector>(PoolAllocator<RecordingVector>(pool), std::move(interval));
+}
+
+/**
+ * @brief BlockQueue constructor
+ * @param capacity maximal number of queued intervals, rounded up to power of two
+ * @param policy what producer does when queue is full
+ */
+BlockQueue::BlockQueue(std::size_t capacity, OverrunPolicy policy)
+    : _capacity(std::bit_ceil(std::max<std::size_t>(capacity, 2))), _mask(_capacity - 1), _policy(policy)
+{
+    _slots = std::make_unique<Slot[]>(_capacity);
+}
+
+/**
+ * @brief Push
+ * @param block interval to queue, it is shared (copied decimated with OverrunPolicy::DECIMATE)
+ * @return false if interval was dropped
+ * @note called only by producer
+ */
+bool BlockQueue::Push(BlockHandle block)
+{
+    if (Get_size() >= _capacity && !make_room())
+    {
+        drop();
+        return false;
+    }
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    const double load = static_cast<double>(tail - _head.load(std::memory_order_acquire)) / _capacity;
+    const int factor = (_policy == OverrunPolicy::DECIMATE) ? Get_decimation_factor(load) : 1;
+    if (factor > 1)
+    {
+        block = std::make_shared<const RecordingVector>(Decimate_interval(*block, factor));
+        _decimated.fetch_add(1, std::memory_order_relaxed);
+        PipelineMetrics::Instance().Add(PipelineCounter::INTERVALS_DECIMATED);
+    }
+    Slot & slot = _slots[tail & _mask];
+    //owner of interval previously queued in this slot took it, but may not have emptied slot yet
+    while (slot._occupied.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+    slot._block = std::move(block);
+    slot._occupied.store(true, std::memory_order_release);
+    _tail.store(tail + 1, std::memory_order_release);
+    const std::size_t size = tail + 1 - _head.load(std::memory_order_relaxed);
+    if (size > _high_water.load(std::memory_order_relaxed))
+    {
+        _high_water.store(size, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+/**
+ * @brief make_room
+ * @return true if queue is not full anymore, otherwise new interval has to be dropped
+ * @note waits or drops oldest interval according to policy
+ */
+bool BlockQueue::make_room()
+{
+    if (_policy == OverrunPolicy::BLOCK)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + block_timeout;
+        while (Get_size() >= _capacity && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return Get_size() < _capacity;
+    }
+    if (_policy == OverrunPolicy::DROP_OLDEST)
+    {
+        std::size_t head = _head.load(std::memory_order_acquire);
+        //if consumer took oldest interval meanwhile, there is room anyway
+        if (_head.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel))
+        {
+            Slot & slot = _slots[head & _mask];
+            slot._block.reset();
+            slot._occupied.store(false, std::memory_order_release);
+            drop();
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief drop
+ * @note counts dropped interval
+ */
+void BlockQueue::drop()
+{
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    PipelineMetrics::Instance().Add(PipelineCounter::BLOCKS_DROPPED);
+}
+
+/**
+ * @brief Try_pop
+ * @param out oldest queued interval
+ * @return false if queue is empty
+ * @note called only by consumer
+ */
+bool BlockQueue::Try_pop(BlockHandle & out)
+{
+    std::size_t head = _head.load(std::memory_order_acquire);
+    while (head != _tail.load(std::memory_order_acquire))
+    {
+        //fails if producer dropped this interval meanwhile, head is reloaded then
+        if (_head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            Slot & slot = _slots[head & _mask];
+            out = std::move(slot._block);
+            slot._occupied.store(false, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Drain
+ * @param out all queued intervals are appended to it in order
+ * @return number of appended intervals
+ * @note called only by consumer
+ */
+std::size_t BlockQueue::Drain(std::vector<BlockHandle> & out)
+{
+    std::size_t count = 0;
+    BlockHandle block;
+    while (Try_pop(block))
+    {
+        out.push_back(std::move(block));
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Get_policy
+ * @return what producer does when queue is full
+ */
+OverrunPolicy BlockQueue::Get_policy() const
+{
+    return _policy;
+}
+
+/**
+ * @brief Get_size
+ * @return number of queued intervals
+ */
+std::size_t BlockQueue::Get_size() const
+{
+    const std::size_t head = _head.load(std::memory_order_acquire);
+    const std::size_t tail = _tail.load(std::memory_order_acquire);
+    return (tail > head) ? tail - head : 0;
+}
+
+/**
+ * @brief Get_capacity
+ * @return maximal number of queued intervals
+ */
+std::size_t BlockQueue::Get_capacity() const
+{
+    return _capacity;
+}
+
+/**
+ * @brief Get_pushed
+ * @return number of intervals queued since construction
+ */
+std::uint64_t BlockQueue::Get_pushed() const
+{
+    return _tail.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Get_dropped
+ * @return number of intervals dropped because queue was full
+ */
+std::uint64_t BlockQueue::Get_dropped() const
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get_decimated
+ * @return number of intervals queued decimated
+ */
+std::uint64_t BlockQueue::Get_decimated() const
+{
+    return _decimated.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get_high_water
+ * @return largest number of queued intervals seen by producer
+ */
+std::size_t BlockQueue::Get_high_water() const
+{
+    return _high_water.load(std::memory_order_relaxed);
+}
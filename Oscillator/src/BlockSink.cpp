@@ -0,0 +1,239 @@
+#include "BlockSink.h"
+#include "TextCodec.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/********************************** FileSink ********************************/
+
+/**
+ * @brief FileSink constructor
+ * @param fname name of spool directory
+ * @param max_ahead maximal number of intervals not read by reader yet
+ */
+FileSink::FileSink(std::string_view fname, std::size_t max_ahead)
+    : _spool(fname), _max_ahead(std::max<std::size_t>(max_ahead, 1))
+{
+    //Empty
+}
+
+/**
+ * @brief Reset
+ * @note removes intervals left in spool directory by previous run
+ */
+void FileSink::Reset()
+{
+    _spool.Reset();
+}
+
+/**
+ * @brief Is_ready
+ * @return true if reader is less than max_ahead intervals behind
+ */
+bool FileSink::Is_ready()
+{
+    return _spool.Count_pending() < _max_ahead;
+}
+
+/**
+ * @brief Get_load
+ * @return number of intervals not read by reader yet divided by max_ahead
+ */
+double FileSink::Get_load()
+{
+    return std::min(1.0, static_cast<double>(_spool.Count_pending()) / _max_ahead);
+}
+
+/**
+ * @brief Skip_block
+ * @note sequence number of dropped interval is skipped, so reader records gap
+ */
+void FileSink::Skip_block()
+{
+    _spool.Skip();
+}
+
+/**
+ * @brief Drop_oldest
+ * @return true if oldest interval was removed before reader took it
+ */
+bool FileSink::Drop_oldest()
+{
+    return _spool.Drop_oldest();
+}
+
+/**
+ * @brief Write_block
+ * @param values voltages of one interval
+ * @param step time between two samples, time of first sample is 0
+ * @param last_time time of last sample, decimated interval keeps its last sample off step
+ * @return true if interval was published
+ * @note whole interval is encoded into reused buffer and written at once
+ */
+bool FileSink::Write_block(std::span<const double> values, double step, double last_time)
+{
+    _text.clear();
+    TextCodec::Encode_interval(values, step, last_time, _text);
+    return _spool.Publish(_text);
+}
+
+/********************************** SocketSink ********************************/
+
+/**
+ * @brief SocketSink constructor
+ * @param path path of socket on which SocketReader listens
+ */
+SocketSink::SocketSink(std::string_view path)
+    : _path(path)
+{
+    //Empty
+}
+
+/**
+ * @brief Reset
+ * @note closes connection of previous run
+ */
+void SocketSink::Reset()
+{
+    close_socket();
+    _sequence = 0;
+}
+
+/**
+ * @brief Is_ready
+ * @return true if connection to reader is open, it is opened if needed
+ */
+bool SocketSink::Is_ready()
+{
+    if (_socket >= 0)
+    {
+        return true;
+    }
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (_path.size() >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+    std::memcpy(address.sun_path, _path.c_str(), _path.size() + 1);
+    _socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_socket < 0)
+    {
+        return false;
+    }
+    if (::connect(_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        //reader does not listen yet
+        close_socket();
+        return false;
+    }
+    //stopped reader must not block generator forever, frame cut by timeout closes connection
+    const timeval send_timeout {1, 0};
+    ::setsockopt(_socket, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+    return true;
+}
+
+/**
+ * @brief Get_load
+ * @return part of send buffer taken by frames which reader did not receive yet
+ */
+double SocketSink::Get_load()
+{
+    int queued = 0;
+    int buffer_size = 0;
+    socklen_t option_size = sizeof(buffer_size);
+    if (_socket < 0 || ::ioctl(_socket, SIOCOUTQ, &queued) != 0
+        || ::getsockopt(_socket, SOL_SOCKET, SO_SNDBUF, &buffer_size, &option_size) != 0 || buffer_size <= 0)
+    {
+        return 0.0;
+    }
+    return std::min(1.0, static_cast<double>(queued) / buffer_size);
+}
+
+/**
+ * @brief Skip_block
+ * @note sequence number of dropped interval is skipped, so reader records gap
+ */
+void SocketSink::Skip_block()
+{
+    _sequence++;
+}
+
+/**
+ * @brief Drop_oldest
+ * @return false, frames already sent can't be taken back
+ */
+bool SocketSink::Drop_oldest()
+{
+    return false;
+}
+
+/**
+ * @brief Write_block
+ * @param values voltages of one interval
+ * @param step time between two samples, time of first sample is 0
+ * @param last_time time of last sample, decimated interval keeps its last sample off step
+ * @return true if whole frame was sent
+ * @note frame is built in reused buffer and sent with one call in most cases,
+ * send blocks (at most 1 s) while reader does not keep up
+ */
+bool SocketSink::Write_block(std::span<const double> values, double step, double last_time)
+{
+    if (!Is_ready())
+    {
+        return false;
+    }
+    const SampleFrameHeader header {sample_frame_magic, static_cast<std::uint32_t>(values.size()), _sequence++};
+    _frame.resize(sizeof(header) + values.size() * sample_frame_point_size);
+    char * position = _frame.data();
+    std::memcpy(position, &header, sizeof(header));
+    position += sizeof(header);
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        const double point[2] = {(i + 1 < values.size()) ? step * i : last_time, values[i]};
+        std::memcpy(position, point, sample_frame_point_size);
+        position += sample_frame_point_size;
+    }
+    std::size_t sent = 0;
+    while (sent < _frame.size())
+    {
+        //reader which closed connection must not kill process with SIGPIPE
+        const ssize_t result = ::send(_socket, _frame.data() + sent, _frame.size() - sent, MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            close_socket();
+            return false;
+        }
+        sent += static_cast<std::size_t>(result);
+    }
+    return true;
+}
+
+/**
+ * @brief close_socket
+ * @note closes connection, next Is_ready() connects again
+ */
+void SocketSink::close_socket()
+{
+    if (_socket >= 0)
+    {
+        ::close(_socket);
+        _socket = -1;
+    }
+}
+
+SocketSink::~SocketSink()
+{
+    close_socket();
+}
@@ -0,0 +1,384 @@
+#include "CaptureIndex.h"
+#include "PipelineMetrics.h"
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+//footer is stored in native byte order, index is a cache of capture, not exchange format
+constexpr char footer_magic[8] = {'O', 'S', 'C', 'I', 'D', 'X', '0', '1'};
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief skip_line
+ * @return position after next line break, or end
+ */
+const char* skip_line(const char * position, const char * end)
+{
+    const void * line_break = std::memchr(position, '\n', end - position);
+    return (line_break != nullptr) ? static_cast<const char*>(line_break) + 1 : end;
+}
+}
+
+/**
+ * @brief CaptureIndex constructor
+ * @param fname path to capture file
+ * @throws runtime_error if file can't be opened or mapped
+ */
+CaptureIndex::CaptureIndex(const std::filesystem::path & fname)
+    : _fname(fname)
+{
+    const int fd = ::open(fname.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Can't open capture file " + fname.string());
+    }
+    struct stat status {};
+    if (::fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Can't open capture file " + fname.string());
+    }
+    _map_size = static_cast<std::size_t>(status.st_size);
+    if (_map_size > 0)
+    {
+        void * map = ::mmap(nullptr, _map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Can't map capture file " + fname.string());
+        }
+        //capture is scanned from begin to end
+        ::madvise(map, _map_size, MADV_SEQUENTIAL);
+        _text = static_cast<const char*>(map);
+    }
+    //mapping stays valid after descriptor is closed
+    ::close(fd);
+    _data_size = _map_size;
+    _has_footer = read_footer();
+    if (_has_footer || _data_size == 0)
+    {
+        _complete = true;
+        _scanned = _data_size;
+    }
+}
+
+/**
+ * @brief read_footer
+ * @return true if capture ends with valid footer, its entries are loaded then
+ */
+bool CaptureIndex::read_footer()
+{
+    if (_map_size < sizeof(CaptureFooter))
+    {
+        return false;
+    }
+    CaptureFooter footer {};
+    std::memcpy(&footer, _text + _map_size - sizeof(CaptureFooter), sizeof(CaptureFooter));
+    if (std::memcmp(footer._magic, footer_magic, sizeof(footer_magic)) != 0
+        || footer._entry_size != sizeof(CaptureEntry)
+        || footer._data_size > _map_size
+        || footer._entries > (_map_size - footer._data_size) / sizeof(CaptureEntry)
+        || footer._data_size + footer._entries * sizeof(CaptureEntry) + sizeof(CaptureFooter) != _map_size)
+    {
+        return false;
+    }
+    std::vector<CaptureEntry> entries(footer._entries);
+    std::memcpy(entries.data(), _text + footer._data_size, entries.size() * sizeof(CaptureEntry));
+    for (const CaptureEntry & entry : entries)
+    {
+        if (entry._offset > footer._data_size || entry._length > footer._data_size - entry._offset)
+        {
+            return false;
+        }
+    }
+    _entries = std::move(entries);
+    _data_size = footer._data_size;
+    return true;
+}
+
+/**
+ * @brief Get_entry
+ * @param i index of interval
+ * @param out found interval
+ * @return false if capture has less intervals
+ * @note scans capture up to interval if it was not indexed yet
+ */
+bool CaptureIndex::Get_entry(std::size_t i, CaptureEntry & out)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (i < _entries.size())
+        {
+            out = _entries[i];
+            return true;
+        }
+    }
+    std::lock_guard<std::mutex> scan_lock(_scan_mutex);
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (i < _entries.size())
+            {
+                out = _entries[i];
+                return true;
+            }
+        }
+        if (!scan_next())
+        {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Get_text
+ * @param entry interval of this capture
+ * @return lines of interval, they stay valid while index exists
+ */
+std::string_view CaptureIndex::Get_text(const CaptureEntry & entry) const
+{
+    return std::string_view(_text + entry._offset, entry._length);
+}
+
+/**
+ * @brief Index_more
+ * @param entries max number of intervals to scan
+ * @return number of intervals indexed by this call
+ */
+std::size_t CaptureIndex::Index_more(std::size_t entries)
+{
+    std::size_t indexed = 0;
+    //lock is taken for every interval, so reader waiting in Get_entry() is not held up by whole batch
+    while (indexed < entries && !_complete)
+    {
+        std::lock_guard<std::mutex> scan_lock(_scan_mutex);
+        if (!scan_next())
+        {
+            break;
+        }
+        indexed++;
+    }
+    return indexed;
+}
+
+/**
+ * @brief Index_in_background
+ * @param index index to complete
+ * @param pool pool which runs scanning tasks with priority of PipelineStage::INDEX
+ * @note scanning stops when index is complete, cancelled or destroyed
+ */
+void CaptureIndex::Index_in_background(const std::shared_ptr<CaptureIndex> & index, TaskPool & pool)
+{
+    if (index->_complete || index->_cancelled)
+    {
+        return;
+    }
+    //task doesn't keep index alive, so nothing is scanned after its owner released it
+    pool.Submit(PipelineStage::INDEX, [weak = std::weak_ptr<CaptureIndex>(index), pool = &pool] {
+        const std::shared_ptr<CaptureIndex> index = weak.lock();
+        if (!index || index->_cancelled)
+        {
+            return;
+        }
+        {
+            ScopedStageTimer timer(PipelineStage::INDEX);
+            index->Index_more(background_entries);
+        }
+        if (index->_cancelled)
+        {
+            //Cancel() called while batch was scanned, nothing is resubmitted
+            return;
+        }
+        //next batch is new task, so tasks of higher priority submitted meanwhile run first
+        Index_in_background(index, *pool);
+    });
+}
+
+/**
+ * @brief Cancel
+ * @note background scanning stops after its current task, Get_entry() still works
+ */
+void CaptureIndex::Cancel()
+{
+    _cancelled = true;
+}
+
+/**
+ * @brief Is_complete
+ * @return true if whole capture is indexed
+ */
+bool CaptureIndex::Is_complete() const
+{
+    return _complete;
+}
+
+/**
+ * @brief Has_footer
+ * @return true if index was read from footer of capture
+ */
+bool CaptureIndex::Has_footer() const
+{
+    return _has_footer;
+}
+
+/**
+ * @brief Get_entry_count
+ * @return number of intervals indexed so far
+ */
+std::size_t CaptureIndex::Get_entry_count() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+/**
+ * @brief Get_progress
+ * @return indexed part of capture text, from 0.0 to 1.0
+ */
+double CaptureIndex::Get_progress() const
+{
+    if (_complete || _data_size == 0)
+    {
+        return 1.0;
+    }
+    return static_cast<double>(_scanned.load(std::memory_order_relaxed)) / _data_size;
+}
+
+/**
+ * @brief scan_next
+ * @return false if whole capture is indexed and there is no next interval
+ * @note _scan_mutex has to be locked. Lines are tokenized the same way as TextCodec decodes them,
+ * so interval decoded from Get_text() has exactly scanned points. Interval ends after interval_time
+ * or where time of capture goes back (capture is concatenation of Generator files), timestamps
+ * after it are shifted to follow previous interval, the same way as FileReader does.
+ */
+bool CaptureIndex::scan_next()
+{
+    if (_complete)
+    {
+        return false;
+    }
+    const char * position = _text + _position;
+    const char * const end = _text + _data_size;
+    CaptureEntry entry {};
+    const char * entry_end = position;
+    while (true)
+    {
+        while (position != end && is_space(*position))
+        {
+            position++;
+        }
+        if (position == end)
+        {
+            break;
+        }
+        const char * const line = position;
+        double time = 0.0;
+        const auto [time_end, time_error] = std::from_chars(position, end, time);
+        if (time_error != std::errc())
+        {
+            position = skip_line(position, end);
+            continue;
+        }
+        position = time_end;
+        while (position != end && (*position == ' ' || *position == '\t'))
+        {
+            position++;
+        }
+        double voltage = 0.0;
+        const auto [voltage_end, voltage_error] = std::from_chars(position, end, voltage);
+        if (voltage_error != std::errc())
+        {
+            position = skip_line(position, end);
+            continue;
+        }
+        const double offset = (time < _last_raw_time) ? _last_time : _offset;
+        const double shifted = time + offset;
+        if (entry._points > 0 && (offset != _offset || shifted >= entry._min_time + interval_time))
+        {
+            //line starts next interval
+            position = line;
+            break;
+        }
+        _offset = offset;
+        _last_raw_time = time;
+        _last_time = shifted;
+        if (entry._points == 0)
+        {
+            entry._offset = static_cast<std::uint64_t>(line - _text);
+            entry._time_offset = offset;
+            entry._min_time = shifted;
+        }
+        entry._max_time = shifted;
+        entry._points++;
+        position = voltage_end;
+        entry_end = position;
+    }
+    _position = static_cast<std::size_t>(position - _text);
+    _scanned.store(_position, std::memory_order_relaxed);
+    if (entry._points > 0)
+    {
+        entry._length = static_cast<std::uint64_t>(entry_end - _text) - entry._offset;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.push_back(entry);
+    }
+    if (position == end)
+    {
+        _complete = true;
+    }
+    return entry._points > 0;
+}
+
+/**
+ * @brief Write_footer
+ * @return true if index was appended to capture file
+ * @note whole capture has to be indexed, capture with footer is not changed
+ */
+bool CaptureIndex::Write_footer()
+{
+    if (!_complete || _has_footer)
+    {
+        return false;
+    }
+    //capture changed since it was mapped, index doesn't describe it
+    std::error_code ec;
+    if (std::filesystem::file_size(_fname, ec) != _map_size || ec)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    CaptureFooter footer {};
+    std::memcpy(footer._magic, footer_magic, sizeof(footer_magic));
+    footer._entries = _entries.size();
+    footer._data_size = _data_size;
+    footer._entry_size = sizeof(CaptureEntry);
+    std::ofstream file(_fname, std::ios::binary | std::ios::app);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(_entries.data()), static_cast<std::streamsize>(_entries.size() * sizeof(CaptureEntry)));
+    file.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+    return file.good();
+}
+
+CaptureIndex::~CaptureIndex()
+{
+    if (_text != nullptr)
+    {
+        ::munmap(const_cast<char*>(_text), _map_size);
+    }
+}
@@ -0,0 +1,110 @@
+#include "DensityGrid.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief DensityGrid constructor
+ * @param columns number of horizontal bins
+ * @param rows number of vertical bins
+ */
+DensityGrid::DensityGrid(int columns, int rows)
+    : _hits(static_cast<std::size_t>(columns) * rows, 0.0f), _columns(columns), _rows(rows)
+{
+    //Empty
+}
+
+/**
+ * @brief Resize
+ * @param columns number of horizontal bins
+ * @param rows number of vertical bins
+ * @note histogram is cleared
+ */
+void DensityGrid::Resize(int columns, int rows)
+{
+    _columns = columns;
+    _rows = rows;
+    _hits.assign(static_cast<std::size_t>(columns) * rows, 0.0f);
+    _changed = true;
+}
+
+/**
+ * @brief Clear
+ * @note sets all bins to zero
+ */
+void DensityGrid::Clear()
+{
+    std::fill(_hits.begin(), _hits.end(), 0.0f);
+    _changed = true;
+}
+
+/**
+ * @brief Add_hits
+ * @param bins indexes of hit bins, negative indexes are skipped
+ */
+void DensityGrid::Add_hits(std::span<const std::int32_t> bins)
+{
+    float * hits = _hits.data();
+    for (const std::int32_t bin : bins)
+    {
+        if (bin >= 0)
+        {
+            hits[bin] += 1.0f;
+        }
+    }
+    _changed = true;
+}
+
+/**
+ * @brief Decay
+ * @param elapsed seconds since last decay
+ * @param half_life seconds after which hits lose half of intensity, 0 means no decay
+ */
+void DensityGrid::Decay(double elapsed, double half_life)
+{
+    if (half_life <= 0.0 || elapsed <= 0.0)
+    {
+        //infinite persistence
+        return;
+    }
+    const float factor = static_cast<float>(std::exp2(-elapsed / half_life));
+    for (float & hits : _hits)
+    {
+        hits *= factor;
+    }
+    _changed = true;
+}
+
+/**
+ * @brief Copy_intensity
+ * @param out row-major intensities from 0.0 to 1.0 (log scaled hits)
+ * @return true if histogram changed since last copy
+ */
+bool DensityGrid::Copy_intensity(std::vector<float> & out)
+{
+    const bool changed = _changed;
+    _changed = false;
+    out.resize(_hits.size());
+    const float max_hits = _hits.empty() ? 0.0f : *std::max_element(_hits.begin(), _hits.end());
+    if (max_hits <= 0.0f)
+    {
+        std::fill(out.begin(), out.end(), 0.0f);
+        return changed;
+    }
+    //log scale keeps rarely hit bins visible next to bins hit by every sweep
+    const float scale = 1.0f / std::log1p(max_hits);
+    for (std::size_t i = 0; i < _hits.size(); i++)
+    {
+        out[i] = std::log1p(_hits[i]) * scale;
+    }
+    return changed;
+}
+
+int DensityGrid::Get_columns() const
+{
+    return _columns;
+}
+
+int DensityGrid::Get_rows() const
+{
+    return _rows;
+}
@@ -1,4 +1,6 @@
 #include "DummyGenerator.h"
+#include "PipelineMetrics.h"
+#include "TextCodec.h"
 #include <chrono>
 #include <filesystem>
 #include <memory>
@@ -7,7 +9,19 @@
 using namespace Dummy;
 
 Generator::Generator(Dummy::FuncIterator & func, int resolution, const std::string_view & tmp_fname)
-    : _func_iter(func), _resolution(resolution), _fname(tmp_fname), _thread()
+    : Generator(func, resolution, std::make_unique<FileSink>(tmp_fname))
+{
+    //Empty
+}
+
+/**
+ * @brief Generator constructor
+ * @param func generated signal
+ * @param resolution time points per second
+ * @param sink transport to which intervals are written
+ */
+Generator::Generator(Dummy::FuncIterator & func, int resolution, std::unique_ptr<IBlockSink> sink)
+    : _thread(), _func_iter(func), _resolution(resolution), _sink(std::move(sink))
 {
     _destroyed  = false;
     _destroy_flag = false;
@@ -23,51 +37,125 @@ void Generator::running_loop(void)
 {
     if (!_running)
     {
-        if (std::filesystem::exists(_fname))
-        {
-            std::filesystem::remove(_fname);
-        }
+        _sink->Reset();
         const std::chrono::duration sleep_time_running = std::chrono::seconds(1);
         const std::chrono::duration sleep_time_stopped = std::chrono::milliseconds(100);
+        PipelineMetrics::Instance().Set_thread_name("Generator");
         _running = true;
         _destroyed = false;
         while (!_destroy_flag)
         {
-            if (!std::filesystem::exists(_fname))
+            if (_stop_flag)
+            {
+                std::this_thread::sleep_for(sleep_time_stopped);
+                continue;
+            }
+            const double load = _sink->Get_load();
+            //sink without reader waits always, full sink only with blocking policy
+            if (!_sink->Is_ready() && (load < 1.0 || _policy == OverrunPolicy::BLOCK))
             {
-                if (_stop_flag)
-                {
-                    std::this_thread::sleep_for(sleep_time_stopped);
-                }
-                else
-                {
-                    _ofile.open(_fname);
-                    if (_ofile.is_open())
-                    {
-                        const double interval_sec = 1.0; // 1 second
-                        const double step = interval_sec / _resolution;
-                        for (int i = 0; i < _resolution; i++)
-                        {
-                            if (i == _resolution - 1)
-                            {
-                                _ofile << step * i << " " << ++_func_iter;
-                            }
-                            else
-                            {
-                                _ofile << step * i << " " << ++_func_iter << '\n';
-                            }
-                        }
-                        _ofile.close();
-                    }
-                    std::this_thread::sleep_for(sleep_time_running);
-                }
+                std::this_thread::sleep_for(sleep_time_stopped);
+                continue;
             }
+            {
+                TraceScope trace("Generator::write_block");
+                generate();
+                write_block(load);
+            }
+            std::this_thread::sleep_for(sleep_time_running);
         }
         _running = false;
         _destroyed = true;
     }
 }
 
+/**
+ * @brief generate
+ * @note fills _values with next interval of signal
+ */
+void Generator::generate()
+{
+    ScopedStageTimer timer(PipelineStage::GENERATE);
+    _values.resize(_resolution);
+    for (double & value : _values)
+    {
+        value = ++_func_iter;
+    }
+}
+
+/**
+ * @brief write_block
+ * @param load load of sink before interval was generated
+ * @note writes _values to sink, dropped or decimated according to overrun policy
+ */
+void Generator::write_block(double load)
+{
+    ScopedStageTimer timer(PipelineStage::WRITE);
+    PipelineMetrics & metrics = PipelineMetrics::Instance();
+    const OverrunPolicy policy = _policy;
+    if (load >= 1.0 && policy != OverrunPolicy::BLOCK)
+    {
+        //sink which can't drop what it already has drops new interval
+        if (policy != OverrunPolicy::DROP_OLDEST || !_sink->Drop_oldest())
+        {
+            _sink->Skip_block();
+            metrics.Add(PipelineCounter::INTERVALS_OVERRUN);
+            return;
+        }
+        metrics.Add(PipelineCounter::INTERVALS_OVERRUN);
+    }
+    const int factor = (policy == OverrunPolicy::DECIMATE) ? Get_decimation_factor(load) : 1;
+    std::span<const double> values = _values;
+    if (factor > 1)
+    {
+        Decimate_values(_values, factor, _decimated);
+        values = _decimated;
+        metrics.Add(PipelineCounter::INTERVALS_DECIMATED);
+    }
+    //decimated interval ends at the same time as whole one
+    const double last_time = static_cast<double>(_resolution - 1) / _resolution;
+    if (_sink->Write_block(values, static_cast<double>(factor) / _resolution, last_time))
+    {
+        metrics.Add(PipelineCounter::POINTS_GENERATED, _resolution);
+    }
+}
+
+/**
+ * @brief Set_overrun_policy
+ * @param policy what Generator does when sink is full, OverrunPolicy::BLOCK by default
+ */
+void Generator::Set_overrun_policy(OverrunPolicy policy)
+{
+    _policy = policy;
+}
+
+/**
+ * @brief Get_overrun_policy
+ * @return what Generator does when sink is full
+ */
+OverrunPolicy Generator::Get_overrun_policy() const
+{
+    return _policy;
+}
+
+/**
+ * @brief Write_interval
+ * @param out stream to which one interval (1 second) of "time voltage" lines is written
+ */
+void Generator::Write_interval(std::ostream & out)
+{
+    generate();
+    ScopedStageTimer timer(PipelineStage::WRITE);
+    const double interval_sec = 1.0; // 1 second
+    const double step = interval_sec / _resolution;
+    //whole interval is encoded into reused buffer and written at once
+    _text.clear();
+    TextCodec::Encode_interval(_values, step, step * (_resolution - 1), _text);
+    out.write(_text.data(), static_cast<std::streamsize>(_text.size()));
+    out.flush();
+    PipelineMetrics::Instance().Add(PipelineCounter::POINTS_GENERATED, _resolution);
+}
+
 /**
  * @brief Start
  * @note starts execution of Generator thread
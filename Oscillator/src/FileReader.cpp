@@ -1,8 +1,35 @@
 #include "FileReader.h"
+#include "PipelineMetrics.h"
+#include "TextCodec.h"
 #include <chrono>
 #include <filesystem>
 #include <memory>
 #include <iostream>
+#include <iterator>
+#include <optional>
+
+namespace
+{
+//intervals read and pushed together at most
+constexpr std::size_t max_batch_intervals = 16;
+
+/**
+ * @brief shift_time
+ * @param vec interval parsed from time 0
+ * @param start_time time added to its timestamps and time range
+ */
+void shift_time(RecordingVector & vec, double start_time)
+{
+    for (Timestamp & timestamp : vec.Get_container())
+    {
+        timestamp._data.first += start_time;
+    }
+    RangeParams params = vec.Get_recording_params();
+    params._time_range.first += start_time;
+    params._time_range.second += start_time;
+    vec.Set_recording_params(params);
+}
+}
 
 FileReader::FileReader(const std::string_view & fname, double start_time)
     : _fname(fname.data()), _start_time(start_time), _thread()
@@ -29,6 +56,39 @@ FileReader::FileReader(const std::string_view & fname, double start_time)
     return _data;
 }
 
+/**
+ * @brief Get_history_snapshot
+ * @return parameters and size of history, safe to call while Reader thread pushes
+ */
+HistorySnapshot FileReader::Get_history_snapshot() const
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    return HistorySnapshot {_data.Get_recording_params(), _data.Get_container().size()};
+}
+
+/**
+ * @brief Get_filtered_data
+ * @return RecordingHistory with intervals filtered by chain given to Set_filter()
+ * @throws runtime_error if no interval was filtered before
+ */
+[[nodiscard]] const RecordingHistory& FileReader::Get_filtered_data() const
+{
+    if (_filtered_data.Empty())
+    {
+        throw std::runtime_error("Empty data");
+    }
+    return _filtered_data;
+}
+
+/**
+ * @brief Get_filtered_points
+ * @return number of points output by filter chain since start, safe to call while Reader thread pushes
+ */
+std::uint64_t FileReader::Get_filtered_points() const
+{
+    return _filtered_points.load(std::memory_order_relaxed);
+}
+
 /**
  * @brief Get_state
  * @return state of the reader
@@ -44,14 +104,12 @@ FileReader::FileReader(const std::string_view & fname, double start_time)
  */
 [[nodiscard]] bool FileReader::Check_if_new_data_loaded()
 {
-    bool state_val = _new_data_loaded;
-    _new_data_loaded = false;
-    return state_val;
+    return _new_data_loaded.exchange(false);
 }
 
 /**
  * @brief Set_file
- * @param fname name of file to open
+ * @param fname name of spool directory
  * @return true if file successfully open
  */
 [[nodiscard]] bool FileReader::Set_file(const std::string_view & fname)
@@ -67,6 +125,254 @@ FileReader::FileReader(const std::string_view & fname, double start_time)
 void FileReader::Set_history_time_limit(int limit_in_sec)
 {
     _data.Set_history_time_limit(limit_in_sec);
+    _filtered_data.Set_history_time_limit(limit_in_sec);
+}
+
+/**
+ * @brief Set_history_compression
+ * @param enabled if true, older intervals of history are stored compressed
+ */
+void FileReader::Set_history_compression(bool enabled)
+{
+    _data.Set_compression(enabled);
+    _filtered_data.Set_compression(enabled);
+}
+
+/**
+ * @brief Freeze
+ * @note history returned by Get_data() stops changing, acquisition continues
+ * in background buffer
+ */
+void FileReader::Freeze()
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _data.Freeze();
+    _filtered_data.Freeze();
+}
+
+/**
+ * @brief Unfreeze
+ * @note intervals acquired while frozen are spliced into history
+ */
+void FileReader::Unfreeze()
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _filtered_data.Unfreeze();
+    if (_data.Unfreeze() > 0)
+    {
+        _new_data_loaded = true;
+    }
+}
+
+/**
+ * @brief Is_frozen
+ * @return true if history is frozen
+ */
+bool FileReader::Is_frozen() const
+{
+    return _data.Is_frozen();
+}
+
+/**
+ * @brief Set_block_queue
+ * @param queue queue to which every interval is added after it is pushed to history, can be nullptr
+ * @note has to be called before Start(), queue is filled also while history is frozen
+ */
+void FileReader::Set_block_queue(std::shared_ptr<BlockQueue> queue)
+{
+    _block_queue = std::move(queue);
+}
+
+/**
+ * @brief Set_archive
+ * @param archive archive to which every read interval is appended, can be nullptr
+ * @note archive is cleared on Resume(), because time starts again from 0
+ */
+void FileReader::Set_archive(std::shared_ptr<HistoryArchive> archive)
+{
+    _archive = std::move(archive);
+}
+
+/**
+ * @brief Set_filter
+ * @param filter chain run on every read interval before it is pushed, can be nullptr
+ * @note has to be called before Start(), raw intervals are still stored in Get_data()
+ */
+void FileReader::Set_filter(std::unique_ptr<FilterChain> filter)
+{
+    _filter = std::move(filter);
+}
+
+/**
+ * @brief Set_task_pool
+ * @param pool pool which parses intervals of batch in parallel, can be nullptr
+ * @note has to be called before Start(), without pool Reader thread parses all intervals
+ */
+void FileReader::Set_task_pool(std::shared_ptr<TaskPool> pool)
+{
+    _task_pool = std::move(pool);
+}
+
+/**
+ * @brief Parse_interval
+ * @param in stream with lines of "time voltage", it is read to its end and decoded by TextCodec
+ * @param start_time time added to every timestamp read
+ * @param resource memory resource from which timestamps are allocated
+ * @param expected_points number of timestamps reserved before reading
+ * @return interval with read timestamps and its parameters
+ */
+RecordingVector FileReader::Parse_interval(std::istream & in, double start_time,
+    std::pmr::memory_resource * resource, int expected_points)
+{
+    const std::string text(std::istreambuf_iterator<char>(in), {});
+    return TextCodec::Decode_interval(text, start_time, resource, expected_points);
+}
+
+/**
+ * @brief record_gap
+ * @param sequence sequence number of read interval
+ * @note if intervals before it were lost, their time is recorded as gap and skipped,
+ * _data_mutex has to be locked
+ */
+void FileReader::record_gap(std::uint64_t sequence)
+{
+    const std::uint64_t lost = _gap_detector.Check(sequence);
+    if (lost == 0)
+    {
+        return;
+    }
+    const HistoryGap gap {_start_time, _start_time + lost * _interval_span, lost};
+    _data.Record_gap(gap);
+    _start_time = gap._end_time;
+}
+
+/**
+ * @brief read_batch
+ * @return number of intervals pushed, intervals of _pending are read in order
+ * @note all intervals of batch are pushed under one lock of histories, batch read while
+ * Stop() was called is dropped
+ */
+std::size_t FileReader::read_batch()
+{
+    PipelineMetrics & metrics = PipelineMetrics::Instance();
+    _batch.clear();
+    _filtered_batch.clear();
+    _sequences.clear();
+    //files are read and removed in order, parsing waits until all are read
+    std::size_t count = 0;
+    for (const std::filesystem::path & block : _pending)
+    {
+        if (_texts.size() <= count)
+        {
+            _texts.emplace_back();
+        }
+        if (!_engine->Read_file(block, _texts[count]))
+        {
+            break;
+        }
+        std::error_code time_ec;
+        const auto written = std::filesystem::last_write_time(block, time_ec);
+        if (!time_ec)
+        {
+            metrics.Record(PipelineStage::DETECT, std::chrono::file_clock::now() - written);
+        }
+        /*if can't be removed it would be read again, so following
+        intervals wait for next batch to keep order */
+        std::error_code ec;
+        if (!std::filesystem::remove(block, ec))
+        {
+            if (ec)
+            {
+                break;
+            }
+            //dropped by FileSink on overrun meanwhile
+            continue;
+        }
+        std::uint64_t sequence = 0;
+        _sequences.push_back(SpoolQueue::Parse_sequence(block, sequence) ? std::optional(sequence) : std::nullopt);
+        count++;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+    /*intervals don't depend on each other when they are parsed from time 0,
+    every interval is one task, large interval is split into more tasks */
+    for (std::size_t i = 0; i < count; i++)
+    {
+        //buffer of last interval size comes from pool without reallocations
+        _batch.emplace_back(_pool.get());
+    }
+    {
+        TaskGroup group(_task_pool.get(), PipelineStage::PARSE);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            group.Run([this, i] {
+                ScopedStageTimer timer(PipelineStage::PARSE);
+                _batch[i] = TextCodec::Decode_interval(_texts[i], 0.0, _pool.get(), _expected_points, _task_pool.get());
+            });
+        }
+        group.Wait();
+    }
+    //filter state moves only with intervals which are really pushed
+    const bool filtering = _filter && !_filter->Empty();
+    {
+        //Stop() resets time base, gap detector, filter and histories under the same lock
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        if (_stop_flag)
+        {
+            //intervals read before Stop() would be pushed to cleared history
+            return 0;
+        }
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (_sequences[i])
+            {
+                record_gap(*_sequences[i]);
+            }
+            RecordingVector & vec = _batch[i];
+            shift_time(vec, _start_time);
+            const RangeParams params = vec.Get_recording_params();
+            metrics.Add(PipelineCounter::POINTS_PARSED, params.Get_max_index());
+            if (filtering)
+            {
+                ScopedStageTimer timer(PipelineStage::FILTER);
+                _filtered_batch.push_back(_filter->Process(vec, _pool.get()));
+            }
+            _expected_points = params.Get_max_index();
+            _interval_span = params.Get_max_time() - params.Get_min_time();
+            _start_time = params.Get_max_time();
+        }
+        ScopedStageTimer timer(PipelineStage::PUSH);
+        _blocks.clear();
+        for (RecordingVector & vec : _batch)
+        {
+            //history keeps view of the same block, so timestamps are not copied
+            _blocks.push_back(Make_block(std::move(vec), _pool));
+            _data.Push_recordingVector(RecordingVector(_blocks.back()));
+        }
+        for (RecordingVector & filtered : _filtered_batch)
+        {
+            _filtered_points.fetch_add(filtered.Get_recording_params().Get_max_index(), std::memory_order_relaxed);
+            _filtered_data.Push_recordingVector(std::move(filtered));
+        }
+    }
+    //archive and queue get blocks after history has them, so consumer never gets block missing in history
+    for (BlockHandle & block : _blocks)
+    {
+        if (_archive)
+        {
+            _archive->Append(*block);
+        }
+        if (_block_queue)
+        {
+            _block_queue->Push(std::move(block));
+        }
+    }
+    _blocks.clear();
+    metrics.Add(PipelineCounter::INTERVALS_PUSHED, _batch.size());
+    _new_data_loaded = true;
+    return _batch.size();
 }
 
 /**
@@ -77,78 +383,35 @@ void FileReader::running_loop(void)
 {
     if (!_running)
     {
-        const std::chrono::duration sleep_time_running = std::chrono::seconds(1);
+        const std::chrono::duration sleep_time_waiting = std::chrono::milliseconds(100);
         const std::chrono::duration sleep_time_stopped = std::chrono::milliseconds(100);
+        PipelineMetrics::Instance().Set_thread_name("FileReader");
+        if (!_engine)
+        {
+            _engine = Create_read_engine();
+        }
         _running = true;
         _destroyed = false;
         while (!_destroy_flag)
         {
-            if (std::filesystem::exists(_fname))
+            if (_stop_flag)
             {
-                if (_stop_flag)
-                {
-                    std::this_thread::sleep_for(sleep_time_stopped);
-                }
-                else
+                std::this_thread::sleep_for(sleep_time_stopped);
+                continue;
+            }
+            SpoolQueue(_fname).Get_pending(_pending, max_batch_intervals);
+            if (!_pending.empty())
+            {
+                TraceScope trace("FileReader::read_batch");
+                _state = ReaderState::READING;
+                if (read_batch() > 0)
                 {
-                    
-                    _file.open(_fname);
-                    if (_file.is_open())
-                    {
-                        _state = ReaderState::READING;
-                        //if file exist read data
-                        RecordingVector vec;
-                        double max_voltage = 0.0;
-                        double min_voltage = 0.0;
-                        double min_time = _start_time;
-                        double max_time = 0.0;
-                        int index = 0;
-                        while (!_file.eof())
-                        {
-                            double time = 0.0f;
-                            _file >> time;
-                            double voltage = 0.0f;
-                            _file >> voltage;
-                            if (voltage > max_voltage)
-                            {
-                                max_voltage = voltage;
-                            }
-                            time += _start_time;
-                            
-                            vec.Get_container().emplace_back(time, voltage);
-                            index++;
-                            max_time = time;
-                        }
-                        _file.close();
-                        //try to remove file
-                        std::error_code ec;
-                        std::filesystem::remove(_fname, ec);
-                        /*if can't be removed it's written by Generator, so
-                        try again later */
-                        if (!ec)
-                        {
-                            RangeParams params({min_voltage, max_voltage},
-                            {min_time, max_time}, index);
-                            vec.Set_recording_params(params);
-                            _data.Push_recordingVector(std::move(vec));
-                            _start_time = max_time;
-                            _new_data_loaded = true;
-                        }
-                        else
-                        {
-                            continue;
-                        }
-                        _state = ReaderState::WAITING;
-                        std::this_thread::sleep_for(sleep_time_running);
-                    }
-                    else
-                    {
-                        _state = ReaderState::WAITING;
-                        std::this_thread::sleep_for(sleep_time_stopped);
-                    }
+                    //more intervals may have been published meanwhile
+                    continue;
                 }
-                
             }
+            _state = ReaderState::WAITING;
+            std::this_thread::sleep_for(sleep_time_waiting);
         }
         _running = false;
         _destroyed = true;
@@ -170,9 +433,19 @@ void FileReader::Start()
  */
 void FileReader::Stop()
 {
-    _stop_flag = true;
-    _start_time = 0;
-    _data.Clear();
+    {
+        //batch being read is dropped under the same lock, see read_batch()
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        _stop_flag = true;
+        _start_time = 0;
+        _gap_detector.Reset();
+        _data.Clear();
+        _filtered_data.Clear();
+        if (_filter)
+        {
+            _filter->Reset();
+        }
+    }
     _state = ReaderState::STOPPED;
 }
 
@@ -182,6 +455,10 @@ void FileReader::Stop()
  */
 void FileReader::Resume()
 {
+    if (_archive)
+    {
+        _archive->Clear();
+    }
     _stop_flag = false;
     _state = ReaderState::WAITING;
 }
@@ -0,0 +1,451 @@
+#include "FilterChain.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief FirFilter constructor
+ * @param taps coefficients of filter, at least one
+ * @param decimation every n-th output is kept
+ */
+FirFilter::FirFilter(std::vector<double> taps, int decimation)
+    : _reversed_taps(taps.rbegin(), taps.rend()), _decimation(std::max(decimation, 1))
+{
+    if (_reversed_taps.empty())
+    {
+        _reversed_taps.push_back(1.0);
+    }
+    Reset();
+}
+
+/**
+ * @brief Low_pass
+ * @param cutoff cutoff frequency in Hz
+ * @param sample_rate sample rate of input in Hz
+ * @param taps number of taps, odd number gives symmetric filter
+ * @return Hamming windowed sinc coefficients with unity gain at DC
+ */
+std::vector<double> FirFilter::Low_pass(double cutoff, double sample_rate, int taps)
+{
+    taps = std::max(taps, 1);
+    std::vector<double> coefficients(taps);
+    const double fc = cutoff / sample_rate;
+    const double middle = (taps - 1) / 2.0;
+    double sum = 0.0;
+    for (int i = 0; i < taps; i++)
+    {
+        const double x = i - middle;
+        const double sinc = (x == 0.0) ? 2.0 * fc : std::sin(2.0 * std::numbers::pi * fc * x) / (std::numbers::pi * x);
+        const double window = (taps > 1) ? 0.54 - 0.46 * std::cos(2.0 * std::numbers::pi * i / (taps - 1)) : 1.0;
+        coefficients[i] = sinc * window;
+        sum += coefficients[i];
+    }
+    for (double & coefficient : coefficients)
+    {
+        coefficient /= sum;
+    }
+    return coefficients;
+}
+
+/**
+ * @brief Band_pass
+ * @param low lower cutoff frequency in Hz
+ * @param high upper cutoff frequency in Hz
+ * @param sample_rate sample rate of input in Hz
+ * @param taps number of taps, odd number gives symmetric filter
+ * @return difference of two low pass filters
+ */
+std::vector<double> FirFilter::Band_pass(double low, double high, double sample_rate, int taps)
+{
+    std::vector<double> coefficients = Low_pass(high, sample_rate, taps);
+    const std::vector<double> lower = Low_pass(low, sample_rate, taps);
+    for (std::size_t i = 0; i < coefficients.size(); i++)
+    {
+        coefficients[i] -= lower[i];
+    }
+    return coefficients;
+}
+
+void FirFilter::Process(std::span<const Timestamp> in, std::vector<Timestamp> & out)
+{
+    const std::size_t taps = _reversed_taps.size();
+    const std::size_t history = taps - 1;
+    const std::size_t count = in.size();
+    _window.resize(history + count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        _window[history + i] = in[i].Get_voltage();
+    }
+    const std::size_t decimation = _decimation;
+    const std::size_t outputs = (count > _phase) ? (count - _phase + decimation - 1) / decimation : 0;
+    _sums.assign(outputs, 0.0);
+    double * sums = _sums.data();
+    for (std::size_t k = 0; k < taps; k++)
+    {
+        //output j uses window[phase + j * decimation .. + taps), independent over j
+        const double coefficient = _reversed_taps[k];
+        const double * samples = _window.data() + _phase + k;
+        for (std::size_t j = 0; j < outputs; j++)
+        {
+            sums[j] += coefficient * samples[j * decimation];
+        }
+    }
+    for (std::size_t j = 0; j < outputs; j++)
+    {
+        out.emplace_back(in[_phase + j * decimation].Get_time(), sums[j]);
+    }
+    _phase = _phase + outputs * decimation - count;
+    //newest voltages are history of next block
+    _window.erase(_window.begin(), _window.end() - history);
+}
+
+void FirFilter::Reset()
+{
+    _phase = 0;
+    _window.assign(_reversed_taps.size() - 1, 0.0);
+}
+
+/**
+ * @brief BiquadFilter constructor
+ * @param type response of filter
+ * @param frequency cutoff (or center for band pass) frequency in Hz
+ * @param sample_rate sample rate of input in Hz
+ * @param q quality factor, 0.707 gives flat low pass
+ */
+BiquadFilter::BiquadFilter(BiquadType type, double frequency, double sample_rate, double q)
+{
+    const double w0 = 2.0 * std::numbers::pi * frequency / sample_rate;
+    const double cos_w0 = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    switch (type)
+    {
+        case BiquadType::LOW_PASS:
+            _b0 = (1.0 - cos_w0) / 2.0;
+            _b1 = 1.0 - cos_w0;
+            _b2 = (1.0 - cos_w0) / 2.0;
+            break;
+        case BiquadType::HIGH_PASS:
+            _b0 = (1.0 + cos_w0) / 2.0;
+            _b1 = -(1.0 + cos_w0);
+            _b2 = (1.0 + cos_w0) / 2.0;
+            break;
+        case BiquadType::BAND_PASS:
+            //0 dB gain at center frequency
+            _b0 = alpha;
+            _b1 = 0.0;
+            _b2 = -alpha;
+            break;
+    }
+    _b0 /= a0;
+    _b1 /= a0;
+    _b2 /= a0;
+    _a1 = -2.0 * cos_w0 / a0;
+    _a2 = (1.0 - alpha) / a0;
+}
+
+void BiquadFilter::Process(std::span<const Timestamp> in, std::vector<Timestamp> & out)
+{
+    double z1 = _z1;
+    double z2 = _z2;
+    for (const Timestamp & sample : in)
+    {
+        const double x = sample.Get_voltage();
+        const double y = _b0 * x + z1;
+        z1 = _b1 * x - _a1 * y + z2;
+        z2 = _b2 * x - _a2 * y;
+        out.emplace_back(sample.Get_time(), y);
+    }
+    _z1 = z1;
+    _z2 = z2;
+}
+
+void BiquadFilter::Reset()
+{
+    _z1 = 0.0;
+    _z2 = 0.0;
+}
+
+/**
+ * @brief MovingAverage constructor
+ * @param length number of averaged samples, at least one
+ */
+MovingAverage::MovingAverage(int length)
+    : _ring(std::max(length, 1), 0.0)
+{
+    //Empty
+}
+
+void MovingAverage::Process(std::span<const Timestamp> in, std::vector<Timestamp> & out)
+{
+    const std::size_t length = _ring.size();
+    for (const Timestamp & sample : in)
+    {
+        _sum += sample.Get_voltage() - _ring[_next];
+        _ring[_next] = sample.Get_voltage();
+        _next = (_next + 1 == length) ? 0 : _next + 1;
+        _filled = std::min(_filled + 1, length);
+        out.emplace_back(sample.Get_time(), _sum / _filled);
+    }
+    //running sum drifts by rounding errors, it is summed again once per block
+    _sum = 0.0;
+    for (const double voltage : _ring)
+    {
+        _sum += voltage;
+    }
+}
+
+void MovingAverage::Reset()
+{
+    std::fill(_ring.begin(), _ring.end(), 0.0);
+    _next = 0;
+    _filled = 0;
+    _sum = 0.0;
+}
+
+namespace
+{
+//voltages are stored in CIC as fixed point with 24 fraction bits
+constexpr int cic_fraction_bits = 24;
+constexpr double cic_fixed_scale = 1 << cic_fraction_bits;
+//bits of integer part of saturated voltage, Max_voltage is 2 ^ 8
+constexpr int cic_signal_bits = 8;
+static_assert(CicDecimator::Max_voltage == 1 << cic_signal_bits);
+}
+
+/**
+ * @brief CicDecimator constructor
+ * @param decimation every n-th sample is output, 1 - Max_decimation(stages)
+ * @param stages number of integrator and comb stages, 1 - 6
+ * @throw std::runtime_error if decimation is larger than Max_decimation(stages)
+ */
+CicDecimator::CicDecimator(int decimation, int stages)
+    : _decimation(std::max(decimation, 1)), _stages(std::clamp(stages, 1, 6)),
+    _output_scale(1.0 / (std::pow(static_cast<double>(_decimation), _stages) * cic_fixed_scale)),
+    _integrators(_stages, 0), _combs(_stages, 0)
+{
+    if (_decimation > Max_decimation(_stages))
+    {
+        throw std::runtime_error("CIC decimation " + std::to_string(_decimation) + " is larger than "
+            + std::to_string(Max_decimation(_stages)) + " for " + std::to_string(_stages) + " stages");
+    }
+}
+
+/**
+ * @brief Max_decimation
+ * @param stages number of integrator and comb stages
+ * @return largest decimation for which integrators do not overflow
+ * @note gain decimation ^ stages adds stages * log2(decimation) bits to signal and fraction bits
+ */
+int CicDecimator::Max_decimation(int stages)
+{
+    stages = std::clamp(stages, 1, 6);
+    //output of +-Max_voltage with full gain keeps clear of sign bit
+    const int gain_bits = 62 - cic_fraction_bits - cic_signal_bits;
+    const double decimation = std::floor(std::exp2(static_cast<double>(gain_bits) / stages));
+    return static_cast<int>(std::min(decimation, static_cast<double>(std::numeric_limits<int>::max())));
+}
+
+void CicDecimator::Process(std::span<const Timestamp> in, std::vector<Timestamp> & out)
+{
+    for (const Timestamp & sample : in)
+    {
+        const double voltage = std::clamp(sample.Get_voltage(), -Max_voltage, Max_voltage);
+        std::uint64_t value = static_cast<std::uint64_t>(std::llround(voltage * cic_fixed_scale));
+        for (std::uint64_t & integrator : _integrators)
+        {
+            integrator += value;
+            value = integrator;
+        }
+        if (++_phase < _decimation)
+        {
+            continue;
+        }
+        _phase = 0;
+        for (std::uint64_t & comb : _combs)
+        {
+            const std::uint64_t difference = value - comb;
+            comb = value;
+            value = difference;
+        }
+        out.emplace_back(sample.Get_time(), static_cast<double>(static_cast<std::int64_t>(value)) * _output_scale);
+    }
+}
+
+void CicDecimator::Reset()
+{
+    _phase = 0;
+    std::fill(_integrators.begin(), _integrators.end(), 0);
+    std::fill(_combs.begin(), _combs.end(), 0);
+}
+
+/**
+ * @brief Add_stage
+ * @param stage stage appended to end of chain
+ */
+void FilterChain::Add_stage(std::unique_ptr<IFilterStage> stage)
+{
+    _stages.push_back(std::move(stage));
+}
+
+/**
+ * @brief Process
+ * @param in interval to filter
+ * @param resource memory resource from which filtered timestamps are allocated
+ * @return filtered interval with its parameters
+ */
+RecordingVector FilterChain::Process(const RecordingVector & in, std::pmr::memory_resource * resource)
+{
+    RecordingVector::type decompressed;
+    if (in.Is_compressed())
+    {
+        decompressed = in.Decompress();
+    }
+    std::span<const Timestamp> current = in.Is_compressed() ? std::span<const Timestamp>(decompressed)
+                                                            : std::span<const Timestamp>(in.Get_container());
+    for (const std::unique_ptr<IFilterStage> & stage : _stages)
+    {
+        _back.clear();
+        stage->Process(current, _back);
+        _front.swap(_back);
+        current = _front;
+    }
+    RecordingVector vec(resource);
+    vec.Get_container().assign(current.begin(), current.end());
+    double min_voltage = std::numeric_limits<double>::max();
+    double max_voltage = std::numeric_limits<double>::lowest();
+    for (const Timestamp & sample : current)
+    {
+        min_voltage = std::min(min_voltage, sample.Get_voltage());
+        max_voltage = std::max(max_voltage, sample.Get_voltage());
+    }
+    if (current.empty())
+    {
+        min_voltage = 0.0;
+        max_voltage = 0.0;
+    }
+    const double min_time = current.empty() ? 0.0 : current.front().Get_time();
+    const double max_time = current.empty() ? 0.0 : current.back().Get_time();
+    vec.Set_recording_params(RangeParams({min_voltage, max_voltage}, {min_time, max_time}, static_cast<int>(current.size())));
+    return vec;
+}
+
+/**
+ * @brief Reset
+ * @note clears state of all stages
+ */
+void FilterChain::Reset()
+{
+    for (const std::unique_ptr<IFilterStage> & stage : _stages)
+    {
+        stage->Reset();
+    }
+}
+
+/**
+ * @brief Empty
+ * @return true if chain has no stages
+ */
+bool FilterChain::Empty() const
+{
+    return _stages.empty();
+}
+
+/**
+ * @brief Parse
+ * @param spec comma separated stages, e.g. "lowpass:50,cic:4" for given sample rate:
+ * lowpass:HZ, highpass:HZ, bandpass:LOW:HIGH (biquad), fir:HZ:TAPS, firband:LOW:HIGH:TAPS,
+ * average:N, decimate:N (FIR low pass + decimation), cic:N
+ * @param sample_rate sample rate of input in Hz
+ * @return chain with parsed stages
+ * @throw std::runtime_error if spec is not valid
+ */
+std::unique_ptr<FilterChain> FilterChain::Parse(std::string_view spec, double sample_rate)
+{
+    auto chain = std::make_unique<FilterChain>();
+    while (!spec.empty())
+    {
+        const std::size_t comma = spec.find(',');
+        std::string_view item = spec.substr(0, comma);
+        spec = (comma == std::string_view::npos) ? std::string_view() : spec.substr(comma + 1);
+        //name:arg:arg...
+        std::vector<double> args;
+        const std::size_t colon = item.find(':');
+        const std::string name(item.substr(0, colon));
+        std::string_view rest = (colon == std::string_view::npos) ? std::string_view() : item.substr(colon + 1);
+        while (!rest.empty())
+        {
+            const std::size_t next = rest.find(':');
+            try
+            {
+                args.push_back(std::stod(std::string(rest.substr(0, next))));
+            }
+            catch (const std::exception &)
+            {
+                throw std::runtime_error("Invalid filter argument: " + std::string(item));
+            }
+            rest = (next == std::string_view::npos) ? std::string_view() : rest.substr(next + 1);
+        }
+        const auto expect = [&](std::size_t count) {
+            if (args.size() != count)
+            {
+                throw std::runtime_error("Invalid number of filter arguments: " + std::string(item));
+            }
+        };
+        if (name == "lowpass" || name == "highpass")
+        {
+            expect(1);
+            chain->Add_stage(std::make_unique<BiquadFilter>(name == "lowpass" ? BiquadType::LOW_PASS : BiquadType::HIGH_PASS, args[0], sample_rate));
+        }
+        else if (name == "bandpass")
+        {
+            expect(2);
+            const double center = std::sqrt(args[0] * args[1]);
+            chain->Add_stage(std::make_unique<BiquadFilter>(BiquadType::BAND_PASS, center, sample_rate, center / (args[1] - args[0])));
+        }
+        else if (name == "fir")
+        {
+            expect(2);
+            chain->Add_stage(std::make_unique<FirFilter>(FirFilter::Low_pass(args[0], sample_rate, static_cast<int>(args[1]))));
+        }
+        else if (name == "firband")
+        {
+            expect(3);
+            chain->Add_stage(std::make_unique<FirFilter>(FirFilter::Band_pass(args[0], args[1], sample_rate, static_cast<int>(args[2]))));
+        }
+        else if (name == "average")
+        {
+            expect(1);
+            chain->Add_stage(std::make_unique<MovingAverage>(static_cast<int>(args[0])));
+        }
+        else if (name == "decimate")
+        {
+            expect(1);
+            const int decimation = std::max(static_cast<int>(args[0]), 1);
+            //cutoff below new Nyquist frequency
+            chain->Add_stage(std::make_unique<FirFilter>(FirFilter::Low_pass(0.4 * sample_rate / decimation, sample_rate, 8 * decimation + 1), decimation));
+            sample_rate /= decimation;
+        }
+        else if (name == "cic")
+        {
+            expect(1);
+            //integrators overflow silently, so too large decimation is error
+            if (!(args[0] <= CicDecimator::Max_decimation()))
+            {
+                throw std::runtime_error("CIC decimation too large: " + std::string(item)
+                    + ", at most " + std::to_string(CicDecimator::Max_decimation()));
+            }
+            const int decimation = std::max(static_cast<int>(args[0]), 1);
+            chain->Add_stage(std::make_unique<CicDecimator>(decimation));
+            sample_rate /= decimation;
+        }
+        else
+        {
+            throw std::runtime_error("Unknown filter: " + name);
+        }
+    }
+    return chain;
+}
@@ -0,0 +1,405 @@
+#include "HistoryArchive.h"
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+//number of min & max buckets stored in memory for each interval
+constexpr int summary_buckets = 512;
+
+/**
+ * @brief interval_bytes
+ * @param params parameters of archived interval
+ * @return bytes which interval takes in file
+ */
+std::uint64_t interval_bytes(const RangeParams & params)
+{
+    return static_cast<std::uint64_t>(params.Get_max_index()) * 2 * sizeof(double);
+}
+}
+
+/**
+ * @brief HistoryArchive constructor
+ * @param fname name of archive file, it's truncated on creation
+ * @param cached_intervals how many decoded intervals are kept in memory
+ * @param size_limit max bytes of archived intervals, 0 means no limit
+ * @throws runtime_error if archive file can't be created
+ */
+HistoryArchive::HistoryArchive(const std::string_view & fname, int cached_intervals, std::uint64_t size_limit)
+    : _fname(fname), _size_limit(size_limit), _cache(cached_intervals < 1 ? 1 : cached_intervals)
+{
+    _file.open(_fname, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    _reader.open(_fname, std::ios::binary);
+    if (!_file.is_open() || !_reader.is_open())
+    {
+        throw std::runtime_error("Can't create archive file " + _fname);
+    }
+}
+
+/**
+ * @brief Append
+ * @param vec interval to save at the end of archive
+ * @return true if interval was written to file
+ * @note intervals have to be appended in time order, oldest intervals are evicted
+ * when size limit is reached
+ */
+bool HistoryArchive::Append(const RecordingVector & vec)
+{
+    const RecordingVector::type & data = vec.Get_container();
+    if (data.empty())
+    {
+        return false;
+    }
+    std::vector<std::pair<double, double>> summary = build_summary(vec);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _io_buffer.resize(data.size() * 2);
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        _io_buffer[2 * i] = data[i].Get_time();
+        _io_buffer[2 * i + 1] = data[i].Get_voltage();
+    }
+    const std::uint64_t bytes = _io_buffer.size() * sizeof(double);
+    if (_size_limit > 0 && _write_offset > 0 && _write_offset + bytes > _size_limit)
+    {
+        //file is ring, newest interval continues from its beginning
+        _write_offset = 0;
+    }
+    evict(bytes);
+    _file.clear();
+    _file.seekp(_write_offset);
+    _file.write(reinterpret_cast<const char*>(_io_buffer.data()), bytes);
+    //reader handle has to see whole interval once it is in index
+    _file.flush();
+    if (!_file.good())
+    {
+        return false;
+    }
+
+    RangeParams params = vec.Get_recording_params();
+    params._time_range = {data.front().Get_time(), data.back().Get_time()};
+    params._max_index = data.size();
+    _index.push_back({_write_offset, params, std::move(summary)});
+    _write_offset += bytes;
+
+    if (_index.size() == 1)
+    {
+        _params = params;
+    }
+    else
+    {
+        _params._voltage_range.first = std::min(_params.Get_min_voltage(), params.Get_min_voltage());
+        _params._voltage_range.second = std::max(_params.Get_max_voltage(), params.Get_max_voltage());
+        _params._time_range.second = params.Get_max_time();
+        _params._max_index += params.Get_max_index();
+    }
+    return true;
+}
+
+/**
+ * @brief Load_range
+ * @param min_time begin of requested time range
+ * @param max_time end of requested time range
+ * @param max_points max number of timestamps returned
+ * @return timestamps from range in time order. If range holds more than max_points
+ * timestamps, min & max voltage pairs of equal time buckets are returned instead.
+ * @note whole intervals are returned when range is not decimated, so line
+ * can be drawn up to the edges of range. File is read without lock of index,
+ * so Append() doesn't wait for disk reads
+ */
+std::vector<Timestamp> HistoryArchive::Load_range(double min_time, double max_time, int max_points) const
+{
+    std::vector<Timestamp> result;
+    if (max_time <= min_time || max_points < 2)
+    {
+        return result;
+    }
+    //intervals read from file after index is unlocked
+    std::vector<LoadedInterval> intervals;
+    //decimation, each bucket gives min and max point
+    const int buckets = max_points / 2;
+    const double bucket_width = (max_time - min_time) / buckets;
+    std::vector<std::pair<double, double>> envelope;
+    auto merge = [&](double time, double low, double high)
+    {
+        if (time < min_time || time >= max_time)
+        {
+            return;
+        }
+        const int b = std::min(static_cast<int>((time - min_time) / bucket_width), buckets - 1);
+        envelope[b].first = std::min(envelope[b].first, low);
+        envelope[b].second = std::max(envelope[b].second, high);
+    };
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_index.empty())
+    {
+        return result;
+    }
+
+    auto first = std::lower_bound(_index.begin(), _index.end(), min_time,
+        [](const ArchiveInterval & a, double value) {
+            return a._params.Get_max_time() < value;
+        });
+    auto last = std::upper_bound(first, _index.end(), max_time,
+        [](double value, const ArchiveInterval & a) {
+            return value < a._params.Get_min_time();
+        });
+    if (first == last)
+    {
+        return result;
+    }
+
+    long long raw_count = 0;
+    for (auto it = first; it != last; it++)
+    {
+        raw_count += it->_params.Get_max_index();
+    }
+
+    if (raw_count <= max_points)
+    {
+        for (auto it = first; it != last; it++)
+        {
+            intervals.push_back(find_interval(std::distance(_index.begin(), it)));
+        }
+        lock.unlock();
+        load_intervals(intervals);
+        result.reserve(raw_count);
+        for (const LoadedInterval & interval : intervals)
+        {
+            const RecordingVector::type & data = interval._vec->Get_container();
+            result.insert(result.end(), data.begin(), data.end());
+        }
+        return result;
+    }
+
+    envelope.assign(buckets, {std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()});
+    for (auto it = first; it != last; it++)
+    {
+        const RangeParams & params = it->_params;
+        const double summary_width = (params.Get_max_time() - params.Get_min_time()) / summary_buckets;
+        if (summary_width <= bucket_width)
+        {
+            //summary is precise enough, interval stays on disk
+            for (int j = 0; j < summary_buckets; j++)
+            {
+                const auto & [low, high] = it->_summary[j];
+                if (low <= high)
+                {
+                    merge(params.Get_min_time() + (j + 0.5) * summary_width, low, high);
+                }
+            }
+        }
+        else
+        {
+            intervals.push_back(find_interval(std::distance(_index.begin(), it)));
+        }
+    }
+    lock.unlock();
+    load_intervals(intervals);
+    for (const LoadedInterval & interval : intervals)
+    {
+        for (const Timestamp & point : interval._vec->Get_container())
+        {
+            merge(point.Get_time(), point.Get_voltage(), point.Get_voltage());
+        }
+    }
+
+    result.reserve(max_points);
+    for (int b = 0; b < buckets; b++)
+    {
+        const auto & [low, high] = envelope[b];
+        if (low <= high)
+        {
+            const double time = min_time + b * bucket_width;
+            result.emplace_back(time, low);
+            result.emplace_back(time + bucket_width / 2, high);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Get_recording_params
+ * @return parameters of whole archived history
+ */
+RangeParams HistoryArchive::Get_recording_params() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _params;
+}
+
+/**
+ * @brief Get_interval_count
+ * @return number of archived intervals
+ */
+int HistoryArchive::Get_interval_count() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _index.size();
+}
+
+/**
+ * @brief Empty
+ * @return true if nothing was archived
+ */
+bool HistoryArchive::Empty() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _index.empty();
+}
+
+/**
+ * @brief Clear
+ * @note removes all intervals from archive and truncates file
+ */
+void HistoryArchive::Clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    //intervals being read by Load_range() are recognized as removed
+    _first_id += _index.size();
+    _index.clear();
+    _cache.Clear();
+    _params = RangeParams();
+    _write_offset = 0;
+    _file.close();
+    _file.open(_fname, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+}
+
+/**
+ * @brief find_interval
+ * @param i index of interval in _index
+ * @return interval with decoded data if it is cached
+ * @note _mutex has to be locked
+ */
+HistoryArchive::LoadedInterval HistoryArchive::find_interval(std::size_t i) const
+{
+    const ArchiveInterval & info = _index[i];
+    LoadedInterval interval {_first_id + i, info._offset, info._params, nullptr};
+    if (std::shared_ptr<const RecordingVector> * cached = _cache.Get(interval._id))
+    {
+        interval._vec = *cached;
+    }
+    return interval;
+}
+
+/**
+ * @brief load_intervals
+ * @param intervals intervals found by find_interval(), those not cached are read from file
+ * @note _mutex must not be locked, intervals evicted while they were read are removed
+ */
+void HistoryArchive::load_intervals(std::vector<LoadedInterval> & intervals) const
+{
+    bool loaded = false;
+    {
+        std::lock_guard<std::mutex> lock(_read_mutex);
+        std::vector<double> buffer;
+        for (LoadedInterval & interval : intervals)
+        {
+            if (interval._vec)
+            {
+                continue;
+            }
+            const int count = interval._params.Get_max_index();
+            buffer.resize(2 * count);
+            _reader.clear();
+            _reader.seekg(interval._offset);
+            _reader.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(double));
+
+            auto vec = std::make_shared<RecordingVector>();
+            RecordingVector::type & data = vec->Get_container();
+            data.reserve(count);
+            for (int j = 0; j < count; j++)
+            {
+                data.emplace_back(buffer[2 * j], buffer[2 * j + 1]);
+            }
+            vec->Set_recording_params(interval._params);
+            interval._vec = std::move(vec);
+            loaded = true;
+        }
+    }
+    if (!loaded)
+    {
+        return;
+    }
+    //interval evicted before it was read may be overwritten by newer one, its data is dropped
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::erase_if(intervals, [this](const LoadedInterval & interval) {
+        return interval._id < _first_id;
+    });
+    for (const LoadedInterval & interval : intervals)
+    {
+        _cache.Put(interval._id, interval._vec);
+    }
+}
+
+/**
+ * @brief evict
+ * @param bytes size of interval which is written at _write_offset
+ * @note _mutex has to be locked, removes intervals overwritten by new one
+ */
+void HistoryArchive::evict(std::uint64_t bytes)
+{
+    //oldest interval is always the next one in ring after position of writing
+    bool evicted = false;
+    while (!_index.empty() && _index.front()._offset < _write_offset + bytes
+        && _write_offset < _index.front()._offset + interval_bytes(_index.front()._params))
+    {
+        _index.pop_front();
+        _first_id++;
+        evicted = true;
+    }
+    if (!evicted)
+    {
+        return;
+    }
+    _params = RangeParams();
+    for (std::size_t i = 0; i < _index.size(); i++)
+    {
+        const RangeParams & params = _index[i]._params;
+        if (i == 0)
+        {
+            _params = params;
+            continue;
+        }
+        _params._voltage_range.first = std::min(_params.Get_min_voltage(), params.Get_min_voltage());
+        _params._voltage_range.second = std::max(_params.Get_max_voltage(), params.Get_max_voltage());
+        _params._time_range.second = params.Get_max_time();
+        _params._max_index += params.Get_max_index();
+    }
+}
+
+/**
+ * @brief build_summary
+ * @param vec interval to summarize
+ * @return min & max voltage of equal time buckets of interval
+ */
+std::vector<std::pair<double, double>> HistoryArchive::build_summary(const RecordingVector & vec)
+{
+    std::vector<std::pair<double, double>> summary(summary_buckets,
+        {std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()});
+    const RecordingVector::type & data = vec.Get_container();
+    const double min_time = data.front().Get_time();
+    const double span = data.back().Get_time() - min_time;
+    for (const Timestamp & point : data)
+    {
+        int b = 0;
+        if (span > 0.0)
+        {
+            b = std::min(static_cast<int>((point.Get_time() - min_time) / span * summary_buckets),
+                summary_buckets - 1);
+        }
+        summary[b].first = std::min(summary[b].first, point.Get_voltage());
+        summary[b].second = std::max(summary[b].second, point.Get_voltage());
+    }
+    return summary;
+}
+
+HistoryArchive::~HistoryArchive()
+{
+    _file.close();
+    std::error_code ec;
+    std::filesystem::remove(_fname, ec);
+}
@@ -0,0 +1,483 @@
+#include "ImPlotChart.h"
+#include "PipelineMetrics.h"
+#include "imgui.h"
+#include "implot.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace
+{
+/**
+ * @brief get_point
+ * @note getter used by ImPlot, reads points directly from intervals of history
+ */
+ImPlotPoint get_point(int index, void * data)
+{
+    ImPlotChart::Series & series = *static_cast<ImPlotChart::Series*>(data);
+    const Timestamp & point = series.At(series._first + index);
+    return ImPlotPoint(point.Get_time(), point.Get_voltage());
+}
+
+bool is_before(const Timestamp & a, double time)
+{
+    return a.Get_time() < time;
+}
+
+bool is_earlier(const Timestamp & a, const Timestamp & b)
+{
+    return a.Get_time() < b.Get_time();
+}
+}
+
+/**
+ * @brief At
+ * @param index global index of point
+ * @return point with given index
+ */
+const Timestamp& ImPlotChart::Series::At(std::size_t index)
+{
+    if (index < _offsets[_last_span] || index >= _offsets[_last_span] + _spans[_last_span].size())
+    {
+        const auto it = std::upper_bound(_offsets.begin(), _offsets.end(), index);
+        _last_span = std::distance(_offsets.begin(), it) - 1;
+    }
+    return _spans[_last_span][index - _offsets[_last_span]];
+}
+
+/**
+ * @brief constructor with parameters
+ * @param data is data that will be passed as charts default data
+ * @param width is the width of the drawing area
+ * @param height is the height of the drawing area
+ * @param origin is the position of left bottom corner of a chart.
+ * @param min_Y is min value of Y axis.
+ * @param max_Y is max value of Y axis.
+ * @param history_seconds how many seconds of added data are kept.
+ */
+ImPlotChart::ImPlotChart(std::span<const Timestamp> data, float width, float height, sf::Vector2f origin, float min_Y, float max_Y, int history_seconds) :
+m_data_min_Y{min_Y}, m_data_max_Y{max_Y}, m_base_time_span{1.f}, m_time_span{1.f}, m_zoom{1.f}, m_view_min_time{0.0}, m_view_max_time{1.0}
+{
+    //window names are global in ImGui, so every chart has its own
+    m_window_name = "##ImPlotChart" + std::to_string(reinterpret_cast<std::uintptr_t>(this));
+    m_width = width;
+    m_height = height;
+    m_origin = origin;
+    m_padding = 10.f;
+    m_color_of_chart = sf::Color(255, 0, 0);
+    m_history.Set_history_time_limit(history_seconds);
+    m_history_b.Set_history_time_limit(history_seconds);
+    m_should_scroll = true;
+    Add_data(data);
+}
+/**
+ * @brief Adds data as new interval, the oldest interval is removed when history is full.
+ * @param new_timestamps new data that will be added to current data.
+ */
+void ImPlotChart::Add_data(std::span<const Timestamp> new_timestamps)
+{
+    Push_interval(m_history, new_timestamps);
+}
+/**
+ * @brief Adds data of channel B as new interval, it is used only by math trace.
+ * @param new_timestamps new data of channel B.
+ */
+void ImPlotChart::Add_channel_b_data(std::span<const Timestamp> new_timestamps)
+{
+    Push_interval(m_history_b, new_timestamps);
+}
+/**
+ * @brief shows math trace on secondary Y axis, it replaces previous math trace.
+ * @param operation expression over channel A (added data) and channel B.
+ */
+void ImPlotChart::Show_math(MathOperation operation)
+{
+    m_math = std::make_unique<MathChannel>(operation, m_history, &m_history_b);
+}
+/**
+ * @brief hides math trace, its cached results are released.
+ */
+void ImPlotChart::Hide_math()
+{
+    m_math.reset();
+    m_math_data.clear();
+    m_math_decimated.clear();
+}
+/**
+ * @brief Push_interval
+ * @param history history to which interval is pushed
+ * @param new_timestamps data of interval
+ */
+void ImPlotChart::Push_interval(RecordingHistory & history, std::span<const Timestamp> new_timestamps)
+{
+    if (new_timestamps.empty()) return;
+    RecordingVector vec(&m_pool);
+    vec.Get_container().assign(new_timestamps.begin(), new_timestamps.end());
+    RangeParams params({std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()},
+                       {new_timestamps.front().Get_time(), new_timestamps.back().Get_time()},
+                       static_cast<int>(new_timestamps.size()));
+    for (const Timestamp & point : new_timestamps)
+    {
+        params._voltage_range.first = std::min(params._voltage_range.first, point.Get_voltage());
+        params._voltage_range.second = std::max(params._voltage_range.second, point.Get_voltage());
+    }
+    vec.Set_recording_params(params);
+    history.Push_recordingVector(std::move(vec));
+}
+/**
+ * @brief draws a line chart based on data given to the class.
+ * @param target is an object for drawing. Probably window.
+ */
+void ImPlotChart::Draw(sf::RenderTarget& target)
+{
+    ScopedStageTimer timer(PipelineStage::RENDER);
+    Update_view();
+    float window_height = target.getSize().y;
+    ImGui::SetNextWindowPos(ImVec2(m_origin.x, window_height - m_origin.y - m_height - m_padding));
+    ImGui::SetNextWindowSize(ImVec2(m_width + 2 * m_padding, m_height + 2 * m_padding));
+    constexpr ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove
+        | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoBringToFrontOnFocus;
+    if (ImGui::Begin(m_window_name.c_str(), nullptr, window_flags))
+    {
+        //view is controlled by IChart interface, so ImPlot's own inputs are disabled
+        constexpr ImPlotFlags plot_flags = ImPlotFlags_NoTitle | ImPlotFlags_NoLegend | ImPlotFlags_NoMenus
+            | ImPlotFlags_NoBoxSelect | ImPlotFlags_NoInputs;
+        if (ImPlot::BeginPlot("##signal", ImVec2(-1, -1), plot_flags))
+        {
+            ImPlot::SetupAxes("time [s]", "voltage [V]");
+            ImPlot::SetupAxisLimits(ImAxis_X1, m_view_min_time, m_view_max_time, ImPlotCond_Always);
+            ImPlot::SetupAxisLimits(ImAxis_Y1, m_data_min_Y, m_data_max_Y, ImPlotCond_Always);
+            if (m_math)
+            {
+                //range of derivative or integral differs from range of voltage
+                ImPlot::SetupAxis(ImAxis_Y2, MathChannel::Get_name(m_math->Get_operation()),
+                                  ImPlotAxisFlags_AuxDefault | ImPlotAxisFlags_AutoFit);
+            }
+            ImPlot::SetNextLineStyle(ImVec4(m_color_of_chart.r / 255.f, m_color_of_chart.g / 255.f,
+                                            m_color_of_chart.b / 255.f, m_color_of_chart.a / 255.f));
+            Plot_visible();
+            Plot_math();
+            ImPlot::EndPlot();
+        }
+    }
+    ImGui::End();
+}
+/**
+ * @brief moves view to the newest data when scrolling, keeps it when panning.
+ */
+void ImPlotChart::Update_view()
+{
+    if (m_should_scroll && !m_history.Empty())
+    {
+        m_view_max_time = m_history.Get_recording_params().Get_max_time();
+    }
+    m_view_min_time = m_view_max_time - m_time_span;
+    Load_visible_archive();
+}
+/**
+ * @brief collects intervals overlapping view into m_series.
+ * @return number of visible points
+ */
+std::size_t ImPlotChart::Collect_visible()
+{
+    m_series._spans.clear();
+    m_series._offsets.clear();
+    m_series._first = 0;
+    m_series._last_span = 0;
+    std::size_t total = 0;
+    for (const RecordingVector & vec : m_history.Get_container())
+    {
+        const RangeParams params = vec.Get_recording_params();
+        if (vec.Is_compressed() || params.Get_max_time() < m_view_min_time || params.Get_min_time() > m_view_max_time)
+        {
+            continue;
+        }
+        m_series._spans.emplace_back(vec.Get_container());
+        m_series._offsets.push_back(total);
+        total += vec.Get_container().size();
+    }
+    if (m_series._spans.empty())
+    {
+        return 0;
+    }
+    const std::span<const Timestamp> & front = m_series._spans.front();
+    const std::span<const Timestamp> & back = m_series._spans.back();
+    //one point outside view on both sides, so line reaches edges of plot
+    std::size_t first = std::distance(front.begin(), std::lower_bound(front.begin(), front.end(), m_view_min_time, is_before));
+    first = (first > 0) ? first - 1 : 0;
+    std::size_t last = m_series._offsets.back()
+        + std::distance(back.begin(), std::lower_bound(back.begin(), back.end(), m_view_max_time, is_before));
+    last = std::min(last + 1, total);
+    m_series._first = first;
+    return (last > first) ? last - first : 0;
+}
+/**
+ * @brief fills m_decimated with min & max voltage of each pixel column of visible points.
+ * @param count number of visible points
+ * @param buckets number of pixel columns
+ */
+void ImPlotChart::Decimate(std::size_t count, int buckets)
+{
+    m_decimated.clear();
+    const double bucket_time = (m_view_max_time - m_view_min_time) / buckets;
+    std::size_t index = m_series._first;
+    const std::size_t end = m_series._first + count;
+    while (index < end)
+    {
+        const Timestamp & begin = m_series.At(index);
+        const long bucket = static_cast<long>((begin.Get_time() - m_view_min_time) / bucket_time);
+        const double bucket_end = m_view_min_time + (bucket + 1) * bucket_time;
+        const Timestamp * min = &begin;
+        const Timestamp * max = &begin;
+        for (index++; index < end; index++)
+        {
+            const Timestamp & point = m_series.At(index);
+            if (point.Get_time() >= bucket_end) break;
+            if (point.Get_voltage() < min->Get_voltage()) min = &point;
+            if (point.Get_voltage() > max->Get_voltage()) max = &point;
+        }
+        //keeps time order, so line goes through both extremes
+        if (min->Get_time() <= max->Get_time())
+        {
+            m_decimated.push_back(*min);
+            if (min != max) m_decimated.push_back(*max);
+        }
+        else
+        {
+            m_decimated.push_back(*max);
+            m_decimated.push_back(*min);
+        }
+    }
+}
+/**
+ * @brief plots visible points, decimated if there are more than two per pixel.
+ */
+void ImPlotChart::Plot_visible()
+{
+    PipelineMetrics & metrics = PipelineMetrics::Instance();
+    const int pixels = std::max(1, static_cast<int>(m_width));
+    if (!m_archive_data.empty() && m_should_pan && (m_history.Empty() || m_view_min_time < m_history.Get_recording_params().Get_min_time()))
+    {
+        //archive already returns at most two points per pixel
+        ImPlot::PlotLine("signal", &m_archive_data.front()._data.first, &m_archive_data.front()._data.second,
+                         static_cast<int>(m_archive_data.size()), 0, 0, sizeof(Timestamp));
+        metrics.Set_gauge(PipelineGauge::VISIBLE_POINTS, m_archive_data.size());
+        metrics.Set_gauge(PipelineGauge::VERTEX_COUNT, m_archive_data.size());
+        return;
+    }
+    const std::size_t count = Collect_visible();
+    metrics.Set_gauge(PipelineGauge::VISIBLE_POINTS, count);
+    if (count == 0)
+    {
+        metrics.Set_gauge(PipelineGauge::VERTEX_COUNT, 0);
+        return;
+    }
+    if (count > static_cast<std::size_t>(2 * pixels))
+    {
+        //summaries are used only when they cover whole view, otherwise visible points are decimated
+        const bool summarized = m_summary && m_view_min_time >= m_summary->Get_min_time()
+            && m_summary->Query(m_view_min_time, m_view_max_time, pixels, m_decimated) && !m_decimated.empty();
+        if (!summarized) Decimate(count, pixels);
+        ImPlot::PlotLine("signal", &m_decimated.front()._data.first, &m_decimated.front()._data.second,
+                         static_cast<int>(m_decimated.size()), 0, 0, sizeof(Timestamp));
+        metrics.Set_gauge(PipelineGauge::VERTEX_COUNT, m_decimated.size());
+    }
+    else
+    {
+        ImPlot::PlotLineG("signal", get_point, &m_series, static_cast<int>(count));
+        metrics.Set_gauge(PipelineGauge::VERTEX_COUNT, count);
+    }
+}
+/**
+ * @brief plots visible part of math trace, decimated if there are more than two points per pixel.
+ */
+void ImPlotChart::Plot_math()
+{
+    if (!m_math) return;
+    //hidden parts of history are not computed, computed intervals are cached
+    m_math->Evaluate(m_view_min_time, m_view_max_time, m_math_data);
+    if (m_math_data.empty()) return;
+    const int pixels = std::max(1, static_cast<int>(m_width));
+    const std::vector<Timestamp> * plotted = &m_math_data;
+    if (m_math_data.size() > static_cast<std::size_t>(2 * pixels))
+    {
+        m_math_decimated.clear();
+        const double bucket_time = (m_view_max_time - m_view_min_time) / pixels;
+        auto begin = m_math_data.begin();
+        while (begin != m_math_data.end())
+        {
+            const long bucket = static_cast<long>((begin->Get_time() - m_view_min_time) / bucket_time);
+            const double bucket_end = m_view_min_time + (bucket + 1) * bucket_time;
+            const auto end = std::find_if(begin, m_math_data.end(), [bucket_end](const Timestamp & point) {
+                return point.Get_time() >= bucket_end;
+            });
+            const auto [min, max] = std::minmax_element(begin, end, [](const Timestamp & a, const Timestamp & b) {
+                return a.Get_voltage() < b.Get_voltage();
+            });
+            //keeps time order, so line goes through both extremes
+            m_math_decimated.push_back(std::min(*min, *max, is_earlier));
+            if (min != max) m_math_decimated.push_back(std::max(*min, *max, is_earlier));
+            begin = end;
+        }
+        plotted = &m_math_decimated;
+    }
+    ImPlot::SetAxes(ImAxis_X1, ImAxis_Y2);
+    ImPlot::SetNextLineStyle(ImVec4(0.3f, 0.8f, 1.f, 1.f));
+    ImPlot::PlotLine(MathChannel::Get_name(m_math->Get_operation()), &plotted->front()._data.first,
+                     &plotted->front()._data.second, static_cast<int>(plotted->size()), 0, 0, sizeof(Timestamp));
+    ImPlot::SetAxes(ImAxis_X1, ImAxis_Y1);
+}
+/**
+ * @brief replaces m_archive_data with archived data around current view, when view left loaded range.
+ * Range one time span wider on both sides is loaded, so short panning doesn't reload data.
+ */
+void ImPlotChart::Load_visible_archive()
+{
+    if (!m_archive || !m_should_pan || m_archive->Empty()) return;
+    const bool is_covered = m_view_min_time >= m_loaded_min_time && m_view_max_time <= m_loaded_max_time;
+    if (is_covered && m_loaded_time_span == m_time_span) return;
+    m_loaded_min_time = m_view_min_time - m_time_span;
+    m_loaded_max_time = m_view_max_time + m_time_span;
+    m_loaded_time_span = m_time_span;
+    //two points (min & max) per pixel of three loaded widths
+    constexpr int points_per_pixel = 2;
+    constexpr int loaded_widths = 3;
+    const int max_points = static_cast<int>(m_width) * points_per_pixel * loaded_widths;
+    m_archive_data = m_archive->Load_range(m_loaded_min_time, m_loaded_max_time, max_points);
+}
+/**
+ * @brief sets given data as the current data
+ */
+void ImPlotChart::Set_data(std::vector<Timestamp> data)
+{
+    m_history.Clear();
+    m_history_b.Clear();
+    //cached results belong to cleared intervals, integral starts again from zero
+    if (m_math) m_math->Invalidate();
+    Add_data(data);
+}
+bool ImPlotChart::Is_cursor_on_chart(sf::RenderTarget& target) const
+{
+    float window_height = target.getSize().y;
+    if( m_cursor_position.x < m_origin.x || m_cursor_position.x > (m_origin.x+m_width)){
+        return false;
+    }
+    if( m_cursor_position.y < (window_height - m_origin.y - m_height) || m_cursor_position.y > (window_height - m_origin.y)){
+        return false;
+    }
+    return true;
+}
+/**
+ * @brief clears current data.
+ */
+void ImPlotChart::Reset_data()
+{
+    m_history.Clear();
+    m_history_b.Clear();
+    if (m_math) m_math->Invalidate();
+    m_archive_data.clear();
+    m_view_max_time = m_time_span;
+    m_loaded_time_span = 0.f;
+}
+/**
+ * @brief sets archive from which visible data is loaded while chart is panned.
+ * @param archive is the archive with whole recorded history, can be nullptr.
+ */
+void ImPlotChart::Set_archive(std::shared_ptr<const HistoryArchive> archive)
+{
+    m_archive = std::move(archive);
+    m_archive_data.clear();
+    m_loaded_time_span = 0.f;
+}
+/**
+ * @brief sets summaries from which zoomed out view is drawn.
+ * @param summary is the pyramid of the same data as added to chart, can be nullptr.
+ */
+void ImPlotChart::Set_summary(std::shared_ptr<const SummaryPyramid> summary)
+{
+    m_summary = std::move(summary);
+}
+[[nodiscard]] sf::Vector2i ImPlotChart::Get_cursor() const
+{
+    return m_cursor_position;
+}
+[[nodiscard]] float ImPlotChart::Get_width() const
+{
+    return m_width;
+}
+[[nodiscard]] float ImPlotChart::Get_height() const
+{
+    return m_height;
+}
+[[nodiscard]] float ImPlotChart::Get_zoom() const
+{
+    return m_zoom;
+}
+[[nodiscard]] float ImPlotChart::Get_scrolling() const
+{
+    return m_should_scroll;
+}
+[[nodiscard]] float ImPlotChart::Get_panning() const
+{
+    return m_should_pan;
+}
+[[nodiscard]] float ImPlotChart::Get_time_span() const
+{
+    return m_time_span;
+}
+void ImPlotChart::Set_cursor(sf::Vector2i position)
+{
+    m_cursor_position = position;
+}
+void ImPlotChart::Set_width(float new_width)
+{
+    m_width = new_width;
+}
+void ImPlotChart::Set_height(float new_height)
+{
+    m_height = new_height;
+}
+/**
+ * @brief sets zoom, visible time span is base time span divided by zoom.
+ * @param new_zoom zoom from 1.0 to 16.0
+ */
+void ImPlotChart::Set_zoom(float new_zoom)
+{
+    constexpr float min_zoom = 1.f;
+    constexpr float max_zoom = 16.f;
+    if (new_zoom < min_zoom || new_zoom > max_zoom) return;
+    m_zoom = new_zoom;
+    m_time_span = m_base_time_span / m_zoom;
+}
+void ImPlotChart::Set_origin(sf::Vector2f new_origin)
+{
+    m_origin = new_origin;
+}
+void ImPlotChart::Set_scrolling(bool should_scroll)
+{
+    m_should_scroll = should_scroll;
+}
+void ImPlotChart::Set_panning(bool should_pan)
+{
+    m_should_pan = should_pan;
+    m_loaded_time_span = 0.f;
+}
+void ImPlotChart::Set_color(sf::Color new_color)
+{
+    m_color_of_chart = new_color;
+}
+/**
+ * @brief Moves visible time range by pan_value, within recorded (or archived) data.
+ * @param pan_value value that will change visible time range.
+ */
+void ImPlotChart::Set_pan(float pan_value)
+{
+    if (m_history.Empty()) return;
+    RangeParams recorded = m_history.Get_recording_params();
+    if (m_archive && !m_archive->Empty()) {
+        recorded = m_archive->Get_recording_params();
+    }
+    const double max_time = recorded.Get_max_time();
+    const double min_time = std::min(recorded.Get_min_time() + m_time_span, max_time);
+    m_view_max_time = std::clamp<double>(m_view_max_time + pan_value, min_time, max_time);
+}
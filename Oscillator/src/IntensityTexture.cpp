@@ -0,0 +1,76 @@
+#include "IntensityTexture.h"
+
+IntensityTexture::IntensityTexture()
+{
+    Set_color(sf::Color(255, 0, 0));
+}
+/**
+ * @brief sets color of palette used for often hit bins.
+ * @param new_color color of chart.
+ */
+void IntensityTexture::Set_color(sf::Color new_color)
+{
+    constexpr sf::Color background = sf::Color(10, 10, 10);
+    constexpr sf::Color hottest = sf::Color(255, 255, 255);
+    const auto blend = [](sf::Color a, sf::Color b, float t) {
+        return sf::Color(static_cast<std::uint8_t>(a.r + (b.r - a.r) * t),
+                         static_cast<std::uint8_t>(a.g + (b.g - a.g) * t),
+                         static_cast<std::uint8_t>(a.b + (b.b - a.b) * t));
+    };
+    const std::size_t middle = m_palette.size() * 3 / 4;
+    for (std::size_t i = 0; i < m_palette.size(); i++) {
+        m_palette[i] = (i < middle) ? blend(background, new_color, static_cast<float>(i) / middle)
+                                    : blend(new_color, hottest, static_cast<float>(i - middle) / (m_palette.size() - 1 - middle));
+    }
+    //palette changed, all pixels have to be converted again
+    m_pixels.clear();
+}
+/**
+ * @brief color of bins without hits.
+ */
+sf::Color IntensityTexture::Get_background() const
+{
+    return m_palette.front();
+}
+/**
+ * @brief converts intensities to pixels and uploads them to texture.
+ * @param intensity row-major intensities from 0.0 to 1.0
+ * @param columns width of grid
+ * @param rows height of grid
+ * @param changed false if intensities did not change since last update
+ */
+void IntensityTexture::Update(const std::vector<float>& intensity, unsigned columns, unsigned rows, bool changed)
+{
+    const sf::Vector2u size(columns, rows);
+    if (intensity.size() != static_cast<std::size_t>(columns) * rows) return;
+    if (m_texture.getSize() != size) {
+        if (!m_texture.resize(size)) return;
+        m_texture.setSmooth(true);
+        m_pixels.clear();
+    }
+    if (!changed && m_pixels.size() == intensity.size() * 4) return;
+    m_pixels.resize(intensity.size() * 4);
+    constexpr float last_color = static_cast<float>(std::tuple_size_v<decltype(m_palette)> - 1);
+    for (std::size_t i = 0; i < intensity.size(); i++) {
+        const sf::Color& color = m_palette[static_cast<std::size_t>(intensity[i] * last_color)];
+        m_pixels[i * 4] = color.r;
+        m_pixels[i * 4 + 1] = color.g;
+        m_pixels[i * 4 + 2] = color.b;
+        m_pixels[i * 4 + 3] = color.a;
+    }
+    m_texture.update(m_pixels.data());
+}
+/**
+ * @brief draws texture stretched to given rectangle.
+ * @param target is an object for drawing. Probably window.
+ * @param top_left position of top left corner.
+ * @param size size of drawn rectangle.
+ */
+void IntensityTexture::Draw(sf::RenderTarget& target, sf::Vector2f top_left, sf::Vector2f size) const
+{
+    if (m_texture.getSize().x == 0 || m_texture.getSize().y == 0) return;
+    sf::Sprite sprite(m_texture);
+    sprite.setPosition(top_left);
+    sprite.setScale({size.x / m_texture.getSize().x, size.y / m_texture.getSize().y});
+    target.draw(sprite);
+}
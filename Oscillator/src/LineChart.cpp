@@ -1,5 +1,6 @@
 #include "LineChart.h"
 #include "FileReader.h"
+#include "PipelineMetrics.h"
 #include <algorithm>
 
 /**
@@ -10,10 +11,10 @@
  * @param min_Y is min value of Y axis.
  * @param max_Y is max value of Y axis.
  */
-LineChart::LineChart(std::vector<Timestamp> data, float width, float height, sf::Vector2f origin, float min_Y, float max_Y) : 
+LineChart::LineChart(std::span<const Timestamp> data, float width, float height, sf::Vector2f origin, float min_Y, float max_Y) : 
 m_scale_X{1.0}, m_scale_Y{1.0}, m_data_min_Y{min_Y}, m_data_max_Y{max_Y}, m_zoom{1.f}, m_time_span{1.f}
 {
-    m_data = data;
+    m_data.assign(data.begin(), data.end());
     m_width = width;
     m_height = height;
     m_origin = origin;
@@ -28,6 +29,7 @@ m_scale_X{1.0}, m_scale_Y{1.0}, m_data_min_Y{min_Y}, m_data_max_Y{max_Y}, m_zoom
     }
     m_start = m_view_min_time;
     m_end = m_view_max_time;
+    m_last_update = std::chrono::steady_clock::now();
 
     Update_geometry();
 }
@@ -35,22 +37,24 @@ m_scale_X{1.0}, m_scale_Y{1.0}, m_data_min_Y{min_Y}, m_data_max_Y{max_Y}, m_zoom
  * @brief Adds data to the current m_data, and erases the data that is at the end
  * @param new_timestamps new data that will be added to current data.
  */
-void LineChart::Add_data(const std::vector<Timestamp>& new_timestamps)
+void LineChart::Add_data(std::span<const Timestamp> new_timestamps)
 {
     if (new_timestamps.empty()) return;
+    //while archive is shown, new data goes to put aside live data
+    std::vector<Timestamp>& live = m_showing_archive ? m_live_data : m_data;
     constexpr size_t max_data_provided = 40000;
-    if (m_data.size() < max_data_provided){
-            m_data.insert(m_data.end(), new_timestamps.begin(), new_timestamps.end());
-            std::sort(m_data.begin(), m_data.end(), [](const Timestamp& a, const Timestamp& b){
+    if (live.size() < max_data_provided){
+            live.insert(live.end(), new_timestamps.begin(), new_timestamps.end());
+            std::sort(live.begin(), live.end(), [](const Timestamp& a, const Timestamp& b){
                   return a.Get_time() < b.Get_time();
               });
     }
     else {
-        auto it_erase = std::lower_bound(m_data.begin(), m_data.end(), m_view_min_time - 10.f, [](const Timestamp& a, float value){
+        auto it_erase = std::lower_bound(live.begin(), live.end(), m_view_min_time - 10.f, [](const Timestamp& a, float value){
         return a.Get_time() < value;
         });
-        if( it_erase != m_data.end()){
-            m_data.erase(m_data.begin(), it_erase);
+        if( it_erase != live.end()){
+            live.erase(live.begin(), it_erase);
         }
     }
     m_should_scroll = true;
@@ -62,8 +66,44 @@ void LineChart::Add_data(const std::vector<Timestamp>& new_timestamps)
  */
 void LineChart::Reset_data(){
     m_data.clear();
+    m_live_data.clear();
+    m_showing_archive = false;
     m_view_min_time = 0.f;
     m_view_max_time = m_view_min_time + m_time_span;
+    m_loaded_time_span = 0.f;
+}
+
+/**
+ * @brief sets archive from which visible data is loaded while chart is panned.
+ * @param archive is the archive with whole recorded history, can be nullptr.
+ */
+void LineChart::Set_archive(std::shared_ptr<const HistoryArchive> archive)
+{
+    m_archive = std::move(archive);
+    m_loaded_time_span = 0.f;
+}
+
+/**
+ * @brief replaces m_data with archived data around current view, when view left already loaded range.
+ * Range one time span wider on both sides is loaded, so short panning doesn't reload data.
+ */
+void LineChart::Load_visible_archive()
+{
+    if (!m_archive || !m_should_pan || m_archive->Empty()) return;
+    const bool is_covered = m_view_min_time >= m_loaded_min_time && m_view_max_time <= m_loaded_max_time;
+    if (is_covered && m_loaded_time_span == m_time_span) return;
+    m_loaded_min_time = m_view_min_time - m_time_span;
+    m_loaded_max_time = m_view_max_time + m_time_span;
+    m_loaded_time_span = m_time_span;
+    //two points (min & max) per pixel of three loaded widths
+    constexpr int points_per_pixel = 2;
+    constexpr int loaded_widths = 3;
+    const int max_points = static_cast<int>(m_width) * points_per_pixel * loaded_widths;
+    if (!m_showing_archive) {
+        m_live_data.swap(m_data);
+        m_showing_archive = true;
+    }
+    m_data = m_archive->Load_range(m_loaded_min_time, m_loaded_max_time, max_points);
 }
 
 /**
@@ -83,11 +123,17 @@ void LineChart::Update_geometry()
     } else {
         m_scale_Y = m_height / voltage_span;
     }
-    constexpr float scrolling_speed_value = 0.0005f;
+    //view moves by part of its span per second of wall time, so scrolling speed doesn't depend on
+    //frame rate and zoomed view scrolls as before (0.0005 of span per frame at 60 fps)
+    constexpr float scrolling_speed_value = 0.03f;
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
     if( m_should_scroll ){
-        m_view_min_time+=scrolling_speed_value * m_time_span;
-        m_view_max_time+=scrolling_speed_value * m_time_span;
+        const float elapsed = std::chrono::duration<float>(now - m_last_update).count();
+        m_view_min_time+=scrolling_speed_value * m_time_span * elapsed;
+        m_view_max_time+=scrolling_speed_value * m_time_span * elapsed;
     }
+    m_last_update = now;
+    Load_visible_archive();
     auto it_start = std::lower_bound(m_data.begin(), m_data.end(), m_view_min_time, [](const Timestamp& a, float value){
         return a.Get_time() < value;
     });
@@ -112,8 +158,13 @@ void LineChart::Update_geometry()
  */
 void LineChart::Draw(sf::RenderTarget& target)
 {
-    Update_geometry();
+    ScopedStageTimer timer(PipelineStage::RENDER);
+    {
+        TraceScope trace("LineChart::Update_geometry");
+        Update_geometry();
+    }
     Draw_frame(target);
+    TraceScope trace("LineChart::Draw_multiple_lines");
     Draw_multiple_lines(target, m_color_of_chart);
 }
 /**
@@ -177,6 +228,9 @@ void LineChart::Draw_multiple_lines(sf::RenderTarget& target, sf::Color color_of
         vertex.color = color_of_lines;
         segments.append(vertex);
     }
+    PipelineMetrics & metrics = PipelineMetrics::Instance();
+    metrics.Set_gauge(PipelineGauge::VISIBLE_POINTS, (safe_end >= safe_start) ? safe_end - safe_start + 1 : 0);
+    metrics.Set_gauge(PipelineGauge::VERTEX_COUNT, segments.getVertexCount());
     if(segments.getVertexCount() > 0){
             target.draw(segments);
     }
@@ -338,13 +392,28 @@ void LineChart::Set_origin(sf::Vector2f new_origin)
     m_origin = new_origin;
 }
 
+/**
+ * @brief starts or stops scrolling, started scrolling continues from the newest data.
+ * @param should_scroll true to start scrolling.
+ */
 void LineChart::Set_scrolling(bool should_scroll)
 {
+    if (should_scroll && !m_should_scroll && !m_data.empty()) {
+        m_view_max_time = m_data.back().Get_time();
+        m_view_min_time = m_view_max_time - m_time_span;
+    }
     m_should_scroll = should_scroll;
+    m_last_update = std::chrono::steady_clock::now();
 }
 void LineChart::Set_panning(bool should_pan)
 {
     m_should_pan = should_pan;
+    m_loaded_time_span = 0.f;
+    if (!m_should_pan && m_showing_archive) {
+        m_data.swap(m_live_data);
+        m_live_data.clear();
+        m_showing_archive = false;
+    }
 }
 
 void LineChart::Set_color(sf::Color new_color)
@@ -366,9 +435,17 @@ void LineChart::Set_max_X(float new_max_X)
  */
 void LineChart::Set_pan(float pan_value)
 {
-    if((m_view_min_time < m_data.front().Get_time() && pan_value > 0) 
-    || (m_view_max_time > m_data.back().Get_time() && pan_value < 0) 
-    || (m_view_min_time > m_data.front().Get_time() && m_view_max_time < m_data.back().Get_time())){
+    if (m_data.empty()) return;
+    double data_min_time = m_data.front().Get_time();
+    double data_max_time = m_data.back().Get_time();
+    if (m_archive && !m_archive->Empty()) {
+        const RangeParams archived = m_archive->Get_recording_params();
+        data_min_time = archived.Get_min_time();
+        data_max_time = archived.Get_max_time();
+    }
+    if((m_view_min_time < data_min_time && pan_value > 0) 
+    || (m_view_max_time > data_max_time && pan_value < 0) 
+    || (m_view_min_time > data_min_time && m_view_max_time < data_max_time)){
         m_view_min_time+=pan_value;
         m_view_max_time+=pan_value;
     }
@@ -0,0 +1,322 @@
+#include "MathChannel.h"
+#include "PipelineMetrics.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+bool is_before(const Timestamp & a, double time)
+{
+    return a.Get_time() < time;
+}
+
+bool is_after(double time, const Timestamp & a)
+{
+    return time < a.Get_time();
+}
+}
+
+/**
+ * @brief MathChannel constructor
+ * @param operation evaluated expression
+ * @param a history of channel A, has to outlive math channel
+ * @param b history of channel B, needed by binary operations, has to outlive math channel
+ * @throw std::runtime_error if binary operation has no channel B
+ */
+MathChannel::MathChannel(MathOperation operation, const RecordingHistory & a, const RecordingHistory * b)
+    : _operation(operation), _a(a), _b(b)
+{
+    if (Is_binary(_operation) && _b == nullptr)
+    {
+        throw std::runtime_error("Math channel needs channel B");
+    }
+}
+
+/**
+ * @brief Evaluate
+ * @param min_time begin of requested time range
+ * @param max_time end of requested time range
+ * @param out timestamps of result within requested range, in time order
+ * @note binary operations interpolate B at times of A, so result has samples of A covered by B
+ */
+void MathChannel::Evaluate(double min_time, double max_time, std::vector<Timestamp> & out)
+{
+    TraceScope trace("MathChannel::Evaluate");
+    out.clear();
+    const RecordingHistory::type & intervals = _a.Get_container();
+    const std::uint64_t first_sequence = _a.Get_pushed_intervals() - intervals.size();
+    //intervals evicted from history are never requested again
+    const auto live = _cache.lower_bound(first_sequence);
+    if (live != _cache.begin() && std::prev(live)->first + 1 == first_sequence)
+    {
+        //integral continues from end of the newest evicted interval
+        _evicted_end_value = std::prev(live)->second._end_value;
+    }
+    _cache.erase(_cache.begin(), live);
+
+    std::uint64_t sequence = first_sequence;
+    const RecordingVector * previous = nullptr;
+    double start_value = _evicted_end_value;
+    for (const RecordingVector & vec : intervals)
+    {
+        const RangeParams params = vec.Get_recording_params();
+        const bool is_visible = params.Get_max_time() >= min_time && params.Get_min_time() <= max_time;
+        //integral of visible interval starts at end value of all intervals before it
+        const bool is_needed = is_visible || (_operation == MathOperation::INTEGRAL && params.Get_min_time() <= max_time);
+        const Block * block = nullptr;
+        if (const auto cached = _cache.find(sequence); cached != _cache.end())
+        {
+            block = &cached->second;
+        }
+        else if (is_needed)
+        {
+            Timestamp last;
+            const Timestamp * last_of_previous = nullptr;
+            if (previous != nullptr && !Is_binary(_operation))
+            {
+                const std::span<const Timestamp> previous_samples = samples_of(*previous, _decompressed);
+                if (!previous_samples.empty())
+                {
+                    last = previous_samples.back();
+                    last_of_previous = &last;
+                }
+            }
+            Block result;
+            if (compute(samples_of(vec, _decompressed), last_of_previous, start_value, result))
+            {
+                block = &(_cache[sequence] = std::move(result));
+            }
+            else
+            {
+                _partial = std::move(result);
+                block = &_partial;
+            }
+        }
+        if (block != nullptr)
+        {
+            start_value = block->_end_value;
+            if (is_visible)
+            {
+                const auto begin = std::lower_bound(block->_data.begin(), block->_data.end(), min_time, is_before);
+                const auto end = std::upper_bound(begin, block->_data.end(), max_time, is_after);
+                out.insert(out.end(), begin, end);
+            }
+        }
+        previous = &vec;
+        sequence++;
+    }
+}
+
+/**
+ * @brief Invalidate
+ * @note drops all cached results, e.g. after sources were replaced, integral starts from zero
+ */
+void MathChannel::Invalidate()
+{
+    _cache.clear();
+    _evicted_end_value = 0.0;
+}
+
+/**
+ * @brief Get_operation
+ * @return evaluated expression
+ */
+MathOperation MathChannel::Get_operation() const
+{
+    return _operation;
+}
+
+/**
+ * @brief Get_cached_intervals
+ * @return number of intervals with cached result
+ */
+std::size_t MathChannel::Get_cached_intervals() const
+{
+    return _cache.size();
+}
+
+/**
+ * @brief Get_computed_intervals
+ * @return number of intervals computed since creation, cache hits are not counted
+ */
+std::uint64_t MathChannel::Get_computed_intervals() const
+{
+    return _computed;
+}
+
+/**
+ * @brief Is_binary
+ * @param operation expression
+ * @return true if expression needs channel B
+ */
+bool MathChannel::Is_binary(MathOperation operation)
+{
+    return operation == MathOperation::ADD || operation == MathOperation::SUBTRACT || operation == MathOperation::MULTIPLY;
+}
+
+/**
+ * @brief Get_name
+ * @param operation expression
+ * @return short name of expression, e.g. "A-B"
+ */
+const char* MathChannel::Get_name(MathOperation operation)
+{
+    switch (operation)
+    {
+    case MathOperation::ADD:
+        return "A+B";
+    case MathOperation::SUBTRACT:
+        return "A-B";
+    case MathOperation::MULTIPLY:
+        return "A*B";
+    case MathOperation::DERIVATIVE:
+        return "dA/dt";
+    case MathOperation::INTEGRAL:
+        return "integral A";
+    }
+    return "";
+}
+
+/**
+ * @brief compute
+ * @param samples samples of interval of channel A
+ * @param previous last sample of previous interval, nullptr if there is none
+ * @param start_value value of integral at start of interval
+ * @param block result
+ * @return true if result is complete and can be cached
+ */
+bool MathChannel::compute(std::span<const Timestamp> samples, const Timestamp * previous, double start_value, Block & block)
+{
+    _computed++;
+    block._data.clear();
+    block._end_value = start_value;
+    if (samples.empty())
+    {
+        return true;
+    }
+    block._data.reserve(samples.size());
+    if (!Is_binary(_operation))
+    {
+        double value = start_value;
+        for (std::size_t i = 0; i < samples.size(); i++)
+        {
+            const Timestamp * before = (i > 0) ? &samples[i - 1] : previous;
+            const double time = samples[i].Get_time();
+            const double elapsed = (before != nullptr) ? time - before->Get_time() : 0.0;
+            if (_operation == MathOperation::DERIVATIVE)
+            {
+                //first sample of recording and samples where time went back have no derivative
+                if (elapsed > 0.0)
+                {
+                    block._data.emplace_back(time, (samples[i].Get_voltage() - before->Get_voltage()) / elapsed);
+                }
+                continue;
+            }
+            if (elapsed > 0.0)
+            {
+                //trapezoidal rule
+                value += 0.5 * (samples[i].Get_voltage() + before->Get_voltage()) * elapsed;
+            }
+            block._data.emplace_back(time, value);
+        }
+        block._end_value = value;
+        return true;
+    }
+
+    collect_b(samples.front().Get_time(), samples.back().Get_time());
+    std::size_t b = 0;
+    for (const Timestamp & sample : samples)
+    {
+        const double time = sample.Get_time();
+        while (b + 1 < _b_samples.size() && _b_samples[b + 1].Get_time() < time)
+        {
+            b++;
+        }
+        if (b + 1 >= _b_samples.size())
+        {
+            break;
+        }
+        const Timestamp & before = _b_samples[b];
+        const Timestamp & after = _b_samples[b + 1];
+        if (time < before.Get_time())
+        {
+            //B was not recorded yet
+            continue;
+        }
+        const double span = after.Get_time() - before.Get_time();
+        const double weight = (span > 0.0) ? (time - before.Get_time()) / span : 0.0;
+        const double b_value = before.Get_voltage() + (after.Get_voltage() - before.Get_voltage()) * weight;
+        double value = 0.0;
+        switch (_operation)
+        {
+        case MathOperation::ADD:
+            value = sample.Get_voltage() + b_value;
+            break;
+        case MathOperation::SUBTRACT:
+            value = sample.Get_voltage() - b_value;
+            break;
+        default:
+            value = sample.Get_voltage() * b_value;
+            break;
+        }
+        block._data.emplace_back(time, value);
+    }
+    //B recorded after this interval can still change result of its end
+    return !_b->Empty() && _b->Get_recording_params().Get_max_time() >= samples.back().Get_time();
+}
+
+/**
+ * @brief collect_b
+ * @param min_time begin of needed range
+ * @param max_time end of needed range
+ * @note copies samples of B around range into _b_samples, one sample outside range on both sides
+ */
+void MathChannel::collect_b(double min_time, double max_time)
+{
+    _b_samples.clear();
+    const RecordingVector * before = nullptr;
+    for (const RecordingVector & vec : _b->Get_container())
+    {
+        const RangeParams params = vec.Get_recording_params();
+        if (params.Get_max_time() < min_time)
+        {
+            before = &vec;
+            continue;
+        }
+        if (_b_samples.empty() && before != nullptr)
+        {
+            const std::span<const Timestamp> before_samples = samples_of(*before, _decompressed_b);
+            if (!before_samples.empty())
+            {
+                _b_samples.push_back(before_samples.back());
+            }
+        }
+        const std::span<const Timestamp> vec_samples = samples_of(vec, _decompressed_b);
+        if (params.Get_min_time() > max_time)
+        {
+            if (!vec_samples.empty())
+            {
+                _b_samples.push_back(vec_samples.front());
+            }
+            break;
+        }
+        _b_samples.insert(_b_samples.end(), vec_samples.begin(), vec_samples.end());
+    }
+}
+
+/**
+ * @brief samples_of
+ * @param vec interval
+ * @param scratch buffer for decompressed interval
+ * @return samples of interval
+ */
+std::span<const Timestamp> MathChannel::samples_of(const RecordingVector & vec, RecordingVector::type & scratch)
+{
+    if (vec.Is_compressed())
+    {
+        scratch = vec.Decompress();
+        return scratch;
+    }
+    return vec.Get_container();
+}
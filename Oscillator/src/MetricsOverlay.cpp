@@ -0,0 +1,173 @@
+#include "MetricsOverlay.h"
+#include "imgui.h"
+#include "implot.h"
+
+/**
+ * @brief constructor
+ * @param refresh_period how often statistics are taken from PipelineMetrics
+ */
+MetricsOverlay::MetricsOverlay(std::chrono::milliseconds refresh_period) :
+m_visible{true}, m_refresh_period{refresh_period}, m_rates{}, m_frame_times{}, m_frame_offset{0}
+{
+    m_last_refresh = std::chrono::steady_clock::now();
+    m_last_frame = m_last_refresh;
+    m_snapshot = PipelineMetrics::Instance().Get_snapshot();
+}
+/**
+ * @brief draws overlay window.
+ * @note has to be called between ImGui::SFML::Update and ImGui::SFML::Render
+ */
+void MetricsOverlay::Draw()
+{
+    const auto now = std::chrono::steady_clock::now();
+    m_frame_times[m_frame_offset] = std::chrono::duration<float, std::milli>(now - m_last_frame).count();
+    m_frame_offset = (m_frame_offset + 1) % frame_history;
+    m_last_frame = now;
+
+    //snapshot locks registry of threads, so it is not taken every frame
+    if (now - m_last_refresh >= m_refresh_period)
+    {
+        MetricsSnapshot snapshot = PipelineMetrics::Instance().Get_snapshot();
+        const double elapsed = std::chrono::duration<double>(now - m_last_refresh).count();
+        for (std::size_t c = 0; c < pipeline_counters; c++)
+        {
+            //counters go back to zero after Reset
+            const std::uint64_t previous = (snapshot._counters[c] >= m_snapshot._counters[c]) ? m_snapshot._counters[c] : 0;
+            m_rates[c] = (snapshot._counters[c] - previous) / elapsed;
+        }
+        m_snapshot = std::move(snapshot);
+        m_last_refresh = now;
+    }
+
+    if (!m_visible)
+    {
+        return;
+    }
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (ImGui::Begin("Pipeline metrics", &m_visible, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        Draw_stages();
+        Draw_counters();
+        Draw_threads();
+        Draw_frame_times();
+        if (ImGui::Button("Reset"))
+        {
+            PipelineMetrics::Instance().Reset();
+        }
+    }
+    ImGui::End();
+}
+/**
+ * @brief draws table with latency of pipeline stages.
+ */
+void MetricsOverlay::Draw_stages() const
+{
+    if (!ImGui::BeginTable("stages", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        return;
+    }
+    ImGui::TableSetupColumn("stage");
+    ImGui::TableSetupColumn("count");
+    ImGui::TableSetupColumn("mean [us]");
+    ImGui::TableSetupColumn("p50 [us]");
+    ImGui::TableSetupColumn("p99 [us]");
+    ImGui::TableSetupColumn("max [us]");
+    ImGui::TableHeadersRow();
+    for (std::size_t s = 0; s < pipeline_stages; s++)
+    {
+        const StageSnapshot & stage = m_snapshot._stages[s];
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(Get_stage_name(static_cast<PipelineStage>(s)));
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(stage._count));
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", stage.Get_mean_ns() / 1000.0);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", stage.Get_percentile_ns(0.5) / 1000.0);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", stage.Get_percentile_ns(0.99) / 1000.0);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", stage._max_ns / 1000.0);
+    }
+    ImGui::EndTable();
+}
+/**
+ * @brief draws counters, their rates and gauges.
+ */
+void MetricsOverlay::Draw_counters() const
+{
+    for (std::size_t c = 0; c < pipeline_counters; c++)
+    {
+        ImGui::Text("%-18s %12llu  (%.1f/s)", Get_counter_name(static_cast<PipelineCounter>(c)),
+                    static_cast<unsigned long long>(m_snapshot._counters[c]), m_rates[c]);
+    }
+    ImGui::Text("%-18s %12lld", "vertices", static_cast<long long>(m_snapshot._gauges[static_cast<std::size_t>(PipelineGauge::VERTEX_COUNT)]));
+    ImGui::Text("%-18s %12lld", "visible points", static_cast<long long>(m_snapshot._gauges[static_cast<std::size_t>(PipelineGauge::VISIBLE_POINTS)]));
+    ImGui::Text("%-18s %12lld", "queued blocks", static_cast<long long>(m_snapshot._gauges[static_cast<std::size_t>(PipelineGauge::QUEUE_DEPTH)]));
+    ImGui::Text("%-18s %12lld", "summary pending", static_cast<long long>(m_snapshot._gauges[static_cast<std::size_t>(PipelineGauge::SUMMARY_PENDING)]));
+}
+/**
+ * @brief draws table with statistics of every thread.
+ */
+void MetricsOverlay::Draw_threads() const
+{
+    if (!ImGui::CollapsingHeader("Threads"))
+    {
+        return;
+    }
+    if (!ImGui::BeginTable("threads", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        return;
+    }
+    ImGui::TableSetupColumn("thread");
+    ImGui::TableSetupColumn("measurements");
+    ImGui::TableSetupColumn("points");
+    ImGui::TableHeadersRow();
+    for (const ThreadSnapshot & thread : m_snapshot._threads)
+    {
+        std::uint64_t measurements = 0;
+        for (std::uint64_t count : thread._stage_counts)
+        {
+            measurements += count;
+        }
+        const std::uint64_t points = thread._counters[static_cast<std::size_t>(PipelineCounter::POINTS_GENERATED)]
+                                   + thread._counters[static_cast<std::size_t>(PipelineCounter::POINTS_PARSED)];
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(thread._name.c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(measurements));
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(points));
+    }
+    ImGui::EndTable();
+}
+/**
+ * @brief draws plot of recent frame times.
+ */
+void MetricsOverlay::Draw_frame_times() const
+{
+    if (ImPlot::BeginPlot("##frame_times", ImVec2(420.f, 120.f)))
+    {
+        ImPlot::SetupAxes(nullptr, "ms", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxisLimits(ImAxis_X1, 0, frame_history, ImPlotCond_Always);
+        ImPlot::PlotLine("frame time", m_frame_times.data(), frame_history, 1.0, 0.0, 0, m_frame_offset);
+        ImPlot::EndPlot();
+    }
+}
+/**
+ * @brief shows or hides overlay.
+ * @param visible true to show overlay.
+ */
+void MetricsOverlay::Set_visible(bool visible)
+{
+    m_visible = visible;
+}
+/**
+ * @brief checks if overlay is shown.
+ */
+bool MetricsOverlay::Is_visible() const
+{
+    return m_visible;
+}
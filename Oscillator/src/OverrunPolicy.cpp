@@ -0,0 +1,124 @@
+#include "OverrunPolicy.h"
+#include <algorithm>
+
+/**
+ * @brief Get_overrun_policy_name
+ * @param policy overrun policy
+ * @return name of policy, as accepted by Parse_overrun_policy()
+ */
+const char* Get_overrun_policy_name(OverrunPolicy policy)
+{
+    switch (policy)
+    {
+        case OverrunPolicy::BLOCK:       return "block";
+        case OverrunPolicy::DROP_OLDEST: return "drop-oldest";
+        case OverrunPolicy::DROP_NEWEST: return "drop-newest";
+        case OverrunPolicy::DECIMATE:    return "decimate";
+        default:                         return "unknown";
+    }
+}
+
+/**
+ * @brief Parse_overrun_policy
+ * @param name "block", "drop-oldest", "drop-newest" or "decimate"
+ * @return policy, empty if name is unknown
+ */
+std::optional<OverrunPolicy> Parse_overrun_policy(std::string_view name)
+{
+    for (OverrunPolicy policy : {OverrunPolicy::BLOCK, OverrunPolicy::DROP_OLDEST,
+                                 OverrunPolicy::DROP_NEWEST, OverrunPolicy::DECIMATE})
+    {
+        if (name == Get_overrun_policy_name(policy))
+        {
+            return policy;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Get_decimation_factor
+ * @param load fill of transport, 0.0 empty, 1.0 full
+ * @return 1 while transport is less than half full, 2 up to three quarters, 4 above
+ */
+int Get_decimation_factor(double load)
+{
+    if (load < 0.5)
+    {
+        return 1;
+    }
+    return (load < 0.75) ? 2 : 4;
+}
+
+/**
+ * @brief Decimate_values
+ * @param values samples of interval
+ * @param factor every factor-th sample is kept, last one is always kept
+ * @param out kept samples, it is cleared first
+ */
+void Decimate_values(std::span<const double> values, int factor, std::vector<double> & out)
+{
+    out.clear();
+    const std::size_t step = static_cast<std::size_t>(std::max(factor, 1));
+    out.reserve(values.size() / step + 2);
+    for (std::size_t i = 0; i < values.size(); i += step)
+    {
+        out.push_back(values[i]);
+    }
+    //interval keeps its end, so time base of reader doesn't shift
+    if (!values.empty() && (values.size() - 1) % step != 0)
+    {
+        out.push_back(values.back());
+    }
+}
+
+/**
+ * @brief Decimate_interval
+ * @param interval interval to decimate, compressed one is decompressed
+ * @param factor every factor-th timestamp is kept, last one is always kept
+ * @return decimated copy of interval with the same time range
+ */
+RecordingVector Decimate_interval(const RecordingVector & interval, int factor)
+{
+    const RecordingVector::type raw = interval.Is_compressed() ? interval.Decompress() : RecordingVector::type();
+    const RecordingVector::type & data = interval.Is_compressed() ? raw : interval.Get_container();
+    RecordingVector decimated;
+    RecordingVector::type & out = decimated.Get_container();
+    const std::size_t step = static_cast<std::size_t>(std::max(factor, 1));
+    out.reserve(data.size() / step + 2);
+    for (std::size_t i = 0; i < data.size(); i += step)
+    {
+        out.push_back(data[i]);
+    }
+    //time range stays the same, so next interval continues where this one ends
+    if (!data.empty() && (data.size() - 1) % step != 0)
+    {
+        out.push_back(data.back());
+    }
+    const RangeParams params = interval.Get_recording_params();
+    decimated.Set_recording_params(RangeParams({params.Get_min_voltage(), params.Get_max_voltage()},
+        {params.Get_min_time(), params.Get_max_time()}, static_cast<int>(out.size())));
+    return decimated;
+}
+
+/**
+ * @brief Check
+ * @param sequence sequence number of received interval
+ * @return number of intervals missing before it, 0 after Reset() or when producer restarted
+ */
+std::uint64_t GapDetector::Check(std::uint64_t sequence)
+{
+    const std::uint64_t lost = (_started && sequence > _next_sequence) ? sequence - _next_sequence : 0;
+    _next_sequence = sequence + 1;
+    _started = true;
+    return lost;
+}
+
+/**
+ * @brief Reset
+ * @note next checked interval starts new sequence
+ */
+void GapDetector::Reset()
+{
+    _started = false;
+}
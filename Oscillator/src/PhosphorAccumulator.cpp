@@ -0,0 +1,299 @@
+#include "PhosphorAccumulator.h"
+#include "PipelineMetrics.h"
+#include <algorithm>
+
+/**
+ * @brief PhosphorAccumulator constructor
+ * @param settings parameters of accumulation
+ */
+PhosphorAccumulator::PhosphorAccumulator(const PhosphorSettings & settings)
+    : _settings(settings), _grid(settings._columns, settings._rows),
+    _last_decay(clock::now())
+{
+    //Empty
+}
+
+/**
+ * @brief Push
+ * @param timestamps new timestamps in time order, copied to input buffer, ignored when stopped
+ */
+void PhosphorAccumulator::Push(std::span<const Timestamp> timestamps)
+{
+    if (timestamps.empty() || _stop_flag)
+    {
+        //stopped accumulator does not collect input
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_input_mutex);
+        _input.insert(_input.end(), timestamps.begin(), timestamps.end());
+    }
+    _input_cv.notify_one();
+}
+
+/**
+ * @brief Set_settings
+ * @param settings new parameters, histogram is cleared if its geometry changed
+ */
+void PhosphorAccumulator::Set_settings(const PhosphorSettings & settings)
+{
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    const bool geometry_changed = settings._columns != _settings._columns || settings._rows != _settings._rows
+        || settings._sweep_time != _settings._sweep_time || settings._pretrigger != _settings._pretrigger
+        || settings._min_voltage != _settings._min_voltage || settings._max_voltage != _settings._max_voltage;
+    _settings = settings;
+    _settings._pretrigger = std::clamp(_settings._pretrigger, 0.0, 0.9);
+    if (geometry_changed)
+    {
+        _grid.Resize(_settings._columns, _settings._rows);
+    }
+}
+
+/**
+ * @brief Get_settings
+ * @return current parameters
+ */
+PhosphorSettings PhosphorAccumulator::Get_settings() const
+{
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    return _settings;
+}
+
+/**
+ * @brief Copy_intensity
+ * @param out row-major intensities from 0.0 to 1.0 (log scaled hits), first row is max voltage
+ * @return true if histogram changed since last copy
+ */
+bool PhosphorAccumulator::Copy_intensity(std::vector<float> & out)
+{
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    if (!_stop_flag)
+    {
+        decay(clock::now());
+    }
+    return _grid.Copy_intensity(out);
+}
+
+/**
+ * @brief Get_sweep_count
+ * @return number of sweeps accumulated since creation
+ */
+std::uint64_t PhosphorAccumulator::Get_sweep_count() const
+{
+    return _sweeps;
+}
+
+/**
+ * @brief Clear
+ * @note clears histogram and not processed input
+ */
+void PhosphorAccumulator::Clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(_input_mutex);
+        _input.clear();
+    }
+    _reset_work = true;
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    _grid.Clear();
+}
+
+/**
+ * @brief decay
+ * @param now current time
+ * @note multiplies histogram by factor of time elapsed since last decay, needs _grid_mutex
+ */
+void PhosphorAccumulator::decay(clock::time_point now)
+{
+    const double elapsed = std::chrono::duration<double>(now - _last_decay).count();
+    _last_decay = now;
+    _grid.Decay(elapsed, _settings._half_life);
+}
+
+/**
+ * @brief bin_sweep
+ * @param first index of first sample of sweep in _work
+ * @param last index after last sample of sweep in _work
+ * @param origin time of left edge of sweep
+ * @param settings parameters of accumulation
+ */
+void PhosphorAccumulator::bin_sweep(std::size_t first, std::size_t last, double origin, const PhosphorSettings & settings)
+{
+    const std::size_t count = last - first;
+    _bins.resize(count);
+    const Timestamp * samples = _work.data() + first;
+    std::int32_t * bins = _bins.data();
+    const std::int32_t columns = settings._columns;
+    const std::int32_t rows = settings._rows;
+    const double column_scale = columns / settings._sweep_time;
+    const double row_scale = rows / (settings._max_voltage - settings._min_voltage);
+    const double max_voltage = settings._max_voltage;
+    //compiler vectorises this loop, out of range samples get bin -1
+    for (std::size_t i = 0; i < count; i++)
+    {
+        bins[i] = DensityGrid::Bin_of((samples[i].Get_time() - origin) * column_scale,
+                                      (max_voltage - samples[i].Get_voltage()) * row_scale, columns, rows);
+    }
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    if (_grid.Get_columns() != columns || _grid.Get_rows() != rows)
+    {
+        //geometry changed during pass
+        return;
+    }
+    _grid.Add_hits(_bins);
+}
+
+/**
+ * @brief accumulate
+ * @param settings parameters copied at begin of pass
+ * @note finds triggers in _work and bins every complete sweep
+ */
+void PhosphorAccumulator::accumulate(const PhosphorSettings & settings)
+{
+    TraceScope trace("PhosphorAccumulator::accumulate");
+    const double pre_time = settings._sweep_time * settings._pretrigger;
+    const double post_time = settings._sweep_time - pre_time;
+    const double level = settings._trigger_level;
+    const auto time_less = [](const Timestamp & sample, double time) { return sample.Get_time() < time; };
+    std::size_t i = std::max<std::size_t>(_scan_from, 1);
+    while (i < _work.size())
+    {
+        const bool crossed = settings._rising_edge
+            ? (_work[i - 1].Get_voltage() < level && _work[i].Get_voltage() >= level)
+            : (_work[i - 1].Get_voltage() > level && _work[i].Get_voltage() <= level);
+        if (!crossed)
+        {
+            i++;
+            continue;
+        }
+        const double trigger_time = _work[i].Get_time();
+        const double end_time = trigger_time + post_time;
+        if (_work.back().Get_time() < end_time)
+        {
+            //sweep not complete yet, trigger is found again in next pass
+            break;
+        }
+        const std::size_t first = std::lower_bound(_work.begin(), _work.begin() + i, trigger_time - pre_time, time_less) - _work.begin();
+        const std::size_t last = std::lower_bound(_work.begin() + i, _work.end(), end_time, time_less) - _work.begin();
+        bin_sweep(first, last, trigger_time - pre_time, settings);
+        _sweeps++;
+        //hold off, next trigger is searched after end of this sweep
+        i = std::max(last, i + 1);
+    }
+    _scan_from = i;
+    //keeps samples needed as pretrigger part of sweep and previous sample for edge detection
+    if (_work.empty())
+    {
+        return;
+    }
+    const double keep_from_time = _work[std::min(_scan_from, _work.size() - 1)].Get_time() - pre_time;
+    std::size_t keep = std::lower_bound(_work.begin(), _work.end(), keep_from_time, time_less) - _work.begin();
+    keep = std::min(keep, _scan_from > 0 ? _scan_from - 1 : 0);
+    _work.erase(_work.begin(), _work.begin() + keep);
+    _scan_from -= keep;
+}
+
+/**
+ * @brief running_loop
+ * @note loop in which input is accumulated
+ */
+void PhosphorAccumulator::running_loop(void)
+{
+    if (!_running)
+    {
+        const std::chrono::duration sleep_time_stopped = std::chrono::milliseconds(100);
+        const std::chrono::duration input_wait = std::chrono::milliseconds(10);
+        PipelineMetrics::Instance().Set_thread_name("PhosphorAccumulator");
+        _running = true;
+        _destroyed = false;
+        while (!_destroy_flag)
+        {
+            if (_stop_flag)
+            {
+                std::this_thread::sleep_for(sleep_time_stopped);
+                continue;
+            }
+            {
+                std::unique_lock<std::mutex> lock(_input_mutex);
+                _input_cv.wait_for(lock, input_wait, [this] { return !_input.empty() || _destroy_flag; });
+                _block.clear();
+                _input.swap(_block);
+            }
+            if (_reset_work.exchange(false))
+            {
+                _work.clear();
+                _scan_from = 0;
+            }
+            if (_block.empty())
+            {
+                continue;
+            }
+            if (!_work.empty() && _block.front().Get_time() < _work.back().Get_time())
+            {
+                //time went back (new recording), old samples do not belong to it
+                _work.clear();
+                _scan_from = 0;
+            }
+            _work.insert(_work.end(), _block.begin(), _block.end());
+            PhosphorSettings settings;
+            {
+                std::lock_guard<std::mutex> lock(_grid_mutex);
+                decay(clock::now());
+                settings = _settings;
+            }
+            accumulate(settings);
+        }
+        _running = false;
+        _destroyed = true;
+    }
+}
+
+/**
+ * @brief Start
+ * @note starts execution of accumulator thread
+ */
+void PhosphorAccumulator::Start()
+{
+    _destroy_flag = false;
+    _thread = std::thread(&PhosphorAccumulator::running_loop, this);
+}
+
+/**
+ * @brief Stop
+ * @note stops accumulation and decay, histogram is kept
+ */
+void PhosphorAccumulator::Stop()
+{
+    _stop_flag = true;
+}
+
+/**
+ * @brief Resume
+ * @note resumes execution after Stop() was called
+ */
+void PhosphorAccumulator::Resume()
+{
+    {
+        //time of stop does not count to decay
+        std::lock_guard<std::mutex> lock(_grid_mutex);
+        _last_decay = clock::now();
+    }
+    _stop_flag = false;
+}
+
+/**
+ * @brief Destroy
+ * @note destroys thread, after this new thread with Start() can be created
+ */
+void PhosphorAccumulator::Destroy()
+{
+    _destroy_flag = true;
+    _input_cv.notify_one();
+    if (_thread.joinable())
+        _thread.join();
+}
+
+PhosphorAccumulator::~PhosphorAccumulator()
+{
+    Destroy();
+}
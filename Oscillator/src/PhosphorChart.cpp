@@ -0,0 +1,211 @@
+#include "PhosphorChart.h"
+#include "PipelineMetrics.h"
+#include <algorithm>
+
+/**
+ * @brief constructor with parameters
+ * @param data is data that will be passed as charts default data
+ * @param width is the width of the drawing area
+ * @param height is the height of the drawing area
+ * @param origin is the position of left bottom corner of a chart.
+ * @param min_Y is min value of Y axis.
+ * @param max_Y is max value of Y axis.
+ * @param settings parameters of accumulation, voltage range is taken from min_Y and max_Y.
+ */
+PhosphorChart::PhosphorChart(std::span<const Timestamp> data, float width, float height, sf::Vector2f origin, float min_Y, float max_Y, const PhosphorSettings & settings) :
+m_accumulator{settings}, m_data_min_Y{min_Y}, m_data_max_Y{max_Y}, m_base_time_span{static_cast<float>(settings._sweep_time)},
+m_time_span{static_cast<float>(settings._sweep_time)}, m_zoom{1.f}
+{
+    m_width = width;
+    m_height = height;
+    m_origin = origin;
+    m_padding = 10.f;
+    m_should_scroll = true;
+    PhosphorSettings range = settings;
+    range._min_voltage = min_Y;
+    range._max_voltage = max_Y;
+    m_accumulator.Set_settings(range);
+    Set_color(sf::Color(255, 0, 0));
+    m_accumulator.Start();
+    Add_data(data);
+}
+/**
+ * @brief passes data to accumulator.
+ * @param new_timestamps new data that will be added to current data.
+ */
+void PhosphorChart::Add_data(std::span<const Timestamp> new_timestamps)
+{
+    m_accumulator.Push(new_timestamps);
+}
+/**
+ * @brief draws histogram of sweeps as a texture.
+ * @param target is an object for drawing. Probably window.
+ */
+void PhosphorChart::Draw(sf::RenderTarget& target)
+{
+    ScopedStageTimer timer(PipelineStage::RENDER);
+    const PhosphorSettings settings = m_accumulator.Get_settings();
+    {
+        TraceScope trace("PhosphorChart::Update_texture");
+        const bool changed = m_accumulator.Copy_intensity(m_intensity);
+        m_texture.Update(m_intensity, settings._columns, settings._rows, changed);
+    }
+    PipelineMetrics::Instance().Set_gauge(PipelineGauge::VERTEX_COUNT, 4);
+    const float window_height = target.getSize().y;
+    const sf::Vector2f top_left(m_origin.x + m_padding, window_height - m_origin.y - m_height);
+    sf::RectangleShape frame({m_width, m_height});
+    frame.setPosition(top_left);
+    frame.setFillColor(m_texture.Get_background());
+    frame.setOutlineColor(sf::Color(0, 0, 100));
+    frame.setOutlineThickness(1.f);
+    target.draw(frame);
+    m_texture.Draw(target, top_left, {m_width, m_height});
+    //trigger point and trigger level
+    const float trigger_x = top_left.x + m_width * static_cast<float>(settings._pretrigger);
+    const float trigger_y = top_left.y + m_height * static_cast<float>((m_data_max_Y - settings._trigger_level) / (m_data_max_Y - m_data_min_Y));
+    constexpr sf::Color marker_color = sf::Color(0, 0, 255);
+    sf::VertexArray markers(sf::PrimitiveType::Lines, 4);
+    markers[0] = sf::Vertex{{trigger_x, top_left.y}, marker_color};
+    markers[1] = sf::Vertex{{trigger_x, top_left.y + m_height}, marker_color};
+    markers[2] = sf::Vertex{{top_left.x, trigger_y}, marker_color};
+    markers[3] = sf::Vertex{{top_left.x + m_width, trigger_y}, marker_color};
+    target.draw(markers);
+}
+/**
+ * @brief clears accumulated sweeps and accumulates given data.
+ */
+void PhosphorChart::Set_data(std::vector<Timestamp> data)
+{
+    m_accumulator.Clear();
+    Add_data(data);
+}
+bool PhosphorChart::Is_cursor_on_chart(sf::RenderTarget& target) const
+{
+    float window_height = target.getSize().y;
+    if( m_cursor_position.x < m_origin.x || m_cursor_position.x > (m_origin.x+m_width)){
+        return false;
+    }
+    if( m_cursor_position.y < (window_height - m_origin.y - m_height) || m_cursor_position.y > (window_height - m_origin.y)){
+        return false;
+    }
+    return true;
+}
+/**
+ * @brief clears accumulated sweeps.
+ */
+void PhosphorChart::Reset_data()
+{
+    m_accumulator.Clear();
+}
+/**
+ * @brief phosphor view shows only live sweeps, archive is not used.
+ */
+void PhosphorChart::Set_archive(std::shared_ptr<const HistoryArchive>)
+{
+    //Empty
+}
+[[nodiscard]] sf::Vector2i PhosphorChart::Get_cursor() const
+{
+    return m_cursor_position;
+}
+[[nodiscard]] float PhosphorChart::Get_width() const
+{
+    return m_width;
+}
+[[nodiscard]] float PhosphorChart::Get_height() const
+{
+    return m_height;
+}
+[[nodiscard]] float PhosphorChart::Get_zoom() const
+{
+    return m_zoom;
+}
+[[nodiscard]] float PhosphorChart::Get_scrolling() const
+{
+    return m_should_scroll;
+}
+/**
+ * @brief trigger point can be moved while sweeps are accumulated.
+ */
+[[nodiscard]] float PhosphorChart::Get_panning() const
+{
+    return m_should_scroll;
+}
+[[nodiscard]] float PhosphorChart::Get_time_span() const
+{
+    return m_time_span;
+}
+[[nodiscard]] std::uint64_t PhosphorChart::Get_sweep_count() const
+{
+    return m_accumulator.Get_sweep_count();
+}
+void PhosphorChart::Set_cursor(sf::Vector2i position)
+{
+    m_cursor_position = position;
+}
+void PhosphorChart::Set_width(float new_width)
+{
+    m_width = new_width;
+}
+void PhosphorChart::Set_height(float new_height)
+{
+    m_height = new_height;
+}
+/**
+ * @brief sets zoom, length of sweep is base time span divided by zoom.
+ * @param new_zoom zoom from 1.0 to 16.0
+ */
+void PhosphorChart::Set_zoom(float new_zoom)
+{
+    constexpr float min_zoom = 1.f;
+    constexpr float max_zoom = 16.f;
+    if (new_zoom < min_zoom || new_zoom > max_zoom) return;
+    m_zoom = new_zoom;
+    m_time_span = m_base_time_span / m_zoom;
+    PhosphorSettings settings = m_accumulator.Get_settings();
+    settings._sweep_time = m_time_span;
+    m_accumulator.Set_settings(settings);
+}
+void PhosphorChart::Set_origin(sf::Vector2f new_origin)
+{
+    m_origin = new_origin;
+}
+/**
+ * @brief stops accumulation (histogram stays as it is) or resumes it.
+ * @param should_scroll false freezes histogram.
+ */
+void PhosphorChart::Set_scrolling(bool should_scroll)
+{
+    if (should_scroll == m_should_scroll) return;
+    m_should_scroll = should_scroll;
+    if (m_should_scroll) {
+        m_accumulator.Resume();
+    } else {
+        m_accumulator.Stop();
+    }
+}
+void PhosphorChart::Set_panning(bool should_pan)
+{
+    m_should_pan = should_pan;
+}
+/**
+ * @brief Sets color of the most hit bins, palette goes from background through it to white.
+ * @param new_color a color to which chart will be set.
+ */
+void PhosphorChart::Set_color(sf::Color new_color)
+{
+    m_color_of_chart = new_color;
+    m_texture.Set_color(new_color);
+}
+/**
+ * @brief Moves trigger point within the sweep, histogram is cleared.
+ * @param pan_value time by which trigger point is moved.
+ * @note ignored while accumulation is stopped, so frozen histogram is kept.
+ */
+void PhosphorChart::Set_pan(float pan_value)
+{
+    if (!m_should_scroll) return;
+    PhosphorSettings settings = m_accumulator.Get_settings();
+    settings._pretrigger = std::clamp(settings._pretrigger + pan_value / m_time_span, 0.0, 0.9);
+    m_accumulator.Set_settings(settings);
+}
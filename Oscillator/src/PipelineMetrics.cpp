@@ -0,0 +1,236 @@
+#include "PipelineMetrics.h"
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+//statistics of calling thread, set on first use
+thread_local void * local_metrics = nullptr;
+
+/**
+ * @brief increase
+ * @note only owning thread writes, so load and store is enough
+ */
+void increase(std::atomic_uint64_t & value, std::uint64_t n)
+{
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+}
+
+/**
+ * @brief Get_stage_name
+ * @param stage stage of pipeline
+ * @return readable name of stage
+ */
+const char* Get_stage_name(PipelineStage stage)
+{
+    switch (stage)
+    {
+        case PipelineStage::GENERATE:   return "generate";
+        case PipelineStage::WRITE:      return "write";
+        case PipelineStage::DETECT:     return "detect";
+        case PipelineStage::PARSE:      return "parse";
+        case PipelineStage::FILTER:     return "filter";
+        case PipelineStage::PUSH:       return "push";
+        case PipelineStage::SUMMARIZE:  return "summarize";
+        case PipelineStage::INDEX:      return "index";
+        case PipelineStage::RENDER:     return "render";
+        case PipelineStage::FRAME:      return "frame";
+        default:                        return "unknown";
+    }
+}
+
+/**
+ * @brief Get_counter_name
+ * @param counter counter of pipeline
+ * @return readable name of counter
+ */
+const char* Get_counter_name(PipelineCounter counter)
+{
+    switch (counter)
+    {
+        case PipelineCounter::POINTS_GENERATED:    return "points generated";
+        case PipelineCounter::POINTS_PARSED:       return "points parsed";
+        case PipelineCounter::INTERVALS_PUSHED:    return "intervals pushed";
+        case PipelineCounter::BLOCKS_DROPPED:      return "blocks dropped";
+        case PipelineCounter::INTERVALS_OVERRUN:   return "intervals overrun";
+        case PipelineCounter::INTERVALS_DECIMATED: return "intervals decimated";
+        case PipelineCounter::FRAMES:              return "frames";
+        default:                                   return "unknown";
+    }
+}
+
+/**
+ * @brief Get_mean_ns
+ * @return mean duration in nanoseconds
+ */
+double StageSnapshot::Get_mean_ns() const
+{
+    return (_count == 0) ? 0.0 : static_cast<double>(_total_ns) / _count;
+}
+
+/**
+ * @brief Get_percentile_ns
+ * @param percentile value from 0.0 to 1.0
+ * @return upper bound of histogram bucket with requested percentile
+ */
+std::uint64_t StageSnapshot::Get_percentile_ns(double percentile) const
+{
+    if (_count == 0)
+    {
+        return 0;
+    }
+    const std::uint64_t rank = static_cast<std::uint64_t>(percentile * (_count - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (int b = 0; b < buckets; b++)
+    {
+        seen += _histogram[b];
+        if (seen >= rank)
+        {
+            return std::min(std::uint64_t(1) << b, _max_ns);
+        }
+    }
+    return _max_ns;
+}
+
+/**
+ * @brief Instance
+ * @return metrics shared by whole application
+ */
+PipelineMetrics& PipelineMetrics::Instance()
+{
+    static PipelineMetrics metrics;
+    return metrics;
+}
+
+/**
+ * @brief local
+ * @return statistics of calling thread, registered on first call
+ */
+PipelineMetrics::ThreadMetrics& PipelineMetrics::local()
+{
+    if (!local_metrics)
+    {
+        std::lock_guard<std::mutex> lock(_registry_mutex);
+        _threads.push_back(std::make_unique<ThreadMetrics>());
+        _threads.back()->_name = "thread " + std::to_string(_threads.size());
+        local_metrics = _threads.back().get();
+    }
+    return *static_cast<ThreadMetrics*>(local_metrics);
+}
+
+/**
+ * @brief Set_thread_name
+ * @param name name of calling thread shown in snapshot and in trace
+ */
+void PipelineMetrics::Set_thread_name(const std::string_view & name)
+{
+    Tracer::Instance().Set_thread_name(name);
+    ThreadMetrics & metrics = local();
+    std::lock_guard<std::mutex> lock(_registry_mutex);
+    metrics._name = name;
+}
+
+/**
+ * @brief Record
+ * @param stage measured stage
+ * @param duration duration of stage
+ */
+void PipelineMetrics::Record(PipelineStage stage, std::chrono::nanoseconds duration)
+{
+    ThreadMetrics & metrics = local();
+    const std::size_t s = static_cast<std::size_t>(stage);
+    const std::uint64_t ns = (duration.count() < 0) ? 0 : duration.count();
+    //bucket b holds durations up to 2^b ns
+    const int bucket = std::min<int>(std::bit_width(ns > 0 ? ns - 1 : 0), StageSnapshot::buckets - 1);
+    increase(metrics._histograms[s][bucket], 1);
+    increase(metrics._totals[s], ns);
+    if (ns > metrics._max[s].load(std::memory_order_relaxed))
+    {
+        metrics._max[s].store(ns, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Add
+ * @param counter counter to increase
+ * @param value value added to counter
+ */
+void PipelineMetrics::Add(PipelineCounter counter, std::uint64_t value)
+{
+    increase(local()._counters[static_cast<std::size_t>(counter)], value);
+}
+
+/**
+ * @brief Set_gauge
+ * @param gauge gauge to set
+ * @param value new value of gauge
+ */
+void PipelineMetrics::Set_gauge(PipelineGauge gauge, std::int64_t value)
+{
+    _gauges[static_cast<std::size_t>(gauge)].store(value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get_snapshot
+ * @return statistics merged from all threads
+ */
+MetricsSnapshot PipelineMetrics::Get_snapshot() const
+{
+    MetricsSnapshot snapshot;
+    std::lock_guard<std::mutex> lock(_registry_mutex);
+    for (const std::unique_ptr<ThreadMetrics> & metrics : _threads)
+    {
+        ThreadSnapshot thread;
+        thread._name = metrics->_name;
+        for (std::size_t s = 0; s < pipeline_stages; s++)
+        {
+            StageSnapshot & stage = snapshot._stages[s];
+            for (int b = 0; b < StageSnapshot::buckets; b++)
+            {
+                const std::uint64_t hits = metrics->_histograms[s][b].load(std::memory_order_relaxed);
+                stage._histogram[b] += hits;
+                thread._stage_counts[s] += hits;
+            }
+            stage._count += thread._stage_counts[s];
+            stage._total_ns += metrics->_totals[s].load(std::memory_order_relaxed);
+            stage._max_ns = std::max<std::uint64_t>(stage._max_ns, metrics->_max[s].load(std::memory_order_relaxed));
+        }
+        for (std::size_t c = 0; c < pipeline_counters; c++)
+        {
+            thread._counters[c] = metrics->_counters[c].load(std::memory_order_relaxed);
+            snapshot._counters[c] += thread._counters[c];
+        }
+        snapshot._threads.push_back(std::move(thread));
+    }
+    for (std::size_t g = 0; g < pipeline_gauges; g++)
+    {
+        snapshot._gauges[g] = _gauges[g].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Reset
+ * @note zeroes all statistics, names of threads are kept
+ */
+void PipelineMetrics::Reset()
+{
+    std::lock_guard<std::mutex> lock(_registry_mutex);
+    for (std::unique_ptr<ThreadMetrics> & metrics : _threads)
+    {
+        for (std::size_t s = 0; s < pipeline_stages; s++)
+        {
+            for (std::atomic_uint64_t & hits : metrics->_histograms[s])
+            {
+                hits = 0;
+            }
+            metrics->_totals[s] = 0;
+            metrics->_max[s] = 0;
+        }
+        for (std::atomic_uint64_t & value : metrics->_counters)
+        {
+            value = 0;
+        }
+    }
+}
@@ -0,0 +1,456 @@
+#include "ReadEngine.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace
+{
+/**
+ * @brief load_acquire
+ * @return value of ring field written by kernel
+ */
+std::uint32_t load_acquire(std::uint32_t * field)
+{
+    return std::atomic_ref<std::uint32_t>(*field).load(std::memory_order_acquire);
+}
+
+/**
+ * @brief store_release
+ * @note publishes value of ring field to kernel
+ */
+void store_release(std::uint32_t * field, std::uint32_t value)
+{
+    std::atomic_ref<std::uint32_t>(*field).store(value, std::memory_order_release);
+}
+}
+
+/********************************** ReadEngine ********************************/
+
+/**
+ * @brief ReadEngine constructor
+ * @param buffer_count number of buffers
+ * @param buffer_size bytes of one buffer
+ */
+ReadEngine::ReadEngine(std::size_t buffer_count, std::size_t buffer_size)
+    : _buffer_size(std::max<std::size_t>(buffer_size, 1)), _memory(std::max<std::size_t>(buffer_count, 1) * _buffer_size)
+{
+    //buffers are acquired from back, so buffer 0 is used first
+    for (int buffer = static_cast<int>(_memory.size() / _buffer_size) - 1; buffer >= 0; buffer--)
+    {
+        _free_buffers.push_back(buffer);
+    }
+}
+
+/**
+ * @brief Acquire_buffer
+ * @return index of free buffer, -1 if all buffers are in use
+ */
+int ReadEngine::Acquire_buffer()
+{
+    if (_free_buffers.empty())
+    {
+        return -1;
+    }
+    const int buffer = _free_buffers.back();
+    _free_buffers.pop_back();
+    return buffer;
+}
+
+/**
+ * @brief Release_buffer
+ * @param buffer index of buffer which is not needed anymore
+ */
+void ReadEngine::Release_buffer(int buffer)
+{
+    _free_buffers.push_back(buffer);
+}
+
+/**
+ * @brief Get_buffer
+ * @param buffer index of buffer
+ * @return memory of buffer
+ */
+std::span<char> ReadEngine::Get_buffer(int buffer)
+{
+    return std::span<char>(_memory.data() + buffer * _buffer_size, _buffer_size);
+}
+
+/**
+ * @brief Get_buffer_size
+ * @return bytes of one buffer
+ */
+std::size_t ReadEngine::Get_buffer_size() const
+{
+    return _buffer_size;
+}
+
+/**
+ * @brief Read_file
+ * @param fname path to file
+ * @param out whole content of file, buffer is reused between calls
+ * @return false if file can't be opened or read
+ * @note file is read in chunks of buffer size, as many chunks in flight as there are buffers
+ */
+bool ReadEngine::Read_file(const std::filesystem::path & fname, std::string & out)
+{
+    const int fd = ::open(fname.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat status {};
+    if (::fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    const std::size_t size = static_cast<std::size_t>(status.st_size);
+    out.resize(size);
+    std::size_t next_offset = 0;
+    //file can be shorter than its size was, when it is being rewritten
+    std::size_t valid_size = size;
+    int in_flight = 0;
+    bool is_ok = true;
+    while (next_offset < size || in_flight > 0)
+    {
+        while (is_ok && next_offset < size)
+        {
+            const int buffer = Acquire_buffer();
+            if (buffer < 0)
+            {
+                break;
+            }
+            const std::size_t length = std::min(_buffer_size, size - next_offset);
+            if (!Submit_read(fd, buffer, length, next_offset, next_offset))
+            {
+                Release_buffer(buffer);
+                is_ok = false;
+                break;
+            }
+            next_offset += length;
+            in_flight++;
+        }
+        if (in_flight == 0)
+        {
+            break;
+        }
+        _file_completions.clear();
+        Wait(_file_completions, 100);
+        for (const ReadCompletion & completion : _file_completions)
+        {
+            in_flight--;
+            if (completion._result < 0)
+            {
+                is_ok = false;
+            }
+            else
+            {
+                const std::size_t offset = static_cast<std::size_t>(completion._tag);
+                const std::size_t length = std::min<std::size_t>(completion._result, size - offset);
+                std::memcpy(out.data() + offset, Get_buffer(completion._buffer).data(), length);
+                if (length < std::min(_buffer_size, size - offset))
+                {
+                    valid_size = std::min(valid_size, offset + length);
+                }
+            }
+            Release_buffer(completion._buffer);
+        }
+    }
+    ::close(fd);
+    out.resize(valid_size);
+    return is_ok;
+}
+
+/********************************** SyncReadEngine ********************************/
+
+SyncReadEngine::SyncReadEngine(std::size_t buffer_count, std::size_t buffer_size)
+    : ReadEngine(buffer_count, buffer_size)
+{
+    //Empty
+}
+
+bool SyncReadEngine::Submit_read(int fd, int buffer, std::size_t length, std::uint64_t offset, std::uint64_t tag)
+{
+    _requests.push_back({fd, buffer, std::min(length, _buffer_size), offset, tag, false});
+    return true;
+}
+
+bool SyncReadEngine::Submit_recv(int fd, int buffer, std::uint64_t tag)
+{
+    _requests.push_back({fd, buffer, _buffer_size, 0, tag, true});
+    return true;
+}
+
+/**
+ * @brief Wait
+ * @param out completions are appended to it
+ * @param timeout_ms how long to wait for first completion
+ * @return number of appended completions, 0 on timeout
+ * @note file reads are run at once, sockets are polled and read when they have data
+ */
+std::size_t SyncReadEngine::Wait(std::vector<ReadCompletion> & out, int timeout_ms)
+{
+    const std::size_t begin = out.size();
+    std::vector<pollfd> sockets;
+    for (const Request & request : _requests)
+    {
+        if (request._is_recv)
+        {
+            sockets.push_back({request._fd, POLLIN, 0});
+            continue;
+        }
+        const ssize_t result = ::pread(request._fd, Get_buffer(request._buffer).data(), request._length,
+                                       static_cast<off_t>(request._offset));
+        out.push_back({request._tag, request._buffer, (result < 0) ? -errno : static_cast<int>(result)});
+    }
+    std::erase_if(_requests, [](const Request & request) { return !request._is_recv; });
+    if (sockets.empty())
+    {
+        return out.size() - begin;
+    }
+    if (::poll(sockets.data(), sockets.size(), (out.size() > begin) ? 0 : timeout_ms) <= 0)
+    {
+        return out.size() - begin;
+    }
+    std::size_t socket = 0;
+    std::erase_if(_requests, [&](const Request & request) {
+        if (sockets[socket++].revents == 0)
+        {
+            return false;
+        }
+        const ssize_t result = ::recv(request._fd, Get_buffer(request._buffer).data(), request._length, MSG_DONTWAIT);
+        if (result < 0 && (errno == EAGAIN || errno == EINTR))
+        {
+            return false;
+        }
+        out.push_back({request._tag, request._buffer, (result < 0) ? -errno : static_cast<int>(result)});
+        return true;
+    });
+    return out.size() - begin;
+}
+
+const char* SyncReadEngine::Get_name() const
+{
+    return "sync";
+}
+
+/********************************** UringReadEngine ********************************/
+
+/**
+ * @brief UringReadEngine constructor
+ * @param buffer_count number of buffers, also number of reads in flight
+ * @param buffer_size bytes of one buffer
+ * @throw std::runtime_error if io_uring is not available
+ */
+UringReadEngine::UringReadEngine(std::size_t buffer_count, std::size_t buffer_size)
+    : ReadEngine(buffer_count, buffer_size), _tags(_memory.size() / _buffer_size)
+{
+    const unsigned buffers = static_cast<unsigned>(_tags.size());
+    io_uring_params params {};
+    _ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, std::max(buffers, 2u), &params));
+    if (_ring_fd < 0)
+    {
+        throw std::runtime_error("io_uring is not available");
+    }
+    //single mapping of both rings and waiting with timeout are needed
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG))
+    {
+        release();
+        throw std::runtime_error("io_uring is too old");
+    }
+    _ring_size = std::max<std::size_t>(params.sq_off.array + params.sq_entries * sizeof(std::uint32_t),
+                                       params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    _ring = ::mmap(nullptr, _ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+    _entries_size = params.sq_entries * sizeof(io_uring_sqe);
+    _entries = ::mmap(nullptr, _entries_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES);
+    if (_ring == MAP_FAILED || _entries == MAP_FAILED)
+    {
+        release();
+        throw std::runtime_error("io_uring rings can't be mapped");
+    }
+    char * ring = static_cast<char*>(_ring);
+    _sq_head = reinterpret_cast<std::uint32_t*>(ring + params.sq_off.head);
+    _sq_tail = reinterpret_cast<std::uint32_t*>(ring + params.sq_off.tail);
+    _sq_mask = *reinterpret_cast<std::uint32_t*>(ring + params.sq_off.ring_mask);
+    _sq_capacity = params.sq_entries;
+    _sq_array = reinterpret_cast<std::uint32_t*>(ring + params.sq_off.array);
+    _cq_head = reinterpret_cast<std::uint32_t*>(ring + params.cq_off.head);
+    _cq_tail = reinterpret_cast<std::uint32_t*>(ring + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<std::uint32_t*>(ring + params.cq_off.ring_mask);
+    _cqes = ring + params.cq_off.cqes;
+
+    std::vector<iovec> vectors(buffers);
+    for (unsigned buffer = 0; buffer < buffers; buffer++)
+    {
+        vectors[buffer] = {Get_buffer(buffer).data(), _buffer_size};
+    }
+    //registration can fail on locked memory limit, plain reads still work
+    _is_fixed = ::syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_BUFFERS, vectors.data(), buffers) == 0;
+}
+
+/**
+ * @brief next_entry
+ * @return free submission queue entry, nullptr if queue is full
+ */
+void* UringReadEngine::next_entry()
+{
+    const std::uint32_t tail = *_sq_tail;
+    if (tail - load_acquire(_sq_head) >= _sq_capacity)
+    {
+        return nullptr;
+    }
+    const std::uint32_t index = tail & _sq_mask;
+    _sq_array[index] = index;
+    io_uring_sqe * entry = static_cast<io_uring_sqe*>(_entries) + index;
+    std::memset(entry, 0, sizeof(io_uring_sqe));
+    return entry;
+}
+
+bool UringReadEngine::Submit_read(int fd, int buffer, std::size_t length, std::uint64_t offset, std::uint64_t tag)
+{
+    io_uring_sqe * entry = static_cast<io_uring_sqe*>(next_entry());
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    entry->opcode = _is_fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    entry->fd = fd;
+    entry->off = offset;
+    entry->addr = reinterpret_cast<std::uint64_t>(Get_buffer(buffer).data());
+    entry->len = static_cast<std::uint32_t>(std::min(length, _buffer_size));
+    entry->buf_index = static_cast<std::uint16_t>(buffer);
+    entry->user_data = static_cast<std::uint64_t>(buffer);
+    _tags[buffer] = tag;
+    store_release(_sq_tail, *_sq_tail + 1);
+    _to_submit++;
+    return true;
+}
+
+bool UringReadEngine::Submit_recv(int fd, int buffer, std::uint64_t tag)
+{
+    io_uring_sqe * entry = static_cast<io_uring_sqe*>(next_entry());
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    entry->opcode = IORING_OP_RECV;
+    entry->fd = fd;
+    entry->addr = reinterpret_cast<std::uint64_t>(Get_buffer(buffer).data());
+    entry->len = static_cast<std::uint32_t>(_buffer_size);
+    entry->user_data = static_cast<std::uint64_t>(buffer);
+    _tags[buffer] = tag;
+    store_release(_sq_tail, *_sq_tail + 1);
+    _to_submit++;
+    return true;
+}
+
+/**
+ * @brief Wait
+ * @param out completions are appended to it
+ * @param timeout_ms how long to wait for first completion
+ * @return number of appended completions, 0 on timeout
+ * @note submitted reads are passed to kernel with the same system call which waits
+ */
+std::size_t UringReadEngine::Wait(std::vector<ReadCompletion> & out, int timeout_ms)
+{
+    const bool has_completions = load_acquire(_cq_tail) != *_cq_head;
+    if (_to_submit > 0 || !has_completions)
+    {
+        __kernel_timespec timeout {timeout_ms / 1000, (timeout_ms % 1000) * 1000000LL};
+        io_uring_getevents_arg argument {};
+        argument.sigmask_sz = _NSIG / 8;
+        argument.ts = reinterpret_cast<std::uint64_t>(&timeout);
+        const unsigned wait_for = has_completions ? 0 : 1;
+        const long submitted = ::syscall(__NR_io_uring_enter, _ring_fd, _to_submit, wait_for,
+                                         IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &argument, sizeof(argument));
+        //timeout or signal is not an error, entries are submitted anyway
+        if (submitted >= 0)
+        {
+            _to_submit -= std::min<std::uint32_t>(_to_submit, static_cast<std::uint32_t>(submitted));
+        }
+        else if (errno == ETIME || errno == EINTR)
+        {
+            _to_submit = *_sq_tail - load_acquire(_sq_head);
+        }
+    }
+    const std::size_t begin = out.size();
+    std::uint32_t head = *_cq_head;
+    const std::uint32_t tail = load_acquire(_cq_tail);
+    for (; head != tail; head++)
+    {
+        const io_uring_cqe & completion = static_cast<const io_uring_cqe*>(_cqes)[head & _cq_mask];
+        const int buffer = static_cast<int>(completion.user_data);
+        out.push_back({_tags[buffer], buffer, completion.res});
+    }
+    store_release(_cq_head, head);
+    return out.size() - begin;
+}
+
+const char* UringReadEngine::Get_name() const
+{
+    return "io_uring";
+}
+
+/**
+ * @brief release
+ * @note unmaps rings and closes io_uring
+ */
+void UringReadEngine::release()
+{
+    if (_entries != nullptr && _entries != MAP_FAILED)
+    {
+        ::munmap(_entries, _entries_size);
+    }
+    if (_ring != nullptr && _ring != MAP_FAILED)
+    {
+        ::munmap(_ring, _ring_size);
+    }
+    _entries = nullptr;
+    _ring = nullptr;
+    if (_ring_fd >= 0)
+    {
+        ::close(_ring_fd);
+        _ring_fd = -1;
+    }
+}
+
+UringReadEngine::~UringReadEngine()
+{
+    release();
+}
+
+/**
+ * @brief Create_read_engine
+ * @param buffer_count number of buffers, also number of reads in flight
+ * @param buffer_size bytes of one buffer
+ * @param prefer_uring if false, synchronous engine is created
+ * @return io_uring engine if kernel supports it, otherwise synchronous engine
+ */
+std::unique_ptr<ReadEngine> Create_read_engine(std::size_t buffer_count, std::size_t buffer_size, bool prefer_uring)
+{
+    if (prefer_uring)
+    {
+        try
+        {
+            return std::make_unique<UringReadEngine>(buffer_count, buffer_size);
+        }
+        catch (const std::runtime_error &)
+        {
+            //kernel without io_uring or with io_uring disabled
+        }
+    }
+    return std::make_unique<SyncReadEngine>(buffer_count, buffer_size);
+}
@@ -1,5 +1,37 @@
 #include "RecordingContainers.h"
+#include "BlockCompression.h"
+#include "Tracer.h"
 #include <iostream>
+#include <utility>
+
+namespace
+{
+//returned by accessors of empty history
+const RecordingVector empty_recordingVector;
+}
+
+/**
+ * @brief RecordingVector constructor
+ * @param resource memory resource from which timestamps are allocated
+ */
+RecordingVector::RecordingVector(std::pmr::memory_resource * resource)
+    : _data(resource)
+{
+    //Empty
+}
+
+/**
+ * @brief RecordingVector constructor
+ * @param block immutable interval which timestamps are shared, not copied
+ */
+RecordingVector::RecordingVector(std::shared_ptr<const RecordingVector> block)
+    : _params(block->_params), _compressed(block->_compressed)
+{
+    if (!_compressed)
+    {
+        _block = std::move(block);
+    }
+}
 
 /**
  * @brief Get_recording_params
@@ -26,15 +58,21 @@ void RecordingVector::Set_recording_params(const RangeParams & params)
  */
 const RecordingVector::type& RecordingVector::Get_container() const
 {
-    return _data;
+    return _block ? _block->Get_container() : _data;
 }
 
 /**
  * @brief Get_container
  * @return vector with timestamps
+ * @note timestamps of shared block are copied first, block itself is never changed
  */
 RecordingVector::type& RecordingVector::Get_container()
 {
+    if (_block)
+    {
+        _data.assign(_block->Get_container().begin(), _block->Get_container().end());
+        _block.reset();
+    }
     return _data;
 }
 
@@ -46,7 +84,61 @@ RecordingVector::type& RecordingVector::Get_container()
  */
 Timestamp RecordingVector::operator[](unsigned i) const
 {
-    return _data.at(i);
+    if (_compressed)
+    {
+        return Decompress().at(i);
+    }
+    return Get_container().at(i);
+}
+
+/**
+ * @brief Compress
+ * @note replaces timestamps with their compressed form and releases their memory
+ */
+void RecordingVector::Compress()
+{
+    const type & data = std::as_const(*this).Get_container();
+    if (_compressed || data.empty())
+    {
+        return;
+    }
+    _compressed = std::make_shared<const CompressedBlock>(data);
+    //give buffer back to memory resource, shared block is only released
+    _data = type(_data.get_allocator());
+    _block.reset();
+}
+
+/**
+ * @brief Is_compressed
+ * @return true if timestamps are stored compressed
+ */
+bool RecordingVector::Is_compressed() const
+{
+    return _compressed != nullptr;
+}
+
+/**
+ * @brief Get_compressed
+ * @return compressed timestamps or nullptr if interval is not compressed
+ */
+std::shared_ptr<const CompressedBlock> RecordingVector::Get_compressed() const
+{
+    return _compressed;
+}
+
+/**
+ * @brief Decompress
+ * @return copy of timestamps, decompressed if needed
+ */
+RecordingVector::type RecordingVector::Decompress() const
+{
+    if (!_compressed)
+    {
+        return Get_container();
+    }
+    type data;
+    _compressed->Decompress(data);
+    return data;
 }
 
 /**
@@ -57,6 +149,8 @@ Timestamp RecordingVector::operator[](unsigned i) const
 void RecordingVector::Set_vector(type && vec)
 {
     _data = std::move(vec);
+    _compressed.reset();
+    _block.reset();
 }
 
 /**
@@ -67,6 +161,8 @@ void RecordingVector::Set_vector(type && vec)
 void RecordingVector::Set_vector(const type & vec)
 {
     _data = vec;
+    _compressed.reset();
+    _block.reset();
 }
 
 /**
@@ -76,10 +172,36 @@ void RecordingVector::Set_vector(const type & vec)
 void RecordingVector::Clear()
 {
     _data.clear();
+    _compressed.reset();
+    _block.reset();
 }
 
 /********************************** RecordingHistory ********************************/
 
+RecordingHistory::RecordingHistory(const RecordingHistory & other)
+    : _data(other._data, &_node_pool), _params(other._params),
+    _recordingVectors_limit(other._recordingVectors_limit), _compression(other._compression),
+    _pushed_intervals(other._pushed_intervals.load()), _gaps(other._gaps),
+    _lost_intervals(other._lost_intervals.load())
+{
+    //Empty
+}
+
+RecordingHistory& RecordingHistory::operator=(const RecordingHistory & other)
+{
+    if (this != &other)
+    {
+        _data.assign(other._data.begin(), other._data.end());
+        _params = other._params;
+        _recordingVectors_limit = other._recordingVectors_limit;
+        _compression = other._compression;
+        _pushed_intervals = other._pushed_intervals.load();
+        _gaps = other._gaps;
+        _lost_intervals = other._lost_intervals.load();
+    }
+    return *this;
+}
+
 /**
  * @brief Set_history_time_limit
  * @param limit_in_sec how many intervals will be stored at once
@@ -90,6 +212,24 @@ void RecordingHistory::Set_history_time_limit(int limit_in_sec)
     _recordingVectors_limit = limit_in_sec;
 }
 
+/**
+ * @brief Set_compression
+ * @param enabled if true, intervals older than two newest are compressed
+ * @note two newest intervals always stay raw for the live view
+ */
+void RecordingHistory::Set_compression(bool enabled)
+{
+    _compression = enabled;
+    if (_compression && _data.size() > 2)
+    {
+        type::iterator last_to_compress = std::prev(_data.end(), 2);
+        for (type::iterator iter = _data.begin(); iter != last_to_compress; iter++)
+        {
+            iter->Compress();
+        }
+    }
+}
+
 /**
  * @brief Get_recording_params
  * @return parameters of saved history
@@ -127,7 +267,19 @@ Timestamp RecordingHistory::operator[](unsigned int i) const
             unsigned int index_limit = iter->Get_recording_params().Get_max_index();
             if (i < points_count + index_limit)
             {
-                return (*iter)[i - points_count];
+                std::shared_ptr<const CompressedBlock> compressed = iter->Get_compressed();
+                if (!compressed)
+                {
+                    return (*iter)[i - points_count];
+                }
+                if (_indexed_block.owner_before(compressed) || compressed.owner_before(_indexed_block)
+                    || _indexed_block.expired())
+                {
+                    _indexed_data.clear();
+                    compressed->Decompress(_indexed_data);
+                    _indexed_block = compressed;
+                }
+                return _indexed_data.at(i - points_count);
             }
             points_count += index_limit;
             iter++;
@@ -140,11 +292,12 @@ Timestamp RecordingHistory::operator[](unsigned int i) const
  * @brief Get_newest_recordingVector
  * @return newest RecordingVector containing new data read
  * If _data is empty it returns empty RecordingVector
+ * @note reference is valid until interval is removed from history
  */
-RecordingVector RecordingHistory::Get_newest_recordingVector() const
+const RecordingVector& RecordingHistory::Get_newest_recordingVector() const
 {
     if (_data.empty())
-        return RecordingVector();
+        return empty_recordingVector;
     else
         return _data.back();
 }
@@ -153,8 +306,9 @@ RecordingVector RecordingHistory::Get_newest_recordingVector() const
  * @brief Get_before_newest_recordingVector
  * @return one before newest RecordingVector containing new data read.
  * If _data only has 1 RecordingVector it returns empty RecordingVector
+ * @note reference is valid until interval is removed from history
  */
-RecordingVector RecordingHistory::Get_before_newest_recordingVector() const
+const RecordingVector& RecordingHistory::Get_before_newest_recordingVector() const
 {
     if (_data.size() >= 2)
     {
@@ -165,7 +319,27 @@ RecordingVector RecordingHistory::Get_before_newest_recordingVector() const
         return *iter;
     }
     else
-        return RecordingVector();
+        return empty_recordingVector;
+}
+
+/**
+ * @brief Get_newest_view
+ * @return view of timestamps of newest interval, without copying them
+ * @note view is valid until interval is removed from history
+ */
+std::span<const Timestamp> RecordingHistory::Get_newest_view() const
+{
+    return Get_newest_recordingVector().Get_container();
+}
+
+/**
+ * @brief Get_before_newest_view
+ * @return view of timestamps of one before newest interval, without copying them
+ * @note view is valid until interval is removed from history
+ */
+std::span<const Timestamp> RecordingHistory::Get_before_newest_view() const
+{
+    return Get_before_newest_recordingVector().Get_container();
 }
 
 /**
@@ -184,6 +358,7 @@ const RecordingHistory::type& RecordingHistory::Get_container() const
  */
 bool RecordingHistory::Pop_recordingVector()
 {
+    TraceScope trace("RecordingHistory::pop");
     if (_data.empty())
     {
         return false;
@@ -193,6 +368,10 @@ bool RecordingHistory::Pop_recordingVector()
     _data.pop_front();
     const RangeParams& new_last_params = _data.front().Get_recording_params();
     _params._time_range.first = new_last_params.Get_min_time();
+    while (!_gaps.empty() && _gaps.front()._end_time <= _params._time_range.first)
+    {
+        _gaps.pop_front();
+    }
     return true;
 }
 
@@ -204,10 +383,33 @@ bool RecordingHistory::Pop_recordingVector()
  */
 bool RecordingHistory::Push_recordingVector(RecordingVector && vec)
 {
+    TraceScope trace("RecordingHistory::push");
+    if (_frozen)
+    {
+        //backlog keeps only intervals that would stay in history after Unfreeze()
+        if (_backlog.size() >= static_cast<std::size_t>(_recordingVectors_limit))
+            _backlog.pop_front();
+        _backlog.push_back(std::move(vec));
+        return true;
+    }
     if (_data.size() >= _recordingVectors_limit)
         Pop_recordingVector();
-    _data.push_back(vec);
-    const RangeParams new_params = vec.Get_recording_params();
+    _data.push_back(std::move(vec));
+    appended();
+    return true;
+}
+
+/**
+ * @brief appended
+ * @note updates compression, parameters and counter after interval was appended to _data
+ */
+void RecordingHistory::appended()
+{
+    if (_compression && _data.size() > 2)
+    {
+        std::prev(_data.end(), 3)->Compress();
+    }
+    const RangeParams new_params = _data.back().Get_recording_params();
     _params._max_index += new_params.Get_max_index();
 
     auto [min_voltage, max_voltage] = _params._voltage_range;
@@ -221,8 +423,93 @@ bool RecordingHistory::Push_recordingVector(RecordingVector && vec)
     }
 
     _params._time_range.second = new_params.Get_max_time();
+    _pushed_intervals++;
+}
 
-    return true;
+/**
+ * @brief Freeze
+ * @note history stops changing, pushed intervals are kept in backlog until Unfreeze()
+ */
+void RecordingHistory::Freeze()
+{
+    _frozen = true;
+}
+
+/**
+ * @brief Unfreeze
+ * @return number of intervals moved from backlog to history
+ * @note intervals are spliced, so they are neither copied nor reallocated
+ */
+std::size_t RecordingHistory::Unfreeze()
+{
+    _frozen = false;
+    const std::size_t spliced = _backlog.size();
+    while (!_backlog.empty())
+    {
+        if (_data.size() >= static_cast<std::size_t>(_recordingVectors_limit))
+            Pop_recordingVector();
+        _data.splice(_data.end(), _backlog, _backlog.begin());
+        appended();
+    }
+    return spliced;
+}
+
+/**
+ * @brief Is_frozen
+ * @return true if history is frozen
+ */
+bool RecordingHistory::Is_frozen() const
+{
+    return _frozen;
+}
+
+/**
+ * @brief Get_backlog_size
+ * @return number of intervals pushed while frozen
+ */
+std::size_t RecordingHistory::Get_backlog_size() const
+{
+    return _backlog.size();
+}
+
+/**
+ * @brief Get_pushed_intervals
+ * @return number of intervals that entered history since its creation
+ * @note it never decreases, so consumer can tell how many intervals are new
+ */
+std::uint64_t RecordingHistory::Get_pushed_intervals() const
+{
+    return _pushed_intervals;
+}
+
+/**
+ * @brief Record_gap
+ * @param gap time range of lost intervals, it is placed after newest interval
+ * @note gaps are removed together with intervals older than them
+ */
+void RecordingHistory::Record_gap(const HistoryGap & gap)
+{
+    _gaps.push_back(gap);
+    _lost_intervals += gap._lost_intervals;
+}
+
+/**
+ * @brief Get_gaps
+ * @return gaps within stored history, oldest first
+ */
+const std::deque<HistoryGap>& RecordingHistory::Get_gaps() const
+{
+    return _gaps;
+}
+
+/**
+ * @brief Get_lost_intervals
+ * @return number of intervals lost since history creation
+ * @note it never decreases, like Get_pushed_intervals()
+ */
+std::uint64_t RecordingHistory::Get_lost_intervals() const
+{
+    return _lost_intervals;
 }
 
 /**
@@ -247,6 +534,10 @@ void RecordingHistory::Clear()
         iter++;
     }
     _data.clear();
+    _backlog.clear();
+    _gaps.clear();
+    _indexed_block.reset();
+    _indexed_data.clear();
 }
 
 /**
@@ -302,14 +593,50 @@ RecordingHistory::iterator::iterator(const RecordingHistory * _recHis_ptr,
             _vec_it = _data_ptr->Get_container().back().Get_container().end();
         }
     }
-    else if (timestamp_index >= _list_it->Get_container().size() || timestamp_index < 0)
+    else
     {
-        _vec_it = _list_it->Get_container().end();
+        const vec_type & interval = enter_interval();
+        if (timestamp_index >= interval.size() || timestamp_index < 0)
+        {
+            _vec_it = interval.end();
+        }
+        else
+        {
+            _vec_it = interval.begin() + timestamp_index;
+        }
     }
-    else
+}
+
+/**
+ * @brief enter_interval
+ * @return timestamps of interval pointed by _list_it, decompressed if needed
+ * @note compressed interval is decompressed once, when iterator enters it
+ */
+const RecordingHistory::iterator::vec_type& RecordingHistory::iterator::enter_interval()
+{
+    std::shared_ptr<const CompressedBlock> compressed = _list_it->Get_compressed();
+    if (!compressed)
+    {
+        _decompressed.reset();
+        return _list_it->Get_container();
+    }
+    auto decompressed = std::make_shared<vec_type>();
+    compressed->Decompress(*decompressed);
+    _decompressed = std::move(decompressed);
+    return *_decompressed;
+}
+
+/**
+ * @brief current_interval
+ * @return timestamps of interval pointed by _list_it
+ */
+const RecordingHistory::iterator::vec_type& RecordingHistory::iterator::current_interval() const
+{
+    if (_decompressed)
     {
-        _vec_it = _list_it->Get_container().begin() + timestamp_index;
+        return *_decompressed;
     }
+    return _list_it->Get_container();
 }
 
 /**
@@ -333,12 +660,12 @@ RecordingHistory::iterator& RecordingHistory::iterator::operator++()
     if (_list_it != _data_ptr->Get_container().end())
     {
         ++_vec_it;
-        if (_vec_it == _list_it->Get_container().end())
+        if (_vec_it == current_interval().end())
         {
             ++_list_it;
             if (_list_it != _data_ptr->Get_container().end())
             {
-                _vec_it = _list_it->Get_container().begin();
+                _vec_it = enter_interval().begin();
             }
         }
     }
@@ -366,10 +693,12 @@ RecordingHistory::iterator RecordingHistory::iterator::operator++(int)
  */
 bool RecordingHistory::iterator::operator==(const RecordingHistory::iterator & iter) const
 {
-    if (_list_it == iter._list_it && _vec_it == iter._vec_it)
-        return true;
-    else
+    if (_list_it != iter._list_it)
         return false;
+    if (_list_it == _data_ptr->Get_container().end())
+        return true;
+    //decompressed intervals of different iterators are different copies, so offsets are compared
+    return (_vec_it - current_interval().begin()) == (iter._vec_it - iter.current_interval().begin());
 }
 
 /**
@@ -0,0 +1,112 @@
+#include "RenderScheduler.h"
+#include <algorithm>
+
+/**
+ * @brief constructor
+ * @param frame_limit max frames per second, 0 means no limit
+ * @param idle_wait max time main loop waits for events when nothing is dirty
+ */
+RenderScheduler::RenderScheduler(int frame_limit, std::chrono::milliseconds idle_wait) :
+m_dirty{static_cast<std::uint8_t>(DirtyFlag::WINDOW)}, m_frame_period{0}, m_idle_wait{idle_wait},
+m_refresh_period{0}, m_last_frame{}, m_drawn_frames{0}, m_skipped_frames{0}
+{
+    Set_frame_limit(frame_limit);
+}
+/**
+ * @brief marks frame as dirty.
+ * @param flag reason of redraw.
+ */
+void RenderScheduler::Mark_dirty(DirtyFlag flag)
+{
+    m_dirty |= static_cast<std::uint8_t>(flag);
+}
+/**
+ * @brief requests redraw at least every period, e.g. for overlay with live values.
+ * @param period period of refresh, zero disables it.
+ */
+void RenderScheduler::Set_refresh_period(std::chrono::milliseconds period)
+{
+    m_refresh_period = period;
+}
+/**
+ * @brief sets max frames per second.
+ * @param frame_limit max frames per second, 0 means no limit
+ */
+void RenderScheduler::Set_frame_limit(int frame_limit)
+{
+    if (frame_limit <= 0) {
+        m_frame_period = clock::duration::zero();
+    } else {
+        m_frame_period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / frame_limit));
+    }
+}
+/**
+ * @brief sets OVERLAY flag when refresh period passed.
+ */
+void RenderScheduler::Check_refresh(clock::time_point now)
+{
+    if (m_refresh_period.count() > 0 && now - m_last_frame >= m_refresh_period) {
+        Mark_dirty(DirtyFlag::OVERLAY);
+    }
+}
+/**
+ * @brief checks if frame should be drawn now.
+ * @return true if frame is dirty and frame limit allows drawing.
+ */
+bool RenderScheduler::Should_draw()
+{
+    const clock::time_point now = clock::now();
+    Check_refresh(now);
+    if (!Is_dirty() || now - m_last_frame < m_frame_period) {
+        m_skipped_frames++;
+        return false;
+    }
+    return true;
+}
+/**
+ * @brief calculates how long main loop can wait for events.
+ * @return zero if frame should be drawn now.
+ */
+std::chrono::microseconds RenderScheduler::Get_wait_time()
+{
+    const clock::time_point now = clock::now();
+    Check_refresh(now);
+    clock::duration wait = m_idle_wait;
+    if (Is_dirty()) {
+        wait = m_last_frame + m_frame_period - now;
+    } else if (m_refresh_period.count() > 0) {
+        wait = std::min<clock::duration>(wait, m_last_frame + m_refresh_period - now);
+    }
+    return std::max(std::chrono::duration_cast<std::chrono::microseconds>(wait), std::chrono::microseconds(0));
+}
+/**
+ * @brief clears dirty flags, has to be called after frame was drawn.
+ */
+void RenderScheduler::Frame_drawn()
+{
+    m_dirty = static_cast<std::uint8_t>(DirtyFlag::NONE);
+    m_last_frame = clock::now();
+    m_drawn_frames++;
+}
+/**
+ * @brief checks if given flag is set.
+ */
+bool RenderScheduler::Is_dirty(DirtyFlag flag) const
+{
+    return (m_dirty & static_cast<std::uint8_t>(flag)) != 0;
+}
+/**
+ * @brief checks if any flag is set.
+ */
+bool RenderScheduler::Is_dirty() const
+{
+    return m_dirty != static_cast<std::uint8_t>(DirtyFlag::NONE);
+}
+std::uint64_t RenderScheduler::Get_drawn_frames() const
+{
+    return m_drawn_frames;
+}
+std::uint64_t RenderScheduler::Get_skipped_frames() const
+{
+    return m_skipped_frames;
+}
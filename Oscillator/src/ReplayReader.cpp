@@ -0,0 +1,413 @@
+#include "ReplayReader.h"
+#include "PipelineMetrics.h"
+#include "TextCodec.h"
+#include <chrono>
+#include <filesystem>
+
+ReplayReader::ReplayReader(const std::string_view & fname, ReplayMode mode, double speed)
+    : _fname(fname), _thread(), _prefetch_thread()
+{
+    _destroyed = false;
+    _destroy_flag = false;
+    _running = false;
+    _stop_flag = false;
+    _finished = false;
+    _prefetch_done = false;
+    _state = ReaderState::CREATED;
+    _new_data_loaded = false;
+    _replayed_points = 0;
+    Set_replay_mode(mode, speed);
+}
+
+/**
+ * @brief Get_data
+ * @return RecordingHistory with timestamps
+ * @throws runtime_error if timestamps not replayed before
+ */
+[[nodiscard]] const RecordingHistory& ReplayReader::Get_data() const
+{
+    if (_data.Empty())
+    {
+        throw std::runtime_error("Empty data");
+    }
+    return _data;
+}
+
+/**
+ * @brief Get_history_snapshot
+ * @return parameters and size of history, safe to call while Reader thread pushes
+ */
+HistorySnapshot ReplayReader::Get_history_snapshot() const
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    return HistorySnapshot {_data.Get_recording_params(), _data.Get_container().size()};
+}
+
+/**
+ * @brief Get_state
+ * @return state of the reader
+ */
+[[nodiscard]] ReaderState ReplayReader::Get_state() const
+{
+    return _state;
+}
+
+/**
+ * @brief Check_if_new_data_loaded
+ * @return true if new data after last call to this function was loaded
+ */
+[[nodiscard]] bool ReplayReader::Check_if_new_data_loaded()
+{
+    return _new_data_loaded.exchange(false);
+}
+
+/**
+ * @brief Set_file
+ * @param fname name of capture file to replay
+ * @return true if file exists and replay is not running
+ */
+[[nodiscard]] bool ReplayReader::Set_file(const std::string_view & fname)
+{
+    if (_running || !std::filesystem::exists(fname))
+    {
+        return false;
+    }
+    _fname = fname;
+    return true;
+}
+
+/**
+ * @brief Set_history_time_limit
+ * @param limit_in_sec limit of seconds of input history stored
+ */
+void ReplayReader::Set_history_time_limit(int limit_in_sec)
+{
+    _data.Set_history_time_limit(limit_in_sec);
+}
+
+/**
+ * @brief Set_history_compression
+ * @param enabled if true, older intervals of history are stored compressed
+ */
+void ReplayReader::Set_history_compression(bool enabled)
+{
+    _data.Set_compression(enabled);
+}
+
+/**
+ * @brief Freeze
+ * @note history returned by Get_data() stops changing, acquisition continues
+ * in background buffer
+ */
+void ReplayReader::Freeze()
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _data.Freeze();
+}
+
+/**
+ * @brief Unfreeze
+ * @note intervals acquired while frozen are spliced into history
+ */
+void ReplayReader::Unfreeze()
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    if (_data.Unfreeze() > 0)
+    {
+        _new_data_loaded = true;
+    }
+}
+
+/**
+ * @brief Is_frozen
+ * @return true if history is frozen
+ */
+bool ReplayReader::Is_frozen() const
+{
+    return _data.Is_frozen();
+}
+
+/**
+ * @brief Set_block_queue
+ * @param queue queue to which every interval is added after it is pushed to history, can be nullptr
+ * @note has to be called before Start(), queue is filled also while history is frozen
+ */
+void ReplayReader::Set_block_queue(std::shared_ptr<BlockQueue> queue)
+{
+    _block_queue = std::move(queue);
+}
+
+/**
+ * @brief Set_replay_mode
+ * @param mode pace of playback
+ * @param speed how many times faster than real time capture is replayed,
+ * used only with ReplayMode::ACCELERATED
+ */
+void ReplayReader::Set_replay_mode(ReplayMode mode, double speed)
+{
+    _mode = mode;
+    if (mode == ReplayMode::ACCELERATED && speed > 0.0)
+    {
+        _speed = speed;
+    }
+    else
+    {
+        _speed = 1.0;
+    }
+}
+
+/**
+ * @brief Set_prefetch_depth
+ * @param intervals how many parsed intervals can wait for playback
+ */
+void ReplayReader::Set_prefetch_depth(int intervals)
+{
+    std::lock_guard<std::mutex> lock(_prefetch_mutex);
+    _prefetch_depth = (intervals < 1) ? 1 : intervals;
+}
+
+/**
+ * @brief Set_task_pool
+ * @param pool pool which indexes capture in background and parses large intervals,
+ * nullptr means prefetch thread does both
+ * @note has to be called before Start()
+ */
+void ReplayReader::Set_task_pool(std::shared_ptr<TaskPool> pool)
+{
+    _task_pool = std::move(pool);
+}
+
+/**
+ * @brief Get_capture_index
+ * @return index of capture replayed since Start(), nullptr before it
+ */
+[[nodiscard]] std::shared_ptr<CaptureIndex> ReplayReader::Get_capture_index() const
+{
+    return _index;
+}
+
+/**
+ * @brief Is_finished
+ * @return true if whole capture was replayed
+ */
+[[nodiscard]] bool ReplayReader::Is_finished() const
+{
+    return _finished;
+}
+
+/**
+ * @brief Get_replayed_points
+ * @return number of timestamps pushed to history since Start()
+ */
+[[nodiscard]] long long ReplayReader::Get_replayed_points() const
+{
+    return _replayed_points;
+}
+
+/**
+ * @brief prefetch_loop
+ * @note loop in which capture is parsed into intervals ahead of playback.
+ * Intervals are taken from CaptureIndex, which scans capture only as far as requested
+ * interval if background indexing didn't reach it yet, so playback starts immediately.
+ */
+void ReplayReader::prefetch_loop(void)
+{
+    PipelineMetrics::Instance().Set_thread_name("ReplayReader prefetch");
+    const std::shared_ptr<CaptureIndex> index = _index;
+    CaptureEntry entry {};
+    for (std::size_t i = 0; !_destroy_flag && index->Get_entry(i, entry); i++)
+    {
+        RecordingVector vec = TextCodec::Decode_interval(index->Get_text(entry), entry._time_offset,
+            _pool.get(), static_cast<int>(entry._points), _task_pool.get());
+        //interval starts at its first timestamp, not at time offset of its file
+        RangeParams params = vec.Get_recording_params();
+        params._time_range.first = entry._min_time;
+        vec.Set_recording_params(params);
+        PipelineMetrics::Instance().Add(PipelineCounter::POINTS_PARSED, params.Get_max_index());
+        std::unique_lock<std::mutex> lock(_prefetch_mutex);
+        _prefetch_cv.wait(lock, [this]() {
+            return _destroy_flag || _prefetched.size() < static_cast<size_t>(_prefetch_depth);
+        });
+        _prefetched.push_back(std::move(vec));
+        lock.unlock();
+        _prefetch_cv.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_prefetch_mutex);
+        _prefetch_done = true;
+    }
+    _prefetch_cv.notify_all();
+}
+
+/**
+ * @brief running_loop
+ * @note loop in which prefetched intervals are paced and pushed to history.
+ * Interval is pushed when its last timestamp would be acquired live, scaled by speed.
+ */
+void ReplayReader::running_loop(void)
+{
+    if (!_running)
+    {
+        using clock = std::chrono::steady_clock;
+        const std::chrono::duration sleep_time_stopped = std::chrono::milliseconds(100);
+        PipelineMetrics & metrics = PipelineMetrics::Instance();
+        metrics.Set_thread_name("ReplayReader");
+        _running = true;
+        _destroyed = false;
+        _state = ReaderState::WAITING;
+
+        bool anchored = false;
+        clock::time_point wall_anchor;
+        double capture_anchor = 0.0;
+        while (!_destroy_flag)
+        {
+            if (_stop_flag)
+            {
+                anchored = false;
+                std::this_thread::sleep_for(sleep_time_stopped);
+                continue;
+            }
+
+            //same memory resource as prefetched interval, so move doesn't copy timestamps
+            RecordingVector vec(_pool.get());
+            {
+                std::unique_lock<std::mutex> lock(_prefetch_mutex);
+                _prefetch_cv.wait_for(lock, sleep_time_stopped, [this]() {
+                    return _destroy_flag || !_prefetched.empty() || _prefetch_done;
+                });
+                if (_prefetched.empty())
+                {
+                    if (_prefetch_done)
+                    {
+                        _finished = true;
+                        _state = ReaderState::WAITING;
+                        lock.unlock();
+                        std::this_thread::sleep_for(sleep_time_stopped);
+                    }
+                    continue;
+                }
+                vec = std::move(_prefetched.front());
+                _prefetched.pop_front();
+            }
+            _prefetch_cv.notify_all();
+
+            const RangeParams params = vec.Get_recording_params();
+            if (_mode != ReplayMode::AS_FAST_AS_POSSIBLE)
+            {
+                if (!anchored)
+                {
+                    wall_anchor = clock::now();
+                    capture_anchor = params.Get_min_time();
+                    anchored = true;
+                }
+                const std::chrono::duration<double> capture_offset(
+                    (params.Get_max_time() - capture_anchor) / _speed);
+                const clock::time_point due = wall_anchor
+                    + std::chrono::duration_cast<clock::duration>(capture_offset);
+                //sleep in slices, so Stop() and Destroy() are not delayed by slow replay
+                while (!_destroy_flag && clock::now() < due)
+                {
+                    std::this_thread::sleep_until(std::min(due, clock::now() + sleep_time_stopped));
+                }
+            }
+
+            _state = ReaderState::READING;
+            {
+                ScopedStageTimer timer(PipelineStage::PUSH);
+                BlockHandle block;
+                if (_block_queue)
+                {
+                    //history keeps view of the same block, so timestamps are not copied
+                    block = Make_block(std::move(vec), _pool);
+                    vec = RecordingVector(block);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(_data_mutex);
+                    _data.Push_recordingVector(std::move(vec));
+                }
+                //published after history has it, so consumer never gets block missing in history
+                if (block)
+                {
+                    _block_queue->Push(std::move(block));
+                }
+            }
+            metrics.Add(PipelineCounter::INTERVALS_PUSHED);
+            _replayed_points += params.Get_max_index();
+            _new_data_loaded = true;
+            _state = ReaderState::WAITING;
+        }
+        _running = false;
+        _destroyed = true;
+    }
+}
+
+/**
+ * @brief Start
+ * @note starts execution of prefetch and playback threads
+ * @throws runtime_error if capture can't be opened
+ */
+void ReplayReader::Start()
+{
+    //only footer of capture is read here, intervals are found as they are requested
+    _index = std::make_shared<CaptureIndex>(_fname);
+    if (_task_pool)
+    {
+        CaptureIndex::Index_in_background(_index, *_task_pool);
+    }
+    _finished = false;
+    _prefetch_done = false;
+    _replayed_points = 0;
+    _prefetched.clear();
+    _prefetch_thread = std::thread(&ReplayReader::prefetch_loop, this);
+    _thread = std::thread(&ReplayReader::running_loop, this);
+}
+
+/**
+ * @brief Stop
+ * @note pauses playback, capture position is kept
+ */
+void ReplayReader::Stop()
+{
+    _stop_flag = true;
+    _state = ReaderState::STOPPED;
+}
+
+/**
+ * @brief Resume
+ * @note resumes playback after Stop() was called
+ */
+void ReplayReader::Resume()
+{
+    _stop_flag = false;
+    _state = ReaderState::WAITING;
+}
+
+/**
+ * @brief Destroy
+ * @note destroys threads, after this new threads with Start() can be created
+ */
+void ReplayReader::Destroy()
+{
+    if (_index)
+    {
+        _index->Cancel();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_prefetch_mutex);
+        _destroy_flag = true;
+    }
+    _prefetch_cv.notify_all();
+    if (_prefetch_thread.joinable())
+        _prefetch_thread.join();
+    if (_thread.joinable())
+        _thread.join();
+    _destroy_flag = false;
+    _state = ReaderState::DESTROYED;
+}
+
+ReplayReader::~ReplayReader()
+{
+    Destroy();
+    _data.Clear();
+}
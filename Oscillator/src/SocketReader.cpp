@@ -0,0 +1,482 @@
+#include "SocketReader.h"
+#include "PipelineMetrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+//socket is read in batches of at most this size, buffer grows only for larger frames
+constexpr std::size_t batch_bytes = 1 << 20;
+//larger frame is treated as malformed
+constexpr std::uint32_t max_frame_points = 1 << 26;
+constexpr int poll_timeout_ms = 100;
+}
+
+/**
+ * @brief SocketReader constructor
+ * @param path path of socket on which reader listens
+ */
+SocketReader::SocketReader(const std::string_view & path)
+    : _path(path)
+{
+    //Empty
+}
+
+/**
+ * @brief Get_data
+ * @return RecordingHistory with timestamps
+ * @throws runtime_error if timestamps not received before
+ */
+const RecordingHistory& SocketReader::Get_data() const
+{
+    if (_data.Empty())
+    {
+        throw std::runtime_error("Empty data");
+    }
+    return _data;
+}
+
+/**
+ * @brief Get_history_snapshot
+ * @return parameters and size of history, safe to call while Reader thread pushes
+ */
+HistorySnapshot SocketReader::Get_history_snapshot() const
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    return HistorySnapshot {_data.Get_recording_params(), _data.Get_container().size()};
+}
+
+/**
+ * @brief Get_state
+ * @return state of the reader
+ */
+ReaderState SocketReader::Get_state() const
+{
+    return _state;
+}
+
+/**
+ * @brief Check_if_new_data_loaded
+ * @return true if new data after last call to this function was loaded
+ */
+bool SocketReader::Check_if_new_data_loaded()
+{
+    return _new_data_loaded.exchange(false);
+}
+
+/**
+ * @brief Set_file
+ * @param fname path of socket
+ * @return true if path was changed, it can't be changed while reader runs
+ */
+bool SocketReader::Set_file(const std::string_view & fname)
+{
+    if (_listen_socket >= 0)
+    {
+        return false;
+    }
+    _path = fname;
+    return true;
+}
+
+/**
+ * @brief Set_history_time_limit
+ * @param limit_in_sec limit of seconds of input history stored
+ */
+void SocketReader::Set_history_time_limit(int limit_in_sec)
+{
+    _data.Set_history_time_limit(limit_in_sec);
+}
+
+/**
+ * @brief Set_history_compression
+ * @param enabled if true, older intervals of history are stored compressed
+ */
+void SocketReader::Set_history_compression(bool enabled)
+{
+    _data.Set_compression(enabled);
+}
+
+/**
+ * @brief Freeze
+ * @note history returned by Get_data() stops changing, acquisition continues
+ * in background buffer
+ */
+void SocketReader::Freeze()
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _data.Freeze();
+}
+
+/**
+ * @brief Unfreeze
+ * @note intervals acquired while frozen are spliced into history
+ */
+void SocketReader::Unfreeze()
+{
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    if (_data.Unfreeze() > 0)
+    {
+        _new_data_loaded = true;
+    }
+}
+
+/**
+ * @brief Is_frozen
+ * @return true if history is frozen
+ */
+bool SocketReader::Is_frozen() const
+{
+    return _data.Is_frozen();
+}
+
+/**
+ * @brief Set_block_queue
+ * @param queue queue to which every interval is added after it is pushed to history, can be nullptr
+ * @note has to be called before Start(), queue is filled also while history is frozen
+ */
+void SocketReader::Set_block_queue(std::shared_ptr<BlockQueue> queue)
+{
+    _block_queue = std::move(queue);
+}
+
+/**
+ * @brief Set_archive
+ * @param archive archive to which every received interval is appended, can be nullptr
+ * @note archive is cleared on Resume(), because time starts again from 0
+ */
+void SocketReader::Set_archive(std::shared_ptr<HistoryArchive> archive)
+{
+    _archive = std::move(archive);
+}
+
+/**
+ * @brief Get_rejected_connections
+ * @return number of connections closed because they sent malformed frame
+ */
+std::uint64_t SocketReader::Get_rejected_connections() const
+{
+    return _rejected_connections;
+}
+
+/**
+ * @brief accept_client
+ * @note waits shortly for source and accepts its connection
+ */
+void SocketReader::accept_client()
+{
+    pollfd listening {_listen_socket, POLLIN, 0};
+    if (::poll(&listening, 1, poll_timeout_ms) <= 0)
+    {
+        return;
+    }
+    _client_socket = ::accept4(_listen_socket, nullptr, nullptr, SOCK_CLOEXEC);
+    _buffered = 0;
+    //new source starts its own sequence
+    _gap_detector.Reset();
+}
+
+/**
+ * @brief receive
+ * @note waits shortly for data of source, reads what is available and pushes complete frames
+ */
+void SocketReader::receive()
+{
+    if (_recv_buffer < 0)
+    {
+        _recv_buffer = _engine->Acquire_buffer();
+        if (!_engine->Submit_recv(_client_socket, _recv_buffer, 0))
+        {
+            _engine->Release_buffer(_recv_buffer);
+            _recv_buffer = -1;
+            return;
+        }
+    }
+    _completions.clear();
+    if (_engine->Wait(_completions, poll_timeout_ms) == 0)
+    {
+        return;
+    }
+    const int received = _completions.front()._result;
+    if (received == -EINTR || received == -EAGAIN)
+    {
+        //receive is submitted again
+        _engine->Release_buffer(_recv_buffer);
+        _recv_buffer = -1;
+        return;
+    }
+    if (received <= 0)
+    {
+        //source disconnected, next one is accepted
+        _engine->Release_buffer(_recv_buffer);
+        _recv_buffer = -1;
+        close_client();
+        return;
+    }
+    if (_buffer.size() - _buffered < static_cast<std::size_t>(received))
+    {
+        _buffer.resize(std::max(2 * _buffer.size(), _buffered + received));
+    }
+    std::memcpy(_buffer.data() + _buffered, _engine->Get_buffer(_recv_buffer).data(), received);
+    _buffered += static_cast<std::size_t>(received);
+    _engine->Release_buffer(_recv_buffer);
+    _recv_buffer = -1;
+
+    std::size_t offset = 0;
+    std::size_t needed = 0;
+    while (_buffered - offset >= sizeof(SampleFrameHeader))
+    {
+        SampleFrameHeader header;
+        std::memcpy(&header, _buffer.data() + offset, sizeof(header));
+        if (header._magic != sample_frame_magic || header._count > max_frame_points)
+        {
+            //stream can't be resynchronised
+            _rejected_connections++;
+            close_client();
+            return;
+        }
+        const std::size_t frame_size = sizeof(header) + header._count * sample_frame_point_size;
+        if (_buffered - offset < frame_size)
+        {
+            needed = frame_size;
+            break;
+        }
+        push_frame(_buffer.data() + offset + sizeof(header), header._count, header._sequence);
+        offset += frame_size;
+    }
+    //incomplete frame is moved to begin of buffer, buffer grows if it can't hold it
+    std::memmove(_buffer.data(), _buffer.data() + offset, _buffered - offset);
+    _buffered -= offset;
+    if (needed > _buffer.size())
+    {
+        _buffer.resize(needed);
+    }
+}
+
+/**
+ * @brief push_frame
+ * @param points samples of frame, pairs of time and voltage
+ * @param count number of samples
+ * @param sequence sequence number of frame
+ */
+void SocketReader::push_frame(const char * points, std::size_t count, std::uint64_t sequence)
+{
+    const std::uint64_t lost = _gap_detector.Check(sequence);
+    if (lost > 0)
+    {
+        //time of lost frames is skipped, so history does not drift against source
+        const HistoryGap gap {_start_time, _start_time + lost * _interval_span, lost};
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        _data.Record_gap(gap);
+        _start_time = gap._end_time;
+    }
+    if (count == 0)
+    {
+        return;
+    }
+    PipelineMetrics & metrics = PipelineMetrics::Instance();
+    //buffer of last interval size comes from pool without reallocations
+    RecordingVector vec(_pool.get());
+    {
+        ScopedStageTimer timer(PipelineStage::PARSE);
+        RecordingVector::type & data = vec.Get_container();
+        data.reserve(count);
+        double min_voltage = 0.0;
+        double max_voltage = 0.0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            double point[2];
+            std::memcpy(point, points + i * sample_frame_point_size, sample_frame_point_size);
+            data.emplace_back(point[0] + _start_time, point[1]);
+            min_voltage = (i == 0) ? point[1] : std::min(min_voltage, point[1]);
+            max_voltage = (i == 0) ? point[1] : std::max(max_voltage, point[1]);
+        }
+        RangeParams params({min_voltage, max_voltage}, {_start_time, data.back().Get_time()}, static_cast<int>(count));
+        vec.Set_recording_params(params);
+    }
+    const RangeParams params = vec.Get_recording_params();
+    metrics.Add(PipelineCounter::POINTS_PARSED, params.Get_max_index());
+    {
+        ScopedStageTimer timer(PipelineStage::PUSH);
+        if (_archive)
+        {
+            _archive->Append(vec);
+        }
+        BlockHandle block;
+        if (_block_queue)
+        {
+            //history keeps view of the same block, so timestamps are not copied
+            block = Make_block(std::move(vec), _pool);
+            vec = RecordingVector(block);
+        }
+        {
+            std::lock_guard<std::mutex> lock(_data_mutex);
+            _data.Push_recordingVector(std::move(vec));
+        }
+        //published after history has it, so consumer never gets block missing in history
+        if (block)
+        {
+            _block_queue->Push(std::move(block));
+        }
+    }
+    metrics.Add(PipelineCounter::INTERVALS_PUSHED);
+    _interval_span = params.Get_max_time() - params.Get_min_time();
+    _start_time = params.Get_max_time();
+    _new_data_loaded = true;
+}
+
+/**
+ * @brief close_client
+ * @note closes connection of source, incomplete frame is dropped
+ */
+void SocketReader::close_client()
+{
+    if (_client_socket >= 0)
+    {
+        if (_recv_buffer >= 0)
+        {
+            //receive in flight must finish before its socket and buffer are reused
+            ::shutdown(_client_socket, SHUT_RDWR);
+            _completions.clear();
+            while (_engine->Wait(_completions, poll_timeout_ms) == 0)
+            {
+                //Empty
+            }
+            _engine->Release_buffer(_recv_buffer);
+            _recv_buffer = -1;
+        }
+        ::close(_client_socket);
+        _client_socket = -1;
+    }
+    _buffered = 0;
+}
+
+/**
+ * @brief running_loop
+ * @note loop in which Reader receives data
+ */
+void SocketReader::running_loop(void)
+{
+    if (!_running)
+    {
+        const std::chrono::duration sleep_time_stopped = std::chrono::milliseconds(100);
+        PipelineMetrics::Instance().Set_thread_name("SocketReader");
+        _running = true;
+        _destroyed = false;
+        while (!_destroy_flag)
+        {
+            if (_stop_flag)
+            {
+                std::this_thread::sleep_for(sleep_time_stopped);
+                continue;
+            }
+            if (_client_socket < 0)
+            {
+                _state = ReaderState::WAITING;
+                accept_client();
+                continue;
+            }
+            _state = ReaderState::READING;
+            TraceScope trace("SocketReader::receive");
+            receive();
+        }
+        close_client();
+        _running = false;
+        _destroyed = true;
+    }
+}
+
+/**
+ * @brief Start
+ * @note starts listening on socket and execution of Reader thread
+ * @throw std::runtime_error if socket can't be created
+ */
+void SocketReader::Start()
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("Socket path too long: " + _path);
+    }
+    std::memcpy(address.sun_path, _path.c_str(), _path.size() + 1);
+    _listen_socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_listen_socket < 0)
+    {
+        throw std::runtime_error("Can't create socket");
+    }
+    //socket left by previous run
+    ::unlink(_path.c_str());
+    if (::bind(_listen_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(_listen_socket, 1) != 0)
+    {
+        ::close(_listen_socket);
+        _listen_socket = -1;
+        throw std::runtime_error("Can't listen on socket " + _path);
+    }
+    _buffer.resize(batch_bytes);
+    if (!_engine)
+    {
+        _engine = Create_read_engine(1, batch_bytes);
+    }
+    _destroy_flag = false;
+    _thread = std::thread(&SocketReader::running_loop, this);
+}
+
+/**
+ * @brief Stop
+ * @note stops execution of Reader thread, source can't send until Resume()
+ */
+void SocketReader::Stop()
+{
+    _stop_flag = true;
+    _start_time = 0;
+    _gap_detector.Reset();
+    _data.Clear();
+    _state = ReaderState::STOPPED;
+}
+
+/**
+ * @brief Resume
+ * @note resumes execution after Stop() was called
+ */
+void SocketReader::Resume()
+{
+    if (_archive)
+    {
+        _archive->Clear();
+    }
+    _stop_flag = false;
+    _state = ReaderState::WAITING;
+}
+
+/**
+ * @brief Destroy
+ * @note destroys thread and closes socket, after this new thread with Start() can be created
+ */
+void SocketReader::Destroy()
+{
+    _destroy_flag = true;
+    if (_thread.joinable())
+        _thread.join();
+    if (_listen_socket >= 0)
+    {
+        ::close(_listen_socket);
+        _listen_socket = -1;
+        ::unlink(_path.c_str());
+    }
+    _state = ReaderState::DESTROYED;
+}
+
+SocketReader::~SocketReader()
+{
+    Destroy();
+}
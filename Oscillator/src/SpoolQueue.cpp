@@ -0,0 +1,173 @@
+#include "SpoolQueue.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <string>
+#include <utility>
+
+namespace
+{
+constexpr std::string_view block_extension = ".blk";
+constexpr std::string_view partial_extension = ".part";
+}
+
+/**
+ * @brief SpoolQueue constructor
+ * @param directory path of spool directory
+ */
+SpoolQueue::SpoolQueue(std::string_view directory)
+    : _directory(directory)
+{
+    //Empty
+}
+
+/**
+ * @brief Reset
+ * @return true if spool directory exists and is empty
+ * @note directory is created, blocks left by previous run are removed
+ */
+bool SpoolQueue::Reset()
+{
+    std::error_code ec;
+    //file of single file transport may have the same name
+    if (std::filesystem::exists(_directory, ec) && !std::filesystem::is_directory(_directory, ec))
+    {
+        std::filesystem::remove(_directory, ec);
+    }
+    std::filesystem::create_directories(_directory, ec);
+    for (const auto & entry : std::filesystem::directory_iterator(_directory, ec))
+    {
+        std::filesystem::remove(entry.path(), ec);
+    }
+    _next_sequence = 0;
+    return std::filesystem::is_empty(_directory, ec) && !ec;
+}
+
+/**
+ * @brief Publish
+ * @param content content of block
+ * @return true if block was published
+ * @note block is written to temporary file and renamed, rename is atomic within directory
+ */
+bool SpoolQueue::Publish(std::string_view content)
+{
+    //zero padded, so names sort in order of sequence
+    std::string name = std::to_string(_next_sequence);
+    name.insert(0, 20 - std::min<std::size_t>(name.size(), 20), '0');
+    const std::filesystem::path partial = _directory / (name + std::string(partial_extension));
+    {
+        std::ofstream file(partial, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!file.flush())
+        {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(partial, _directory / (name + std::string(block_extension)), ec);
+    if (ec)
+    {
+        std::filesystem::remove(partial, ec);
+        return false;
+    }
+    _next_sequence++;
+    return true;
+}
+
+/**
+ * @brief Skip
+ * @note sequence number of block which is not published is skipped, so reader sees gap
+ */
+void SpoolQueue::Skip()
+{
+    _next_sequence++;
+}
+
+/**
+ * @brief Drop_oldest
+ * @return true if oldest published block was removed before reader took it
+ */
+bool SpoolQueue::Drop_oldest()
+{
+    std::vector<std::filesystem::path> oldest;
+    Get_pending(oldest, 1);
+    std::error_code ec;
+    //reader which removes it first wins, then block was not dropped
+    return !oldest.empty() && std::filesystem::remove(oldest.front(), ec);
+}
+
+/**
+ * @brief Get_pending
+ * @param out published blocks in order of sequence, it is cleared first
+ * @param max_count maximal number of returned blocks
+ */
+void SpoolQueue::Get_pending(std::vector<std::filesystem::path> & out, std::size_t max_count) const
+{
+    out.clear();
+    std::vector<std::pair<std::uint64_t, std::filesystem::path>> blocks;
+    std::error_code ec;
+    for (const auto & entry : std::filesystem::directory_iterator(_directory, ec))
+    {
+        std::uint64_t sequence = 0;
+        if (Parse_sequence(entry.path(), sequence))
+        {
+            blocks.emplace_back(sequence, entry.path());
+        }
+    }
+    const std::size_t count = std::min(max_count, blocks.size());
+    std::partial_sort(blocks.begin(), blocks.begin() + count, blocks.end(),
+                      [](const auto & a, const auto & b) { return a.first < b.first; });
+    for (std::size_t i = 0; i < count; i++)
+    {
+        out.push_back(std::move(blocks[i].second));
+    }
+}
+
+/**
+ * @brief Count_pending
+ * @return number of published blocks which were not removed by reader yet
+ */
+std::size_t SpoolQueue::Count_pending() const
+{
+    std::size_t count = 0;
+    std::error_code ec;
+    for (const auto & entry : std::filesystem::directory_iterator(_directory, ec))
+    {
+        std::uint64_t sequence = 0;
+        if (Parse_sequence(entry.path(), sequence))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Get_directory
+ * @return path of spool directory
+ */
+const std::filesystem::path& SpoolQueue::Get_directory() const
+{
+    return _directory;
+}
+
+/**
+ * @brief Parse_sequence
+ * @param block path of file in spool directory
+ * @param sequence sequence number of block
+ * @return true if file is published block
+ */
+bool SpoolQueue::Parse_sequence(const std::filesystem::path & block, std::uint64_t & sequence)
+{
+    if (block.extension() != block_extension)
+    {
+        return false;
+    }
+    const std::string stem = block.stem().string();
+    const auto [end, error] = std::from_chars(stem.data(), stem.data() + stem.size(), sequence);
+    return error == std::errc() && end == stem.data() + stem.size();
+}
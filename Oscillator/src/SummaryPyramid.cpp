@@ -0,0 +1,259 @@
+#include "SummaryPyramid.h"
+#include "PipelineMetrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+/**
+ * @brief merge
+ * @param into bucket which extremes are extended
+ * @param bucket bucket merged into it
+ */
+void merge(SummaryBucket & into, const SummaryBucket & bucket)
+{
+    if (bucket._min.Get_voltage() < into._min.Get_voltage())
+    {
+        into._min = bucket._min;
+    }
+    if (bucket._max.Get_voltage() > into._max.Get_voltage())
+    {
+        into._max = bucket._max;
+    }
+}
+
+/**
+ * @brief append_extremes
+ * @param bucket extremes of one column
+ * @param out min & max point are appended in time order, so line goes through both
+ */
+void append_extremes(const SummaryBucket & bucket, std::vector<Timestamp> & out)
+{
+    const bool min_first = bucket._min.Get_time() <= bucket._max.Get_time();
+    out.push_back(min_first ? bucket._min : bucket._max);
+    if (bucket._min.Get_time() != bucket._max.Get_time() || bucket._min.Get_voltage() != bucket._max.Get_voltage())
+    {
+        out.push_back(min_first ? bucket._max : bucket._min);
+    }
+}
+
+}
+
+/**
+ * @brief SummaryPyramid constructor
+ * @param pool pool which builds summaries, nullptr means Add_block() builds them
+ */
+SummaryPyramid::SummaryPyramid(std::shared_ptr<TaskPool> pool)
+    : _pool(std::move(pool)), _summarized(std::make_shared<std::atomic<std::size_t>>(0))
+{
+    //Empty
+}
+
+/**
+ * @brief Set_history_time_limit
+ * @param limit_in_sec seconds before newest added point which are kept summarized
+ */
+void SummaryPyramid::Set_history_time_limit(int limit_in_sec)
+{
+    _time_limit = limit_in_sec;
+}
+
+/**
+ * @brief Add_block
+ * @param block interval newer than all added before
+ * @note summary is built later by task of pool, empty block is ignored, summaries older
+ * than history time limit are evicted
+ */
+void SummaryPyramid::Add_block(BlockHandle block)
+{
+    const RangeParams params = block->Get_recording_params();
+    if (params.Get_max_index() == 0)
+    {
+        return;
+    }
+    auto summary = std::make_shared<BlockSummary>();
+    summary->_min_time = params.Get_min_time();
+    summary->_max_time = params.Get_max_time();
+    const double point_time = (params.Get_max_index() > 1)
+        ? (params.Get_max_time() - params.Get_min_time()) / (params.Get_max_index() - 1) : 0.0;
+    summary->_bucket_time = point_time * bucket_points;
+    summary->_envelope = SummaryBucket {params.Get_min_time(),
+        Timestamp(params.Get_min_time(), params.Get_min_voltage()),
+        Timestamp(params.Get_max_time(), params.Get_max_voltage())};
+    _blocks.push_back(summary);
+    _added++;
+    //task of evicted summary still finishes, it owns summary too
+    const double oldest_kept = params.Get_max_time() - _time_limit;
+    while (!_blocks.empty() && _blocks.front()->_max_time < oldest_kept)
+    {
+        _blocks.pop_front();
+    }
+
+    auto task = [block = std::move(block), summary, summarized = _summarized] {
+        ScopedStageTimer timer(PipelineStage::SUMMARIZE);
+        build_levels(*block, *summary);
+        summary->_ready.store(true, std::memory_order_release);
+        summarized->fetch_add(1, std::memory_order_relaxed);
+    };
+    if (_pool)
+    {
+        _pool->Submit(PipelineStage::SUMMARIZE, std::move(task));
+    }
+    else
+    {
+        task();
+    }
+}
+
+/**
+ * @brief build_levels
+ * @param block interval to summarize
+ * @param summary summary which levels are built
+ */
+void SummaryPyramid::build_levels(const RecordingVector & block, BlockSummary & summary)
+{
+    const RecordingVector::type decompressed = block.Is_compressed() ? block.Decompress() : RecordingVector::type();
+    const RecordingVector::type & data = block.Is_compressed() ? decompressed : block.Get_container();
+    std::vector<SummaryBucket> level;
+    level.reserve((data.size() + bucket_points - 1) / bucket_points);
+    for (std::size_t begin = 0; begin < data.size(); begin += bucket_points)
+    {
+        const std::size_t end = std::min(begin + bucket_points, data.size());
+        SummaryBucket bucket {data[begin].Get_time(), data[begin], data[begin]};
+        for (std::size_t i = begin + 1; i < end; i++)
+        {
+            if (data[i].Get_voltage() < bucket._min.Get_voltage())
+            {
+                bucket._min = data[i];
+            }
+            if (data[i].Get_voltage() > bucket._max.Get_voltage())
+            {
+                bucket._max = data[i];
+            }
+        }
+        level.push_back(bucket);
+    }
+    //every level is reduction of level below it
+    while (level.size() > 1)
+    {
+        std::vector<SummaryBucket> upper;
+        upper.reserve((level.size() + level_fanout - 1) / level_fanout);
+        for (std::size_t begin = 0; begin < level.size(); begin += level_fanout)
+        {
+            SummaryBucket bucket = level[begin];
+            const std::size_t end = std::min(begin + level_fanout, level.size());
+            for (std::size_t i = begin + 1; i < end; i++)
+            {
+                merge(bucket, level[i]);
+            }
+            upper.push_back(bucket);
+        }
+        summary._levels.push_back(std::move(level));
+        level = std::move(upper);
+    }
+    summary._levels.push_back(std::move(level));
+}
+
+/**
+ * @brief Query
+ * @param min_time begin of requested time range
+ * @param max_time end of requested time range
+ * @param columns number of equal time columns of range, e.g. pixels
+ * @param out min & max points of each column in time order, it is cleared first
+ * @return false if summaries are coarser than one column, points have to be decimated then
+ */
+bool SummaryPyramid::Query(double min_time, double max_time, int columns, std::vector<Timestamp> & out) const
+{
+    out.clear();
+    if (_blocks.empty() || columns <= 0 || max_time <= min_time)
+    {
+        return false;
+    }
+    const double column_time = (max_time - min_time) / columns;
+    auto block = std::lower_bound(_blocks.begin(), _blocks.end(), min_time,
+        [](const std::shared_ptr<BlockSummary> & summary, double time) { return summary->_max_time < time; });
+    long column = -1;
+    SummaryBucket extremes {};
+    for (; block != _blocks.end() && (*block)->_min_time <= max_time; ++block)
+    {
+        const BlockSummary & summary = **block;
+        const SummaryBucket * bucket = &summary._envelope;
+        const SummaryBucket * end = bucket + 1;
+        double bucket_time = summary._max_time - summary._min_time;
+        if (summary._ready.load(std::memory_order_acquire))
+        {
+            if (summary._bucket_time > column_time)
+            {
+                out.clear();
+                return false;
+            }
+            /*coarsest level with at least level_fanout buckets per column, buckets are not aligned
+            to columns, so extremes of column may come from at most one bucket of neighbour column */
+            std::size_t level = 0;
+            bucket_time = summary._bucket_time;
+            while (level + 1 < summary._levels.size() && bucket_time * level_fanout * level_fanout <= column_time)
+            {
+                level++;
+                bucket_time *= level_fanout;
+            }
+            bucket = summary._levels[level].data();
+            end = bucket + summary._levels[level].size();
+        }
+        for (; bucket != end && bucket->_start_time <= max_time; ++bucket)
+        {
+            if (bucket->_start_time + bucket_time < min_time)
+            {
+                continue;
+            }
+            const long bucket_column = std::max(0L, static_cast<long>(std::floor((bucket->_start_time - min_time) / column_time)));
+            if (bucket_column != column)
+            {
+                if (column >= 0)
+                {
+                    append_extremes(extremes, out);
+                }
+                column = bucket_column;
+                extremes = *bucket;
+            }
+            else
+            {
+                merge(extremes, *bucket);
+            }
+        }
+    }
+    if (column >= 0)
+    {
+        append_extremes(extremes, out);
+    }
+    return true;
+}
+
+/**
+ * @brief Get_progress
+ * @return number of added and summarized blocks
+ */
+SummaryProgress SummaryPyramid::Get_progress() const
+{
+    return SummaryProgress {_added, _summarized->load(std::memory_order_relaxed)};
+}
+
+/**
+ * @brief Get_min_time
+ * @return time of oldest point which is summarized, 0.0 if nothing was added
+ */
+double SummaryPyramid::Get_min_time() const
+{
+    return _blocks.empty() ? 0.0 : _blocks.front()->_min_time;
+}
+
+/**
+ * @brief Clear
+ * @note forgets all blocks, tasks still running finish on their own data
+ */
+void SummaryPyramid::Clear()
+{
+    _blocks.clear();
+    _added = 0;
+    _summarized = std::make_shared<std::atomic<std::size_t>>(0);
+}
@@ -0,0 +1,342 @@
+#include "TaskPool.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <string>
+
+namespace
+{
+//pool and index of worker running on this thread, so its submits go to its own queues
+thread_local const TaskPool * current_pool = nullptr;
+thread_local std::size_t current_worker = 0;
+}
+
+/**
+ * @brief TaskPool constructor
+ * @param workers number of worker threads, 0 means one less than hardware threads (at least one),
+ * thread waiting for its tasks runs queued tasks too
+ */
+TaskPool::TaskPool(std::size_t workers)
+{
+    if (workers == 0)
+    {
+        const unsigned hardware_threads = std::thread::hardware_concurrency();
+        workers = (hardware_threads > 1) ? hardware_threads - 1 : 1;
+    }
+    for (std::atomic<TaskPriority> & priority : _priorities)
+    {
+        priority = TaskPriority::NORMAL;
+    }
+    //intervals are parsed and filtered while user waits for them on screen
+    Set_stage_priority(PipelineStage::PARSE, TaskPriority::HIGH);
+    Set_stage_priority(PipelineStage::FILTER, TaskPriority::HIGH);
+    //indexing of capture only prepares intervals user didn't request yet
+    Set_stage_priority(PipelineStage::INDEX, TaskPriority::LOW);
+    _workers.reserve(workers);
+    for (std::size_t i = 0; i < workers; i++)
+    {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < workers; i++)
+    {
+        _workers[i]->_thread = std::thread(&TaskPool::running_loop, this, i);
+    }
+}
+
+/**
+ * @brief Submit
+ * @param stage stage of pipeline which task belongs to, it gives priority
+ * @param task work to run, it must not throw (see TaskGroup)
+ */
+void TaskPool::Submit(PipelineStage stage, Task task)
+{
+    const std::size_t priority = static_cast<std::size_t>(Get_stage_priority(stage));
+    //other threads spread their tasks over workers, worker keeps its tasks hot in its cache
+    const std::size_t target = (current_pool == this)
+        ? current_worker : _next_worker.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+    {
+        std::lock_guard<std::mutex> lock(_workers[target]->_mutex);
+        _workers[target]->_queues[priority].push_back(std::move(task));
+    }
+    {
+        //under lock, so worker which just found no task can't miss wake up
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _queued.fetch_add(1, std::memory_order_release);
+    }
+    _wake.notify_one();
+}
+
+/**
+ * @brief take_task
+ * @param self index of calling worker, workers count if caller is not worker
+ * @param lowest lowest priority of task which may be taken
+ * @param task taken task
+ * @return false if no such task is queued
+ */
+bool TaskPool::take_task(std::size_t self, TaskPriority lowest, Task & task)
+{
+    if (_queued.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+    for (std::size_t priority = 0; priority <= static_cast<std::size_t>(lowest); priority++)
+    {
+        if (self < _workers.size())
+        {
+            Worker & worker = *_workers[self];
+            std::lock_guard<std::mutex> lock(worker._mutex);
+            std::deque<Task> & queue = worker._queues[priority];
+            if (!queue.empty())
+            {
+                task = std::move(queue.back());
+                queue.pop_back();
+                _queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (std::size_t k = 1; k <= _workers.size(); k++)
+        {
+            const std::size_t victim = (self + k) % _workers.size();
+            if (victim == self)
+            {
+                continue;
+            }
+            Worker & worker = *_workers[victim];
+            std::lock_guard<std::mutex> lock(worker._mutex);
+            std::deque<Task> & queue = worker._queues[priority];
+            if (!queue.empty())
+            {
+                task = std::move(queue.front());
+                queue.pop_front();
+                _queued.fetch_sub(1, std::memory_order_relaxed);
+                _stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Run_pending_task
+ * @param lowest lowest priority of task which may be run
+ * @return true if one queued task was run by calling thread
+ * @note used by threads which wait for their tasks, so waiting thread is not idle
+ */
+bool TaskPool::Run_pending_task(TaskPriority lowest)
+{
+    Task task;
+    if (!take_task((current_pool == this) ? current_worker : _workers.size(), lowest, task))
+    {
+        return false;
+    }
+    task();
+    return true;
+}
+
+/**
+ * @brief running_loop
+ * @param self index of worker
+ * @note loop in which worker runs tasks
+ */
+void TaskPool::running_loop(std::size_t self)
+{
+    current_pool = this;
+    current_worker = self;
+    const std::string name = "TaskPool " + std::to_string(self);
+    PipelineMetrics::Instance().Set_thread_name(name);
+    Tracer::Instance().Set_thread_name(name);
+    Task task;
+    while (!_destroy_flag)
+    {
+        if (take_task(self, TaskPriority::LOW, task))
+        {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_sleep_mutex);
+        _wake.wait(lock, [this] {
+            return _destroy_flag.load() || _queued.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+/**
+ * @brief Set_stage_priority
+ * @param stage stage of pipeline
+ * @param priority priority of tasks submitted by stage from now on
+ */
+void TaskPool::Set_stage_priority(PipelineStage stage, TaskPriority priority)
+{
+    _priorities[static_cast<std::size_t>(stage)].store(priority, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get_stage_priority
+ * @param stage stage of pipeline
+ * @return priority of tasks submitted by stage
+ */
+TaskPriority TaskPool::Get_stage_priority(PipelineStage stage) const
+{
+    return _priorities[static_cast<std::size_t>(stage)].load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get_worker_count
+ * @return number of worker threads
+ */
+std::size_t TaskPool::Get_worker_count() const
+{
+    return _workers.size();
+}
+
+/**
+ * @brief Get_stolen
+ * @return number of tasks run by other worker than one they were queued to
+ */
+std::uint64_t TaskPool::Get_stolen() const
+{
+    return _stolen.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief TaskPool destructor
+ * @note waits only for running tasks, queued tasks are discarded
+ */
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _destroy_flag = true;
+    }
+    _wake.notify_all();
+    for (std::unique_ptr<Worker> & worker : _workers)
+    {
+        worker->_thread.join();
+    }
+    //background tasks (capture indexing) could keep destructor waiting long, or resubmit themselves,
+    //nobody waits for queued tasks when pool is released, their captures are released here
+    for (std::unique_ptr<Worker> & worker : _workers)
+    {
+        for (std::deque<Task> & queue : worker->_queues)
+        {
+            queue.clear();
+        }
+    }
+}
+
+/**
+ * @brief TaskGroup constructor
+ * @param pool pool which runs tasks, can be nullptr
+ * @param stage stage of pipeline which tasks belong to
+ */
+TaskGroup::TaskGroup(TaskPool * pool, PipelineStage stage)
+    : _pool(pool), _stage(stage)
+{
+    //Empty
+}
+
+/**
+ * @brief Run
+ * @param task work to run, it can reference data of caller until Wait() returns
+ */
+void TaskGroup::Run(TaskPool::Task task)
+{
+    if (!_pool)
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            if (!_error)
+            {
+                _error = std::current_exception();
+            }
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending++;
+    }
+    _pool->Submit(_stage, [this, task = std::move(task)] {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_error)
+            {
+                _error = std::current_exception();
+            }
+        }
+        //notified under lock, waiting thread can destroy group only after it is released
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_pending == 0)
+        {
+            _done.notify_all();
+        }
+    });
+}
+
+/**
+ * @brief wait_pending
+ * @note waits for all tasks without rethrowing their exception
+ */
+void TaskGroup::wait_pending()
+{
+    if (!_pool)
+    {
+        return;
+    }
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_pending == 0)
+            {
+                return;
+            }
+        }
+        //tasks of group which nobody took yet may be run by this thread, tasks of lower priority
+        //(e.g. background indexing) are left to workers, so they don't delay this group
+        if (!_pool->Run_pending_task(_pool->Get_stage_priority(_stage)))
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _done.wait(lock, [this] { return _pending == 0; });
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Wait
+ * @note returns when all tasks of group finished
+ * @throws exception thrown by first failed task
+ */
+void TaskGroup::Wait()
+{
+    wait_pending();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::swap(error, _error);
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @brief TaskGroup destructor
+ * @note waits for tasks which were not waited for
+ */
+TaskGroup::~TaskGroup()
+{
+    wait_pending();
+}
@@ -0,0 +1,232 @@
+#include "TextCodec.h"
+#include "PipelineMetrics.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+//smaller texts are not worth splitting into tasks
+constexpr std::size_t min_chunk_bytes = 1 << 20;
+//longest shortest form of double, e.g. "-2.2250738585072014e-308", is 24 characters
+constexpr std::size_t max_number_chars = 32;
+
+/**
+ * @struct Chunk
+ * Timestamps decoded by one task with range of their voltages
+ */
+struct Chunk
+{
+    std::vector<Timestamp> _data;
+    double _min_voltage = 0.0;
+    double _max_voltage = 0.0;
+};
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief skip_line
+ * @return position after next line break, or end
+ */
+const char* skip_line(const char * position, const char * end)
+{
+    const void * line_break = std::memchr(position, '\n', end - position);
+    return (line_break != nullptr) ? static_cast<const char*>(line_break) + 1 : end;
+}
+
+/**
+ * @brief decode_chunk
+ * @param text complete lines of "time voltage"
+ * @param start_time time added to every timestamp read
+ * @param out decoded timestamps are appended to it
+ * @param min_voltage min voltage of appended timestamps, not changed if nothing was appended
+ * @param max_voltage max voltage of appended timestamps, not changed if nothing was appended
+ */
+template <class Container>
+void decode_chunk(std::string_view text, double start_time, Container & out, double & min_voltage, double & max_voltage)
+{
+    const char * position = text.data();
+    const char * const end = text.data() + text.size();
+    bool is_first = true;
+    while (true)
+    {
+        while (position != end && is_space(*position))
+        {
+            position++;
+        }
+        if (position == end)
+        {
+            break;
+        }
+        double time = 0.0;
+        const auto [time_end, time_error] = std::from_chars(position, end, time);
+        if (time_error != std::errc())
+        {
+            position = skip_line(position, end);
+            continue;
+        }
+        position = time_end;
+        //voltage has to be on the same line, so line with time only is not paired with next line
+        while (position != end && (*position == ' ' || *position == '\t'))
+        {
+            position++;
+        }
+        double voltage = 0.0;
+        const auto [voltage_end, voltage_error] = std::from_chars(position, end, voltage);
+        if (voltage_error != std::errc())
+        {
+            position = skip_line(position, end);
+            continue;
+        }
+        position = voltage_end;
+        out.emplace_back(time + start_time, voltage);
+        if (is_first)
+        {
+            min_voltage = voltage;
+            max_voltage = voltage;
+            is_first = false;
+        }
+        min_voltage = std::min(min_voltage, voltage);
+        max_voltage = std::max(max_voltage, voltage);
+    }
+}
+}
+
+/**
+ * @brief Encode_interval
+ * @param values voltages of one interval
+ * @param step time between two samples, time of first sample is 0
+ * @param last_time time of last sample, decimated interval keeps its last sample off step
+ * @param out encoded lines are appended to it, last line has no line break
+ * @note numbers are written in shortest form which is read back to the same double
+ */
+void TextCodec::Encode_interval(std::span<const double> values, double step, double last_time, std::string & out)
+{
+    if (values.empty())
+    {
+        return;
+    }
+    const std::size_t begin = out.size();
+    out.resize(begin + values.size() * (2 * max_number_chars + 2));
+    char * position = out.data() + begin;
+    char * const end = out.data() + out.size();
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        position = std::to_chars(position, end, (i + 1 < values.size()) ? step * i : last_time).ptr;
+        *position++ = ' ';
+        position = std::to_chars(position, end, values[i]).ptr;
+        *position++ = '\n';
+    }
+    //last line has no line break, same as in files written by older Generator
+    out.resize(position - 1 - out.data());
+}
+
+/**
+ * @brief Decode_interval
+ * @param text lines of "time voltage", time and voltage separated by spaces or tabs
+ * @param start_time time added to every timestamp read
+ * @param resource memory resource from which timestamps are allocated
+ * @param expected_points number of timestamps reserved before reading
+ * @param pool pool which parses chunks of large text, nullptr means calling thread parses whole text
+ * @return interval with read timestamps and its parameters
+ * @note incomplete or malformed line is skipped, so truncated text gives no bogus sample
+ */
+RecordingVector TextCodec::Decode_interval(std::string_view text, double start_time,
+    std::pmr::memory_resource * resource, int expected_points, TaskPool * pool)
+{
+    TraceScope trace("TextCodec::Decode_interval");
+    RecordingVector vec(resource);
+    RecordingVector::type & data = vec.Get_container();
+    data.reserve(std::max(expected_points, 0));
+    double min_voltage = 0.0;
+    double max_voltage = 0.0;
+
+    //one chunk per worker, with single worker splitting would only add overhead
+    const std::size_t max_chunks = pool ? pool->Get_worker_count() : 1;
+    const std::size_t chunk_count = std::clamp<std::size_t>(text.size() / min_chunk_bytes, 1, max_chunks);
+    if (chunk_count == 1)
+    {
+        decode_chunk(text, start_time, data, min_voltage, max_voltage);
+    }
+    else
+    {
+        //chunks are split after line breaks, so no line is cut
+        std::vector<std::string_view> parts;
+        std::size_t part_begin = 0;
+        for (std::size_t k = 1; k <= chunk_count; k++)
+        {
+            std::size_t part_end = text.size();
+            if (k < chunk_count)
+            {
+                part_end = std::max(part_begin, text.size() * k / chunk_count);
+                const std::size_t line_break = text.find('\n', part_end);
+                part_end = (line_break == std::string_view::npos) ? text.size() : line_break + 1;
+            }
+            parts.push_back(text.substr(part_begin, part_end - part_begin));
+            part_begin = part_end;
+        }
+        std::vector<Chunk> chunks(parts.size());
+        TaskGroup group(pool, PipelineStage::PARSE);
+        for (std::size_t k = 1; k < parts.size(); k++)
+        {
+            group.Run([&parts, &chunks, start_time, k] {
+                decode_chunk(parts[k], start_time, chunks[k]._data, chunks[k]._min_voltage, chunks[k]._max_voltage);
+            });
+        }
+        decode_chunk(parts[0], start_time, chunks[0]._data, chunks[0]._min_voltage, chunks[0]._max_voltage);
+        group.Wait();
+        std::size_t total = 0;
+        for (const Chunk & chunk : chunks)
+        {
+            total += chunk._data.size();
+        }
+        data.reserve(total);
+        for (const Chunk & chunk : chunks)
+        {
+            if (chunk._data.empty())
+            {
+                continue;
+            }
+            min_voltage = data.empty() ? chunk._min_voltage : std::min(min_voltage, chunk._min_voltage);
+            max_voltage = data.empty() ? chunk._max_voltage : std::max(max_voltage, chunk._max_voltage);
+            data.insert(data.end(), chunk._data.begin(), chunk._data.end());
+        }
+    }
+
+    //empty interval ends where it started, so next interval continues from the same time
+    const double max_time = data.empty() ? start_time : data.back().Get_time();
+    RangeParams params({min_voltage, max_voltage}, {start_time, max_time}, static_cast<int>(data.size()));
+    vec.Set_recording_params(params);
+    return vec;
+}
+
+/**
+ * @brief Read_file
+ * @param fname path to file
+ * @param out whole content of file, buffer is reused between calls
+ * @return false if file can't be opened or read
+ */
+bool TextCodec::Read_file(const std::filesystem::path & fname, std::string & out)
+{
+    std::ifstream file(fname, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(fname, ec);
+    if (ec)
+    {
+        return false;
+    }
+    out.resize(size);
+    file.read(out.data(), static_cast<std::streamsize>(size));
+    //file can be shorter than its size was, when it is being rewritten
+    out.resize(static_cast<std::size_t>(file.gcount()));
+    return !file.bad();
+}
@@ -0,0 +1,209 @@
+#include "Tracer.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+//buffer of calling thread, set on first event
+thread_local void * local_buffer = nullptr;
+
+/**
+ * @brief write_escaped
+ * @note writes string as JSON string literal
+ */
+void write_escaped(std::ostream & out, const std::string_view & text)
+{
+    out << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+}
+
+/**
+ * @brief Instance
+ * @return tracer shared by whole application
+ */
+Tracer& Tracer::Instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+    : _epoch(std::chrono::steady_clock::now())
+{
+    //Empty
+}
+
+/**
+ * @brief Set_enabled
+ * @param enabled true to start recording events
+ */
+void Tracer::Set_enabled(bool enabled)
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Is_enabled
+ * @return true if events are recorded
+ */
+bool Tracer::Is_enabled() const
+{
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief local
+ * @return buffer of calling thread, registered on first call
+ */
+Tracer::ThreadBuffer& Tracer::local()
+{
+    if (!local_buffer)
+    {
+        std::lock_guard<std::mutex> lock(_registry_mutex);
+        _threads.push_back(std::make_unique<ThreadBuffer>());
+        _threads.back()->_tid = static_cast<int>(_threads.size());
+        _threads.back()->_name = "thread " + std::to_string(_threads.size());
+        local_buffer = _threads.back().get();
+    }
+    return *static_cast<ThreadBuffer*>(local_buffer);
+}
+
+/**
+ * @brief Set_thread_name
+ * @param name name of calling thread shown in timeline
+ */
+void Tracer::Set_thread_name(const std::string_view & name)
+{
+    ThreadBuffer & buffer = local();
+    std::lock_guard<std::mutex> lock(_registry_mutex);
+    buffer._name = name;
+}
+
+/**
+ * @brief Record
+ * @param name name of event, has to be string literal (pointer is stored)
+ * @param start moment when event started
+ * @param end moment when event finished
+ */
+void Tracer::Record(const char * name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    ThreadBuffer & buffer = local();
+    const std::uint64_t head = buffer._head.load(std::memory_order_relaxed);
+    Event & event = buffer._events[head % events_per_thread];
+    event._name.store(name, std::memory_order_relaxed);
+    event._start_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start - _epoch).count(), std::memory_order_relaxed);
+    event._duration_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), std::memory_order_relaxed);
+    //publishes event to Write_chrome_trace()
+    buffer._head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Write_chrome_trace
+ * @param out stream to which JSON is written
+ * @return number of written events
+ */
+std::size_t Tracer::Write_chrome_trace(std::ostream & out) const
+{
+    struct Copy
+    {
+        const char * _name;
+        std::int64_t _start_ns;
+        std::int64_t _duration_ns;
+    };
+    std::size_t written = 0;
+    bool first = true;
+    auto separator = [&]()
+    {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    //timestamps in microseconds with nanosecond resolution
+    out << std::fixed << std::setprecision(3);
+
+    std::lock_guard<std::mutex> lock(_registry_mutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    std::vector<Copy> events;
+    for (const std::unique_ptr<ThreadBuffer> & buffer : _threads)
+    {
+        separator();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->_tid << ",\"args\":{\"name\":";
+        write_escaped(out, buffer->_name);
+        out << "}}";
+
+        const std::uint64_t head = buffer->_head.load(std::memory_order_acquire);
+        std::uint64_t first_event = std::max(buffer->_tail.load(std::memory_order_relaxed),
+                                             head > events_per_thread ? head - events_per_thread : 0);
+        events.clear();
+        for (std::uint64_t i = first_event; i < head; i++)
+        {
+            const Event & event = buffer->_events[i % events_per_thread];
+            events.push_back({event._name.load(std::memory_order_relaxed),
+                              event._start_ns.load(std::memory_order_relaxed),
+                              event._duration_ns.load(std::memory_order_relaxed)});
+        }
+        //events overwritten by owner thread during copying are dropped
+        const std::uint64_t new_head = buffer->_head.load(std::memory_order_acquire);
+        const std::uint64_t valid_from = new_head > events_per_thread ? new_head - events_per_thread : 0;
+        for (std::uint64_t i = first_event; i < head; i++)
+        {
+            const Copy & event = events[i - first_event];
+            if (i < valid_from || !event._name)
+            {
+                continue;
+            }
+            separator();
+            out << "{\"name\":";
+            write_escaped(out, event._name);
+            out << ",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->_tid
+                << ",\"ts\":" << event._start_ns / 1000.0
+                << ",\"dur\":" << event._duration_ns / 1000.0 << '}';
+            written++;
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+    return written;
+}
+
+/**
+ * @brief Dump
+ * @param fname name of JSON file
+ * @return true if file was written
+ */
+bool Tracer::Dump(const std::string & fname) const
+{
+    std::ofstream file(fname);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    Write_chrome_trace(file);
+    return file.good();
+}
+
+/**
+ * @brief Clear
+ * @note drops recorded events, names of threads are kept
+ */
+void Tracer::Clear()
+{
+    std::lock_guard<std::mutex> lock(_registry_mutex);
+    for (std::unique_ptr<ThreadBuffer> & buffer : _threads)
+    {
+        buffer->_tail.store(buffer->_head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
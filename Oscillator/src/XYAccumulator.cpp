@@ -0,0 +1,356 @@
+#include "XYAccumulator.h"
+#include "PipelineMetrics.h"
+
+namespace
+{
+//max samples of one channel waiting for other channel, older samples are dropped
+constexpr std::size_t max_waiting_samples = 1 << 22;
+
+/**
+ * @brief append
+ * @param work not processed samples of channel
+ * @param block new samples of channel
+ * @return number of dropped samples
+ * @note samples are dropped when time went back (new recording) or when too many samples wait
+ */
+std::uint64_t append(std::vector<Timestamp> & work, const std::vector<Timestamp> & block)
+{
+    std::uint64_t dropped = 0;
+    if (block.empty())
+    {
+        return dropped;
+    }
+    if (!work.empty() && block.front().Get_time() < work.back().Get_time())
+    {
+        dropped += work.size();
+        work.clear();
+    }
+    work.insert(work.end(), block.begin(), block.end());
+    if (work.size() > max_waiting_samples)
+    {
+        const std::size_t excess = work.size() - max_waiting_samples;
+        work.erase(work.begin(), work.begin() + excess);
+        dropped += excess;
+    }
+    return dropped;
+}
+}
+
+/**
+ * @brief XYAccumulator constructor
+ * @param settings parameters of accumulation
+ */
+XYAccumulator::XYAccumulator(const XYSettings & settings)
+    : _settings(settings), _grid(settings._columns, settings._rows), _last_decay(clock::now())
+{
+    //Empty
+}
+
+/**
+ * @brief Push_x
+ * @param timestamps new timestamps of channel X in time order, ignored when stopped
+ */
+void XYAccumulator::Push_x(std::span<const Timestamp> timestamps)
+{
+    if (timestamps.empty() || _stop_flag)
+    {
+        //stopped accumulator does not collect input
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_input_mutex);
+        _x_input.insert(_x_input.end(), timestamps.begin(), timestamps.end());
+    }
+    _input_cv.notify_one();
+}
+
+/**
+ * @brief Push_y
+ * @param timestamps new timestamps of channel Y in time order, ignored when stopped
+ */
+void XYAccumulator::Push_y(std::span<const Timestamp> timestamps)
+{
+    if (timestamps.empty() || _stop_flag)
+    {
+        //stopped accumulator does not collect input
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_input_mutex);
+        _y_input.insert(_y_input.end(), timestamps.begin(), timestamps.end());
+    }
+    _input_cv.notify_one();
+}
+
+/**
+ * @brief Set_settings
+ * @param settings new parameters, histogram is cleared if its geometry changed
+ */
+void XYAccumulator::Set_settings(const XYSettings & settings)
+{
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    const bool geometry_changed = settings._columns != _settings._columns || settings._rows != _settings._rows
+        || settings._min_x != _settings._min_x || settings._max_x != _settings._max_x
+        || settings._min_y != _settings._min_y || settings._max_y != _settings._max_y;
+    _settings = settings;
+    if (geometry_changed)
+    {
+        _grid.Resize(_settings._columns, _settings._rows);
+    }
+}
+
+/**
+ * @brief Get_settings
+ * @return current parameters
+ */
+XYSettings XYAccumulator::Get_settings() const
+{
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    return _settings;
+}
+
+/**
+ * @brief Copy_intensity
+ * @param out row-major intensities from 0.0 to 1.0 (log scaled hits), first row is max Y
+ * @return true if histogram changed since last copy
+ */
+bool XYAccumulator::Copy_intensity(std::vector<float> & out)
+{
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    if (!_stop_flag)
+    {
+        decay(clock::now());
+    }
+    return _grid.Copy_intensity(out);
+}
+
+/**
+ * @brief Get_paired_points
+ * @return number of X/Y pairs accumulated since creation
+ */
+std::uint64_t XYAccumulator::Get_paired_points() const
+{
+    return _paired_points;
+}
+
+/**
+ * @brief Get_dropped_points
+ * @return number of samples dropped because other channel did not cover their time
+ */
+std::uint64_t XYAccumulator::Get_dropped_points() const
+{
+    return _dropped_points;
+}
+
+/**
+ * @brief Clear
+ * @note clears histogram and not processed input
+ */
+void XYAccumulator::Clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(_input_mutex);
+        _x_input.clear();
+        _y_input.clear();
+    }
+    _reset_work = true;
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    _grid.Clear();
+}
+
+/**
+ * @brief decay
+ * @param now current time
+ * @note multiplies histogram by factor of time elapsed since last decay, needs _grid_mutex
+ */
+void XYAccumulator::decay(clock::time_point now)
+{
+    const double elapsed = std::chrono::duration<double>(now - _last_decay).count();
+    _last_decay = now;
+    _grid.Decay(elapsed, _settings._half_life);
+}
+
+/**
+ * @brief align
+ * @note pairs samples of X with Y interpolated at their time into _x_values and _y_values,
+ * paired samples are removed from work buffers
+ */
+void XYAccumulator::align()
+{
+    _x_values.clear();
+    _y_values.clear();
+    if (_y_work.empty())
+    {
+        return;
+    }
+    std::size_t x = 0;
+    std::size_t y = 0;
+    //samples of X recorded before first sample of Y have no pair
+    while (x < _x_work.size() && _x_work[x].Get_time() < _y_work.front().Get_time())
+    {
+        x++;
+    }
+    _dropped_points += x;
+    for (; x < _x_work.size(); x++)
+    {
+        const double time = _x_work[x].Get_time();
+        while (y + 1 < _y_work.size() && _y_work[y + 1].Get_time() < time)
+        {
+            y++;
+        }
+        if (y + 1 >= _y_work.size())
+        {
+            //Y after this sample was not pushed yet
+            break;
+        }
+        const Timestamp & before = _y_work[y];
+        const Timestamp & after = _y_work[y + 1];
+        const double span = after.Get_time() - before.Get_time();
+        const double weight = (span > 0.0) ? (time - before.Get_time()) / span : 0.0;
+        _x_values.push_back(_x_work[x].Get_voltage());
+        _y_values.push_back(before.Get_voltage() + (after.Get_voltage() - before.Get_voltage()) * weight);
+    }
+    _x_work.erase(_x_work.begin(), _x_work.begin() + x);
+    _y_work.erase(_y_work.begin(), _y_work.begin() + y);
+}
+
+/**
+ * @brief accumulate
+ * @param settings parameters copied at begin of pass
+ * @note bins aligned pairs into histogram
+ */
+void XYAccumulator::accumulate(const XYSettings & settings)
+{
+    TraceScope trace("XYAccumulator::accumulate");
+    align();
+    const std::size_t count = _x_values.size();
+    if (count == 0)
+    {
+        return;
+    }
+    _bins.resize(count);
+    const double * xs = _x_values.data();
+    const double * ys = _y_values.data();
+    std::int32_t * bins = _bins.data();
+    const std::int32_t columns = settings._columns;
+    const std::int32_t rows = settings._rows;
+    const double column_scale = columns / (settings._max_x - settings._min_x);
+    const double row_scale = rows / (settings._max_y - settings._min_y);
+    const double min_x = settings._min_x;
+    const double max_y = settings._max_y;
+    //compiler vectorises this loop, pairs out of range get bin -1
+    for (std::size_t i = 0; i < count; i++)
+    {
+        bins[i] = DensityGrid::Bin_of((xs[i] - min_x) * column_scale, (max_y - ys[i]) * row_scale, columns, rows);
+    }
+    std::lock_guard<std::mutex> lock(_grid_mutex);
+    if (_grid.Get_columns() != columns || _grid.Get_rows() != rows)
+    {
+        //geometry changed during pass
+        return;
+    }
+    _grid.Add_hits(_bins);
+    _paired_points += count;
+}
+
+/**
+ * @brief running_loop
+ * @note loop in which input is accumulated
+ */
+void XYAccumulator::running_loop(void)
+{
+    if (!_running)
+    {
+        const std::chrono::duration sleep_time_stopped = std::chrono::milliseconds(100);
+        const std::chrono::duration input_wait = std::chrono::milliseconds(10);
+        PipelineMetrics::Instance().Set_thread_name("XYAccumulator");
+        _running = true;
+        _destroyed = false;
+        while (!_destroy_flag)
+        {
+            if (_stop_flag)
+            {
+                std::this_thread::sleep_for(sleep_time_stopped);
+                continue;
+            }
+            {
+                std::unique_lock<std::mutex> lock(_input_mutex);
+                _input_cv.wait_for(lock, input_wait, [this] { return !_x_input.empty() || !_y_input.empty() || _destroy_flag; });
+                _x_block.clear();
+                _y_block.clear();
+                _x_input.swap(_x_block);
+                _y_input.swap(_y_block);
+            }
+            if (_reset_work.exchange(false))
+            {
+                _x_work.clear();
+                _y_work.clear();
+            }
+            if (_x_block.empty() && _y_block.empty())
+            {
+                continue;
+            }
+            _dropped_points += append(_x_work, _x_block);
+            _dropped_points += append(_y_work, _y_block);
+            XYSettings settings;
+            {
+                std::lock_guard<std::mutex> lock(_grid_mutex);
+                decay(clock::now());
+                settings = _settings;
+            }
+            accumulate(settings);
+        }
+        _running = false;
+        _destroyed = true;
+    }
+}
+
+/**
+ * @brief Start
+ * @note starts execution of accumulator thread
+ */
+void XYAccumulator::Start()
+{
+    _destroy_flag = false;
+    _thread = std::thread(&XYAccumulator::running_loop, this);
+}
+
+/**
+ * @brief Stop
+ * @note stops accumulation and decay, histogram is kept
+ */
+void XYAccumulator::Stop()
+{
+    _stop_flag = true;
+}
+
+/**
+ * @brief Resume
+ * @note resumes execution after Stop() was called
+ */
+void XYAccumulator::Resume()
+{
+    {
+        //time of stop does not count to decay
+        std::lock_guard<std::mutex> lock(_grid_mutex);
+        _last_decay = clock::now();
+    }
+    _stop_flag = false;
+}
+
+/**
+ * @brief Destroy
+ * @note destroys thread, after this new thread with Start() can be created
+ */
+void XYAccumulator::Destroy()
+{
+    _destroy_flag = true;
+    _input_cv.notify_one();
+    if (_thread.joinable())
+        _thread.join();
+}
+
+XYAccumulator::~XYAccumulator()
+{
+    Destroy();
+}
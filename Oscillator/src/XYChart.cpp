@@ -0,0 +1,213 @@
+#include "XYChart.h"
+#include "PipelineMetrics.h"
+
+/**
+ * @brief constructor with parameters
+ * @param data is data of channel X that will be passed as charts default data
+ * @param width is the width of the drawing area
+ * @param height is the height of the drawing area
+ * @param origin is the position of left bottom corner of a chart.
+ * @param min_value is min value of both axes.
+ * @param max_value is max value of both axes.
+ * @param settings parameters of accumulation, ranges are taken from min_value and max_value.
+ */
+XYChart::XYChart(std::span<const Timestamp> data, float width, float height, sf::Vector2f origin, float min_value, float max_value, const XYSettings & settings) :
+m_accumulator{settings}, m_data_min{min_value}, m_data_max{max_value}, m_zoom{1.f}
+{
+    m_width = width;
+    m_height = height;
+    m_origin = origin;
+    m_padding = 10.f;
+    m_should_scroll = true;
+    Set_color(sf::Color(255, 0, 0));
+    Set_zoom(1.f);
+    m_accumulator.Start();
+    Add_data(data);
+}
+/**
+ * @brief passes data of channel X to accumulator.
+ * @param new_timestamps new data that will be added to current data.
+ */
+void XYChart::Add_data(std::span<const Timestamp> new_timestamps)
+{
+    m_accumulator.Push_x(new_timestamps);
+}
+/**
+ * @brief passes data of channel Y to accumulator.
+ * @param new_timestamps new data that will be added to current data.
+ */
+void XYChart::Add_y_data(std::span<const Timestamp> new_timestamps)
+{
+    m_accumulator.Push_y(new_timestamps);
+}
+/**
+ * @brief draws point density of X/Y pairs as a texture.
+ * @param target is an object for drawing. Probably window.
+ */
+void XYChart::Draw(sf::RenderTarget& target)
+{
+    ScopedStageTimer timer(PipelineStage::RENDER);
+    const XYSettings settings = m_accumulator.Get_settings();
+    {
+        TraceScope trace("XYChart::Update_texture");
+        const bool changed = m_accumulator.Copy_intensity(m_intensity);
+        m_texture.Update(m_intensity, settings._columns, settings._rows, changed);
+    }
+    PipelineMetrics::Instance().Set_gauge(PipelineGauge::VERTEX_COUNT, 4);
+    const float window_height = target.getSize().y;
+    const sf::Vector2f top_left(m_origin.x + m_padding, window_height - m_origin.y - m_height);
+    sf::RectangleShape frame({m_width, m_height});
+    frame.setPosition(top_left);
+    frame.setFillColor(m_texture.Get_background());
+    frame.setOutlineColor(sf::Color(0, 0, 100));
+    frame.setOutlineThickness(1.f);
+    target.draw(frame);
+    m_texture.Draw(target, top_left, {m_width, m_height});
+    //axes of both channels at zero volts
+    const float zero_x = top_left.x + m_width * static_cast<float>(-settings._min_x / (settings._max_x - settings._min_x));
+    const float zero_y = top_left.y + m_height * static_cast<float>(settings._max_y / (settings._max_y - settings._min_y));
+    constexpr sf::Color axis_color = sf::Color(0, 0, 255);
+    sf::VertexArray axes(sf::PrimitiveType::Lines, 4);
+    axes[0] = sf::Vertex{{zero_x, top_left.y}, axis_color};
+    axes[1] = sf::Vertex{{zero_x, top_left.y + m_height}, axis_color};
+    axes[2] = sf::Vertex{{top_left.x, zero_y}, axis_color};
+    axes[3] = sf::Vertex{{top_left.x + m_width, zero_y}, axis_color};
+    target.draw(axes);
+}
+/**
+ * @brief clears accumulated pairs and sets given data of channel X.
+ */
+void XYChart::Set_data(std::vector<Timestamp> data)
+{
+    m_accumulator.Clear();
+    Add_data(data);
+}
+bool XYChart::Is_cursor_on_chart(sf::RenderTarget& target) const
+{
+    float window_height = target.getSize().y;
+    if( m_cursor_position.x < m_origin.x || m_cursor_position.x > (m_origin.x+m_width)){
+        return false;
+    }
+    if( m_cursor_position.y < (window_height - m_origin.y - m_height) || m_cursor_position.y > (window_height - m_origin.y)){
+        return false;
+    }
+    return true;
+}
+/**
+ * @brief clears accumulated pairs.
+ */
+void XYChart::Reset_data()
+{
+    m_accumulator.Clear();
+}
+/**
+ * @brief XY view shows only live data, archive is not used.
+ */
+void XYChart::Set_archive(std::shared_ptr<const HistoryArchive>)
+{
+    //Empty
+}
+[[nodiscard]] sf::Vector2i XYChart::Get_cursor() const
+{
+    return m_cursor_position;
+}
+[[nodiscard]] float XYChart::Get_width() const
+{
+    return m_width;
+}
+[[nodiscard]] float XYChart::Get_height() const
+{
+    return m_height;
+}
+[[nodiscard]] float XYChart::Get_zoom() const
+{
+    return m_zoom;
+}
+[[nodiscard]] float XYChart::Get_scrolling() const
+{
+    return m_should_scroll;
+}
+[[nodiscard]] float XYChart::Get_panning() const
+{
+    return m_should_pan;
+}
+/**
+ * @brief XY chart has no time axis, returns 0.
+ */
+[[nodiscard]] float XYChart::Get_time_span() const
+{
+    return 0.f;
+}
+[[nodiscard]] std::uint64_t XYChart::Get_paired_points() const
+{
+    return m_accumulator.Get_paired_points();
+}
+void XYChart::Set_cursor(sf::Vector2i position)
+{
+    m_cursor_position = position;
+}
+void XYChart::Set_width(float new_width)
+{
+    m_width = new_width;
+}
+void XYChart::Set_height(float new_height)
+{
+    m_height = new_height;
+}
+/**
+ * @brief sets zoom, voltage range of both channels is base range divided by zoom.
+ * @param new_zoom zoom from 1.0 to 16.0
+ */
+void XYChart::Set_zoom(float new_zoom)
+{
+    constexpr float min_zoom = 1.f;
+    constexpr float max_zoom = 16.f;
+    if (new_zoom < min_zoom || new_zoom > max_zoom) return;
+    m_zoom = new_zoom;
+    const double center = (m_data_max + m_data_min) / 2.0;
+    const double half_range = (m_data_max - m_data_min) / 2.0 / m_zoom;
+    XYSettings settings = m_accumulator.Get_settings();
+    settings._min_x = center - half_range;
+    settings._max_x = center + half_range;
+    settings._min_y = center - half_range;
+    settings._max_y = center + half_range;
+    m_accumulator.Set_settings(settings);
+}
+void XYChart::Set_origin(sf::Vector2f new_origin)
+{
+    m_origin = new_origin;
+}
+/**
+ * @brief stops accumulation (histogram stays as it is) or resumes it.
+ * @param should_scroll false freezes histogram.
+ */
+void XYChart::Set_scrolling(bool should_scroll)
+{
+    if (should_scroll == m_should_scroll) return;
+    m_should_scroll = should_scroll;
+    if (m_should_scroll) {
+        m_accumulator.Resume();
+    } else {
+        m_accumulator.Stop();
+    }
+}
+void XYChart::Set_panning(bool should_pan)
+{
+    m_should_pan = should_pan;
+}
+/**
+ * @brief Sets color of the most hit bins, palette goes from background through it to white.
+ * @param new_color a color to which chart will be set.
+ */
+void XYChart::Set_color(sf::Color new_color)
+{
+    m_color_of_chart = new_color;
+    m_texture.Set_color(new_color);
+}
+/**
+ * @brief XY chart has no time axis, pan is ignored.
+ */
+void XYChart::Set_pan(float)
+{
+    //Empty
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "BlockCompression.h"
+
+namespace
+{
+
+/**
+ * @brief expect_round_trip
+ * @param data timestamps compressed and decompressed again
+ * @note compares bit patterns, so NaN payloads and sign of zero have to survive too
+ */
+void expect_round_trip(const std::vector<Timestamp> & data)
+{
+    const CompressedBlock block(data);
+    ASSERT_EQ(block.Size(), data.size());
+    RecordingVector::type out;
+    block.Decompress(out);
+    ASSERT_EQ(out.size(), data.size());
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        EXPECT_EQ(std::bit_cast<std::uint64_t>(out[i].Get_time()), std::bit_cast<std::uint64_t>(data[i].Get_time())) << "time of sample " << i;
+        EXPECT_EQ(std::bit_cast<std::uint64_t>(out[i].Get_voltage()), std::bit_cast<std::uint64_t>(data[i].Get_voltage())) << "voltage of sample " << i;
+    }
+}
+
+}
+
+TEST(BlockCompressionTest, EmptyAndSingleSample)
+{
+    expect_round_trip({});
+    expect_round_trip({Timestamp(1.5, -2.25)});
+}
+
+TEST(BlockCompressionTest, ConstantSamplingAndEqualNeighbours)
+{
+    std::vector<Timestamp> data;
+    for (int i = 0; i < 1000; i++)
+    {
+        data.emplace_back(i * 0.001, (i / 100) * 0.5);
+    }
+    expect_round_trip(data);
+
+    //equal neighbours in both time and voltage, zero delta
+    expect_round_trip(std::vector<Timestamp>(100, Timestamp(3.0, 1.0)));
+}
+
+TEST(BlockCompressionTest, SpecialValues)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    const double denormal = std::numeric_limits<double>::denorm_min();
+    expect_round_trip({
+        Timestamp(0.0, nan), Timestamp(0.001, nan), Timestamp(0.002, -nan), Timestamp(0.003, 0.0),
+        Timestamp(0.004, -0.0), Timestamp(0.005, inf), Timestamp(0.006, -inf), Timestamp(0.007, denormal),
+        Timestamp(nan, 1.0), Timestamp(-0.0, std::numeric_limits<double>::max()), Timestamp(inf, 1.0),
+        Timestamp(0.008, std::numeric_limits<double>::lowest())});
+}
+
+TEST(BlockCompressionTest, LargeTimeDeltas)
+{
+    const double max = std::numeric_limits<double>::max();
+    //delta and delta of delta of bit patterns take whole 64 bits and wrap around
+    expect_round_trip({
+        Timestamp(-max, 1.0), Timestamp(max, 2.0), Timestamp(-max, 3.0), Timestamp(0.0, 4.0),
+        Timestamp(1e300, 5.0), Timestamp(-1e-300, 6.0), Timestamp(1e-300, 7.0), Timestamp(max, 8.0)});
+}
+
+TEST(BlockCompressionTest, RandomData)
+{
+    std::mt19937_64 random(1234);
+    std::vector<Timestamp> data;
+    double time = 0.0;
+    for (int i = 0; i < 5000; i++)
+    {
+        //mostly regular sampling with jitter and occasional jumps of time, also backwards
+        time += (i % 97 == 0) ? std::bit_cast<double>(random()) : 0.001 + (random() % 16) * 1e-9;
+        data.emplace_back(time, std::bit_cast<double>(random() >> (random() % 64)));
+    }
+    expect_round_trip(data);
+}
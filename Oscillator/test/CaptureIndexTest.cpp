@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "CaptureIndex.h"
+
+namespace
+{
+
+/**
+ * @class CaptureFile
+ * Capture written to temporary directory, removed at end of test
+ */
+class CaptureFile
+{
+public:
+    explicit CaptureFile(const std::string & name)
+        : _path(std::filesystem::temp_directory_path() / (name + "_" + std::to_string(::getpid()) + ".txt"))
+    {
+        //two concatenated generator files, second starts from zero again, with lines which are skipped
+        std::ofstream file(_path, std::ios::binary);
+        for (int i = 0; i < 3500; i++)
+        {
+            file << i * 0.001 << ' ' << (i % 50) * 0.1 << '\n';
+            if (i == 1200)
+            {
+                file << "garbage line\n\n   \r\n";
+            }
+        }
+        for (int i = 0; i < 2200; i++)
+        {
+            file << i * 0.001 << '\t' << -i * 0.01 << "\r\n";
+        }
+        //last line without line break
+        file << "2.2 1.0";
+    }
+
+    ~CaptureFile()
+    {
+        std::error_code ec;
+        std::filesystem::remove(_path, ec);
+    }
+
+    [[nodiscard]] const std::filesystem::path & Get_path() const
+    {
+        return _path;
+    }
+private:
+    std::filesystem::path _path;
+};
+
+/**
+ * @brief expect_same
+ * @note entries of both indices and their text have to be equal
+ */
+void expect_same(CaptureIndex & expected, CaptureIndex & actual, const std::vector<CaptureEntry> & entries)
+{
+    for (std::size_t i = 0; i < entries.size(); i++)
+    {
+        CaptureEntry entry {};
+        ASSERT_TRUE(actual.Get_entry(i, entry)) << "entry " << i;
+        EXPECT_EQ(std::memcmp(&entry, &entries[i], sizeof(CaptureEntry)), 0) << "entry " << i;
+        EXPECT_EQ(actual.Get_text(entry), expected.Get_text(entries[i])) << "entry " << i;
+    }
+    CaptureEntry entry {};
+    EXPECT_FALSE(actual.Get_entry(entries.size(), entry));
+}
+
+}
+
+TEST(CaptureIndexTest, LazyLookupsMatchFullScanAndFooter)
+{
+    const CaptureFile capture("CaptureIndexTest");
+    std::vector<CaptureEntry> entries;
+    {
+        CaptureIndex full(capture.Get_path());
+        while (full.Index_more(2) > 0)
+        {
+        }
+        ASSERT_TRUE(full.Is_complete());
+        ASSERT_FALSE(full.Has_footer());
+        for (std::size_t i = 0; i < full.Get_entry_count(); i++)
+        {
+            CaptureEntry entry {};
+            ASSERT_TRUE(full.Get_entry(i, entry));
+            entries.push_back(entry);
+        }
+    }
+    //4 intervals of first file, 3 of second one, which is shifted after first
+    ASSERT_EQ(entries.size(), 7u);
+    EXPECT_DOUBLE_EQ(entries[4]._time_offset, entries[3]._max_time);
+    std::uint64_t points = 0;
+    for (const CaptureEntry & entry : entries)
+    {
+        points += entry._points;
+    }
+    EXPECT_EQ(points, 3500u + 2200u + 1u);
+
+    CaptureIndex reference(capture.Get_path());
+    {
+        //lookups in random order scan only as far as needed
+        CaptureIndex lazy(capture.Get_path());
+        CaptureEntry entry {};
+        ASSERT_TRUE(lazy.Get_entry(2, entry));
+        EXPECT_EQ(lazy.Get_entry_count(), 3u);
+        EXPECT_FALSE(lazy.Is_complete());
+        ASSERT_TRUE(lazy.Get_entry(0, entry));
+        expect_same(reference, lazy, entries);
+        EXPECT_TRUE(lazy.Is_complete());
+        EXPECT_TRUE(lazy.Write_footer());
+    }
+
+    CaptureIndex with_footer(capture.Get_path());
+    EXPECT_TRUE(with_footer.Has_footer());
+    EXPECT_TRUE(with_footer.Is_complete());
+    EXPECT_EQ(with_footer.Get_entry_count(), entries.size());
+    expect_same(reference, with_footer, entries);
+    //footer is written only once
+    EXPECT_FALSE(with_footer.Write_footer());
+}
+
+TEST(CaptureIndexTest, DamagedFooterIsIgnored)
+{
+    const CaptureFile capture("CaptureIndexDamagedTest");
+    {
+        CaptureIndex index(capture.Get_path());
+        index.Index_more(100);
+        ASSERT_TRUE(index.Write_footer());
+    }
+    //one byte of footer is missing
+    std::filesystem::resize_file(capture.Get_path(), std::filesystem::file_size(capture.Get_path()) - 1);
+    CaptureIndex index(capture.Get_path());
+    EXPECT_FALSE(index.Has_footer());
+    EXPECT_FALSE(index.Is_complete());
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <string>
+#include <vector>
+
+#include "FilterChain.h"
+
+namespace
+{
+
+constexpr double sample_rate = 1000.0;
+constexpr int sample_count = 3000;
+
+/**
+ * @brief make_signal
+ * @return two sines with noise like component, uniformly sampled
+ */
+std::vector<Timestamp> make_signal()
+{
+    std::vector<Timestamp> data;
+    for (int i = 0; i < sample_count; i++)
+    {
+        const double time = i / sample_rate;
+        const double voltage = std::sin(2.0 * std::numbers::pi * 7.0 * time) + 0.3 * std::sin(2.0 * std::numbers::pi * 180.0 * time)
+            + 0.01 * ((i * 7919) % 101 - 50);
+        data.emplace_back(time, voltage);
+    }
+    return data;
+}
+
+/**
+ * @brief run
+ * @param spec filter chain passed to FilterChain::Parse
+ * @param data input signal
+ * @param block_sizes sizes of consecutive blocks, repeated until whole signal is processed
+ * @return concatenated output of all blocks
+ */
+std::vector<Timestamp> run(const std::string & spec, const std::vector<Timestamp> & data, const std::vector<std::size_t> & block_sizes)
+{
+    std::unique_ptr<FilterChain> chain = FilterChain::Parse(spec, sample_rate);
+    std::vector<Timestamp> out;
+    std::size_t begin = 0;
+    for (std::size_t b = 0; begin < data.size(); b++)
+    {
+        const std::size_t end = std::min(begin + block_sizes[b % block_sizes.size()], data.size());
+        RecordingVector vec;
+        vec.Get_container().assign(data.begin() + begin, data.begin() + end);
+        const RecordingVector filtered = chain->Process(vec);
+        out.insert(out.end(), filtered.Get_container().begin(), filtered.Get_container().end());
+        begin = end;
+    }
+    return out;
+}
+
+}
+
+TEST(FilterChainTest, OutputDoesNotDependOnBlockSplit)
+{
+    const std::vector<Timestamp> data = make_signal();
+    const std::vector<std::vector<std::size_t>> splits = {{1}, {7}, {64, 1, 333}, {999, 2}, {1000}};
+    for (const std::string spec : {"fir:50:31", "firband:20:200:63", "lowpass:50", "highpass:100", "bandpass:20:200",
+        "average:16", "decimate:4", "cic:8", "fir:100:15,cic:4,lowpass:20", "decimate:3,cic:5,average:3"})
+    {
+        const std::vector<Timestamp> whole = run(spec, data, {data.size()});
+        ASSERT_FALSE(whole.empty()) << spec;
+        for (const std::vector<std::size_t> & split : splits)
+        {
+            const std::vector<Timestamp> pieces = run(spec, data, split);
+            ASSERT_EQ(pieces.size(), whole.size()) << spec << ", first block " << split.front();
+            for (std::size_t i = 0; i < whole.size(); i++)
+            {
+                EXPECT_EQ(pieces[i].Get_time(), whole[i].Get_time()) << spec << ", sample " << i;
+                //FIR sums terms in the same order and CIC is exact, only biquad and average round differently
+                EXPECT_NEAR(pieces[i].Get_voltage(), whole[i].Get_voltage(), 1e-9) << spec << ", sample " << i;
+            }
+        }
+    }
+}
+
+TEST(FilterChainTest, CicDecimationIsLimited)
+{
+    const std::string largest = "cic:" + std::to_string(CicDecimator::Max_decimation());
+    EXPECT_NO_THROW((void)FilterChain::Parse(largest, sample_rate));
+    const std::string too_large = "cic:" + std::to_string(CicDecimator::Max_decimation() + 1);
+    EXPECT_THROW((void)FilterChain::Parse(too_large, sample_rate), std::runtime_error);
+    EXPECT_THROW((void)CicDecimator(CicDecimator::Max_decimation(6) + 1, 6), std::runtime_error);
+}
+
+TEST(FilterChainTest, CicGainIsUnity)
+{
+    //constant input, after settling every output equals input, also when saturated
+    for (const double voltage : {1.5, -3.25, CicDecimator::Max_voltage, -2.0 * CicDecimator::Max_voltage})
+    {
+        std::vector<Timestamp> data;
+        for (int i = 0; i < 4 * CicDecimator::Max_decimation(); i++)
+        {
+            data.emplace_back(i, voltage);
+        }
+        const std::vector<Timestamp> out = run("cic:" + std::to_string(CicDecimator::Max_decimation()), data, {data.size()});
+        ASSERT_FALSE(out.empty());
+        EXPECT_DOUBLE_EQ(out.back().Get_voltage(), std::clamp(voltage, -CicDecimator::Max_voltage, CicDecimator::Max_voltage));
+    }
+}
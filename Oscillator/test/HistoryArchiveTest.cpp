@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "HistoryArchive.h"
+
+namespace
+{
+
+constexpr int interval_points = 100;
+constexpr std::uint64_t interval_bytes = interval_points * 2 * sizeof(double);
+
+/**
+ * @brief make_interval
+ * @param second start time of interval, interval covers one second
+ * @return interval whose voltage equals its start time
+ */
+RecordingVector make_interval(int second)
+{
+    RecordingVector vec;
+    RecordingVector::type & data = vec.Get_container();
+    for (int i = 0; i < interval_points; i++)
+    {
+        data.emplace_back(second + static_cast<double>(i) / interval_points, second);
+    }
+    vec.Set_recording_params(RangeParams({static_cast<double>(second), static_cast<double>(second)}, {data.front().Get_time(), data.back().Get_time()}, interval_points));
+    return vec;
+}
+
+/**
+ * @brief archive_name
+ * @param name name of test
+ * @return path of archive file in temporary directory
+ */
+std::string archive_name(const std::string & name)
+{
+    return (std::filesystem::temp_directory_path() / (name + "_" + std::to_string(::getpid()) + ".bin")).string();
+}
+
+}
+
+TEST(HistoryArchiveTest, OldestIntervalsAreEvictedAtSizeLimit)
+{
+    const std::string fname = archive_name("HistoryArchiveTest");
+    //room for 10 and half intervals, so ring wraps before its end
+    HistoryArchive archive(fname, 4, 10 * interval_bytes + interval_bytes / 2);
+    for (int second = 0; second < 100; second++)
+    {
+        ASSERT_TRUE(archive.Append(make_interval(second)));
+        EXPECT_LE(std::filesystem::file_size(fname), 10 * interval_bytes + interval_bytes / 2);
+    }
+    //ring holds 10 intervals, the one being written replaces oldest one
+    EXPECT_EQ(archive.Get_interval_count(), 10);
+    const RangeParams params = archive.Get_recording_params();
+    EXPECT_DOUBLE_EQ(params.Get_min_time(), 90.0);
+    EXPECT_DOUBLE_EQ(params.Get_min_voltage(), 90.0);
+    EXPECT_DOUBLE_EQ(params.Get_max_voltage(), 99.0);
+    EXPECT_EQ(params.Get_max_index(), 10 * interval_points);
+
+    //whole intervals are read back from ring
+    const std::vector<Timestamp> data = archive.Load_range(0.0, 200.0, 100000);
+    ASSERT_EQ(data.size(), 10u * interval_points);
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        const int second = 90 + static_cast<int>(i / interval_points);
+        EXPECT_DOUBLE_EQ(data[i].Get_voltage(), second) << "sample " << i;
+    }
+    //decimated range uses only kept intervals
+    const std::vector<Timestamp> decimated = archive.Load_range(0.0, 200.0, 100);
+    ASSERT_FALSE(decimated.empty());
+    EXPECT_DOUBLE_EQ(decimated.front().Get_voltage(), 90.0);
+
+    archive.Clear();
+    EXPECT_TRUE(archive.Empty());
+    EXPECT_TRUE(archive.Load_range(0.0, 200.0, 100000).empty());
+}
+
+TEST(HistoryArchiveTest, LoadRangeWhileAppending)
+{
+    HistoryArchive archive(archive_name("HistoryArchiveLoadTest"), 2, 20 * interval_bytes);
+    std::atomic_bool done {false};
+    std::thread writer([&] {
+        for (int second = 0; second < 2000; second++)
+        {
+            archive.Append(make_interval(second));
+        }
+        done = true;
+    });
+    while (!done)
+    {
+        const RangeParams params = archive.Get_recording_params();
+        //every returned sample comes from interval which wasn't overwritten meanwhile
+        for (const Timestamp & point : archive.Load_range(params.Get_min_time(), params.Get_max_time() + 1.0, 100000))
+        {
+            EXPECT_DOUBLE_EQ(point.Get_voltage(), static_cast<int>(point.Get_time()));
+        }
+    }
+    writer.join();
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "MathChannel.h"
+
+namespace
+{
+
+constexpr int history_seconds = 8;
+constexpr int interval_points = 1000;
+
+/**
+ * @brief fill
+ * @param history history to which intervals of one second are pushed
+ * @param frequency frequency of sine recorded in history
+ * @param compressed if true, intervals older than two newest are stored compressed
+ */
+void fill(RecordingHistory & history, double frequency, bool compressed)
+{
+    history.Set_history_time_limit(history_seconds);
+    history.Set_compression(compressed);
+    for (int s = 0; s < history_seconds; s++)
+    {
+        RecordingVector vec;
+        RecordingVector::type & data = vec.Get_container();
+        for (int i = 0; i < interval_points; i++)
+        {
+            const double time = s + static_cast<double>(i) / interval_points;
+            data.emplace_back(time, std::sin(2.0 * 3.14159265358979 * frequency * time));
+        }
+        vec.Set_recording_params(RangeParams({-1.0, 1.0}, {data.front().Get_time(), data.back().Get_time()}, interval_points));
+        history.Push_recordingVector(std::move(vec));
+    }
+}
+
+/**
+ * @brief evaluate
+ * @return result of operation over whole history of both channels
+ */
+std::vector<Timestamp> evaluate(MathOperation operation, bool compressed)
+{
+    RecordingHistory a;
+    RecordingHistory b;
+    fill(a, 5.0, compressed);
+    fill(b, 3.0, compressed);
+    MathChannel channel(operation, a, &b);
+    std::vector<Timestamp> out;
+    channel.Evaluate(0.0, history_seconds, out);
+    return out;
+}
+
+}
+
+TEST(MathChannelTest, CompressedHistoriesGiveSameResult)
+{
+    for (MathOperation operation : {MathOperation::ADD, MathOperation::SUBTRACT, MathOperation::MULTIPLY,
+        MathOperation::DERIVATIVE, MathOperation::INTEGRAL})
+    {
+        const std::vector<Timestamp> plain = evaluate(operation, false);
+        const std::vector<Timestamp> compressed = evaluate(operation, true);
+        ASSERT_FALSE(plain.empty()) << MathChannel::Get_name(operation);
+        ASSERT_EQ(plain.size(), compressed.size()) << MathChannel::Get_name(operation);
+        for (std::size_t i = 0; i < plain.size(); i++)
+        {
+            ASSERT_EQ(plain[i].Get_time(), compressed[i].Get_time()) << MathChannel::Get_name(operation);
+            ASSERT_EQ(plain[i].Get_voltage(), compressed[i].Get_voltage()) << MathChannel::Get_name(operation);
+        }
+    }
+}
+
+TEST(MathChannelTest, InvalidateRestartsIntegral)
+{
+    RecordingHistory a;
+    fill(a, 5.0, true);
+    MathChannel channel(MathOperation::INTEGRAL, a);
+    std::vector<Timestamp> first;
+    channel.Evaluate(0.0, history_seconds, first);
+
+    //history replaced by the same data, as chart does on Set_data()
+    a.Clear();
+    channel.Invalidate();
+    fill(a, 5.0, true);
+    std::vector<Timestamp> second;
+    channel.Evaluate(0.0, history_seconds, second);
+    ASSERT_EQ(first.size(), second.size());
+    EXPECT_EQ(first.back().Get_voltage(), second.back().Get_voltage());
+}
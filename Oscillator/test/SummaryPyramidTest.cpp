@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "SummaryPyramid.h"
+
+namespace
+{
+
+constexpr int block_points = 1000;
+
+/**
+ * @brief make_block
+ * @param second start time of block, block covers one second
+ * @return block of sine samples
+ */
+BlockHandle make_block(int second)
+{
+    RecordingVector vec;
+    RecordingVector::type & data = vec.Get_container();
+    for (int i = 0; i < block_points; i++)
+    {
+        const double time = second + static_cast<double>(i) / block_points;
+        data.emplace_back(time, std::sin(2.0 * 3.14159265358979 * 3.0 * time));
+    }
+    vec.Set_recording_params(RangeParams({-1.0, 1.0}, {data.front().Get_time(), data.back().Get_time()}, block_points));
+    return std::make_shared<const RecordingVector>(std::move(vec));
+}
+
+}
+
+TEST(SummaryPyramidTest, OldBlocksAreEvicted)
+{
+    SummaryPyramid summary;
+    summary.Set_history_time_limit(10);
+    for (int second = 0; second < 100; second++)
+    {
+        summary.Add_block(make_block(second));
+    }
+    EXPECT_EQ(summary.Get_progress()._blocks, 100u);
+    EXPECT_DOUBLE_EQ(summary.Get_progress().Get_fraction(), 1.0);
+    //block 89 ends less than 10 s before newest point
+    EXPECT_DOUBLE_EQ(summary.Get_min_time(), 89.0);
+
+    std::vector<Timestamp> out;
+    ASSERT_TRUE(summary.Query(summary.Get_min_time(), 100.0, 10, out));
+    ASSERT_FALSE(out.empty());
+    EXPECT_GE(out.front().Get_time(), summary.Get_min_time());
+    //evicted range has no summaries
+    EXPECT_TRUE(summary.Query(0.0, 50.0, 10, out));
+    EXPECT_TRUE(out.empty());
+}
+
+TEST(SummaryPyramidTest, EvictedBlocksFinishInPool)
+{
+    auto pool = std::make_shared<TaskPool>(1);
+    SummaryPyramid summary(pool);
+    summary.Set_history_time_limit(2);
+    for (int second = 0; second < 20; second++)
+    {
+        summary.Add_block(make_block(second));
+    }
+    //summaries are built also for blocks evicted before their task ran
+    while (summary.Get_progress().Get_fraction() < 1.0)
+    {
+        pool->Run_pending_task();
+    }
+    std::vector<Timestamp> out;
+    EXPECT_TRUE(summary.Query(17.0, 20.0, 5, out));
+    EXPECT_FALSE(out.empty());
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "TaskPool.h"
+
+namespace
+{
+
+/**
+ * @brief resubmit
+ * @param pool pool which runs task
+ * @param runs counter of runs, task submits itself again after every run, like capture indexing
+ */
+void resubmit(TaskPool & pool, const std::shared_ptr<std::atomic<int>> & runs)
+{
+    pool.Submit(PipelineStage::INDEX, [pool = &pool, runs] {
+        runs->fetch_add(1);
+        resubmit(*pool, runs);
+    });
+}
+
+}
+
+TEST(TaskPoolTest, WaiterDoesNotRunLowerPriorityTasks)
+{
+    TaskPool pool(1);
+    std::atomic_bool started {false};
+    std::atomic_bool release {false};
+    //only worker is busy, so queued tasks can be run only by waiting thread
+    pool.Submit(PipelineStage::PARSE, [&] {
+        started = true;
+        while (!release)
+        {
+            std::this_thread::yield();
+        }
+    });
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+    std::atomic_bool indexed {false};
+    pool.Submit(PipelineStage::INDEX, [&] { indexed = true; });
+
+    const std::thread::id waiter = std::this_thread::get_id();
+    std::thread::id parsed_by;
+    TaskGroup group(&pool, PipelineStage::PARSE);
+    group.Run([&] { parsed_by = std::this_thread::get_id(); });
+    group.Wait();
+    EXPECT_EQ(parsed_by, waiter);
+    //low priority task is left to worker
+    EXPECT_FALSE(indexed);
+
+    release = true;
+    while (!indexed)
+    {
+        std::this_thread::yield();
+    }
+}
+
+TEST(TaskPoolTest, DestructorDiscardsQueuedTasks)
+{
+    auto runs = std::make_shared<std::atomic<int>>(0);
+    {
+        TaskPool pool(2);
+        resubmit(pool, runs);
+        while (*runs < 10)
+        {
+            std::this_thread::yield();
+        }
+        //returns although task keeps resubmitting itself
+    }
+    const int after_destroy = *runs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(*runs, after_destroy);
+    //only the tasks discarded by destructor still owned counter
+    EXPECT_EQ(runs.use_count(), 1);
+}